@@ -0,0 +1,44 @@
+#include "FramePacer.h"
+const std::chrono::duration<double> k10::FramePacer::SPIN_DURATION = 
+	std::chrono::duration<double>(0.002);
+void k10::FramePacer::setTargetFrameTime(std::chrono::duration<double> ft)
+{
+	targetFrameTime = ft;
+	// start over from the next frame //
+	nextFrameTimePoint = Clock::time_point();
+}
+std::chrono::duration<double> k10::FramePacer::getTargetFrameTime() const
+{
+	return targetFrameTime;
+}
+std::chrono::duration<double> k10::FramePacer::waitForNextFrame()
+{
+	const Clock::time_point start = Clock::now();
+	if (targetFrameTime <= std::chrono::duration<double>(0))
+	{
+		return std::chrono::duration<double>(0);
+	}
+	if (nextFrameTimePoint <= start)
+	{
+		// running late (or this is the first frame), so the schedule starts
+		//	over from now //
+		nextFrameTimePoint = start + 
+			std::chrono::duration_cast<Clock::duration>(targetFrameTime);
+		return std::chrono::duration<double>(0);
+	}
+	const std::chrono::duration<double> sleepDuration = 
+		nextFrameTimePoint - start - SPIN_DURATION;
+	if (sleepDuration > std::chrono::duration<double>(0))
+	{
+		SDL_Delay(static_cast<Uint32>(sleepDuration.count()*1000));
+	}
+	Clock::time_point now = Clock::now();
+	while (now < nextFrameTimePoint)
+	{
+		std::this_thread::yield();
+		now = Clock::now();
+	}
+	nextFrameTimePoint += 
+		std::chrono::duration_cast<Clock::duration>(targetFrameTime);
+	return now - start;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+namespace k10
+{
+	// Holds a loop to a target frame time by sleeping until the next frame
+	//	is due, instead of letting it spin as fast as it can.  Waiting right
+	//	before input gets sampled keeps the input as fresh as possible once
+	//	the frame gets drawn.
+	// Most of the wait is spent in SDL_Delay, and only the last 
+	//	SPIN_DURATION gets spun away, since sleeps tend to overshoot by 
+	//	about a millisecond.
+	// Frames that run late push the schedule back instead of rushing to 
+	//	catch up, so a hitch never turns into a burst of unpaced frames.
+	class FramePacer
+	{
+	public:
+		using Clock = std::chrono::high_resolution_clock;
+		static const std::chrono::duration<double> SPIN_DURATION;
+	public:
+		// a target frame time of 0 turns pacing off
+		void setTargetFrameTime(std::chrono::duration<double> frameTime);
+		std::chrono::duration<double> getTargetFrameTime() const;
+		// Blocks until the next frame is due.  Returns how long it waited.
+		std::chrono::duration<double> waitForNextFrame();
+	private:
+		std::chrono::duration<double> targetFrameTime = 
+			std::chrono::duration<double>(0);
+		Clock::time_point nextFrameTimePoint;
+	};
+}
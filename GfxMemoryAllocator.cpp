@@ -0,0 +1,541 @@
+#include "GfxMemoryAllocator.h"
+const VkDeviceSize k10::GfxMemoryAllocator::DEFAULT_BLOCK_SIZE =
+	64 * 1024 * 1024;
+const float k10::GfxMemoryAllocator::DEFAULT_BUDGET_WARNING_THRESHOLD = 0.9f;
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+bool k10::GfxMemoryAllocator::initialize(
+	VkDevice d, VkPhysicalDevice pd, VkDeviceSize bs,
+	PFN_vkGetPhysicalDeviceMemoryProperties2KHR gmp2)
+{
+	device = d;
+	physicalDevice = pd;
+	blockSize = bs;
+	blocks.clear();
+	getMemoryProperties2 = gmp2;
+	budgetWarningThreshold = DEFAULT_BUDGET_WARNING_THRESHOLD;
+	for (uint32_t h = 0; h < VK_MAX_MEMORY_HEAPS; h++)
+	{
+		heapBlockBytes[h] = 0;
+		heapAllocatedBytes[h] = 0;
+		heapBudgets[h] = 0;
+		heapUsages[h] = 0;
+		heapBlockBytesAtBudgetUpdate[h] = 0;
+		heapNearBudget[h] = false;
+	}
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+	VkPhysicalDeviceProperties physicalDeviceProps;
+	vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProps);
+	nonCoherentAtomSize = std::max(VkDeviceSize(1),
+		physicalDeviceProps.limits.nonCoherentAtomSize);
+	// integrated devices (& any device where every heap is device local)
+	//	share memory with the host.  Otherwise, if some host visible memory
+	//	type lives on a device local heap at least as big as the biggest
+	//	device local heap then all of VRAM is mappable (ReBAR) //
+	bool allHeapsDeviceLocal = memoryProperties.memoryHeapCount > 0;
+	VkDeviceSize largestDeviceLocalHeapSize = 0;
+	for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; h++)
+	{
+		VkMemoryHeap const& heap = memoryProperties.memoryHeaps[h];
+		if (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			largestDeviceLocalHeapSize = 
+				std::max(largestDeviceLocalHeapSize, heap.size);
+		}
+		else
+		{
+			allHeapsDeviceLocal = false;
+		}
+	}
+	VkDeviceSize largestMappableDeviceLocalHeapSize = 0;
+	for (uint32_t t = 0; t < memoryProperties.memoryTypeCount; t++)
+	{
+		VkMemoryType const& type = memoryProperties.memoryTypes[t];
+		const VkMemoryPropertyFlags mappableDeviceLocal = 
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		if ((type.propertyFlags & mappableDeviceLocal) == mappableDeviceLocal)
+		{
+			largestMappableDeviceLocalHeapSize = 
+				std::max(largestMappableDeviceLocalHeapSize,
+						 memoryProperties.memoryHeaps[type.heapIndex].size);
+		}
+	}
+	if (physicalDeviceProps.deviceType == 
+			VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU ||
+		allHeapsDeviceLocal)
+	{
+		memoryArchitecture = MemoryArchitecture::UNIFIED;
+	}
+	else if (largestMappableDeviceLocalHeapSize > 0 &&
+			 largestMappableDeviceLocalHeapSize >= largestDeviceLocalHeapSize)
+	{
+		memoryArchitecture = MemoryArchitecture::DISCRETE_REBAR;
+	}
+	else
+	{
+		memoryArchitecture = MemoryArchitecture::DISCRETE;
+	}
+	SDL_Log("Gfx memory architecture: %s\n",
+		memoryArchitecture == MemoryArchitecture::UNIFIED ? "unified" :
+		memoryArchitecture == MemoryArchitecture::DISCRETE_REBAR ? 
+			"discrete (resizable BAR)" : "discrete");
+	for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; h++)
+	{
+		VkMemoryHeap const& heap = memoryProperties.memoryHeaps[h];
+		SDL_Log("\theap %i: %llu MB%s\n", static_cast<int>(h),
+			static_cast<unsigned long long>(heap.size / (1024 * 1024)),
+			(heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? 
+				" device local" : "");
+	}
+	SDL_Log("Gfx memory budget: %s\n", getMemoryProperties2 ?
+		"VK_EXT_memory_budget" : "estimated from heap sizes");
+	updateBudget();
+	return true;
+}
+void k10::GfxMemoryAllocator::destroy()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	for (size_t b = 0; b < blocks.size(); b++)
+	{
+		if (blocks[b].memory == VK_NULL_HANDLE)
+		{
+			continue;
+		}
+		SDL_assert(blocks[b].ranges.getAllocatedRangeCount() == 0);
+		releaseBlock(b);
+	}
+	blocks.clear();
+}
+uint64_t k10::GfxMemoryAllocator::findMemoryType(
+	uint32_t typeFilter, VkMemoryPropertyFlags requiredFlags) const
+{
+	const bool preferDeviceLocalHeap = 
+		(requiredFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) ||
+		!(requiredFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) ||
+		memoryArchitecture != MemoryArchitecture::DISCRETE;
+	// flags that cost something when we get them without asking for them:
+	//	host visible device memory is a limited resource, host caching 
+	//	slows down device access & non-coherent memory has to be flushed //
+	auto unwantedFlagCount = [&](VkMemoryPropertyFlags flags)->int
+	{
+		int retVal = 0;
+		if ((flags & ~requiredFlags) & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			retVal++;
+		}
+		if ((flags & ~requiredFlags) & VK_MEMORY_PROPERTY_HOST_CACHED_BIT)
+		{
+			retVal++;
+		}
+		if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+			!(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		{
+			retVal++;
+		}
+		return retVal;
+	};
+	uint64_t retVal = numeric_limits<uint64_t>::max();
+	bool bestOnPreferredHeap = false;
+	int bestUnwantedFlagCount = 0;
+	VkDeviceSize bestHeapSize = 0;
+	for (uint32_t t = 0; t < memoryProperties.memoryTypeCount; t++)
+	{
+		VkMemoryType const& type = memoryProperties.memoryTypes[t];
+		if (!(typeFilter & (1 << t)) ||
+			(type.propertyFlags & requiredFlags) != requiredFlags)
+		{
+			continue;
+		}
+		VkMemoryHeap const& heap = memoryProperties.memoryHeaps[type.heapIndex];
+		const bool onPreferredHeap = preferDeviceLocalHeap ==
+			((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0);
+		const int unwanted = unwantedFlagCount(type.propertyFlags);
+		const bool better = 
+			retVal == numeric_limits<uint64_t>::max() ? true :
+			onPreferredHeap != bestOnPreferredHeap ? onPreferredHeap :
+			unwanted != bestUnwantedFlagCount ? 
+				unwanted < bestUnwantedFlagCount :
+			heap.size > bestHeapSize;
+		if (better)
+		{
+			retVal = t;
+			bestOnPreferredHeap = onPreferredHeap;
+			bestUnwantedFlagCount = unwanted;
+			bestHeapSize = heap.size;
+		}
+	}
+	return retVal;
+}
+k10::GfxMemoryAllocator::MemoryArchitecture 
+	k10::GfxMemoryAllocator::getMemoryArchitecture() const
+{
+	return memoryArchitecture;
+}
+bool k10::GfxMemoryAllocator::isDeviceLocalHostVisible() const
+{
+	return memoryArchitecture != MemoryArchitecture::DISCRETE;
+}
+bool k10::GfxMemoryAllocator::allocate(
+	VkMemoryRequirements const& memRequirements, uint32_t memoryTypeIndex,
+	Allocation& outAllocation)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	SDL_assert(memoryTypeIndex < memoryProperties.memoryTypeCount);
+	const VkMemoryPropertyFlags propertyFlags =
+		memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+	VkDeviceSize alignment = memRequirements.alignment;
+	VkDeviceSize size = memRequirements.size;
+	if ((propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+		!(propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+	{
+		alignment = std::max(alignment, nonCoherentAtomSize);
+		size = alignUp(size, nonCoherentAtomSize);
+	}
+	// look for room in the blocks we already have first, and only create a
+	//	new block if none of them fit //
+	size_t b = blocks.size();
+	RangeAllocator::RangeId rid = RangeAllocator::INVALID_RANGE;
+	const bool dedicated = size > blockSize / 2;
+	if (!dedicated)
+	{
+		for (b = 0; b < blocks.size(); b++)
+		{
+			Block& block = blocks[b];
+			if (block.memory == VK_NULL_HANDLE || block.dedicated ||
+				block.memoryTypeIndex != memoryTypeIndex)
+			{
+				continue;
+			}
+			rid = block.ranges.allocate(size, alignment);
+			if (rid != RangeAllocator::INVALID_RANGE)
+			{
+				break;
+			}
+		}
+	}
+	if (rid == RangeAllocator::INVALID_RANGE)
+	{
+		b = createBlock(memoryTypeIndex, dedicated ? size : blockSize,
+						dedicated);
+		if (b >= blocks.size())
+		{
+			return false;
+		}
+		rid = blocks[b].ranges.allocate(size, alignment);
+		SDL_assert(rid != RangeAllocator::INVALID_RANGE);
+	}
+	Block const& block = blocks[b];
+	heapAllocatedBytes[memoryProperties.memoryTypes[memoryTypeIndex].
+		heapIndex] += size;
+	outAllocation.memory = block.memory;
+	outAllocation.offset = block.ranges.getOffset(rid);
+	outAllocation.size = size;
+	outAllocation.mappedData = block.mappedData ?
+		static_cast<Uint8*>(block.mappedData) + outAllocation.offset :
+		nullptr;
+	outAllocation.propertyFlags = propertyFlags;
+	outAllocation.memoryTypeIndex = memoryTypeIndex;
+	outAllocation.blockIndex = b;
+	outAllocation.rangeId = rid;
+	return true;
+}
+void k10::GfxMemoryAllocator::free(Allocation& allocation)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	if (allocation.memory == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	SDL_assert(allocation.blockIndex < blocks.size());
+	Block& block = blocks[allocation.blockIndex];
+	SDL_assert(block.memory == allocation.memory);
+	block.ranges.release(allocation.rangeId);
+	heapAllocatedBytes[memoryProperties.memoryTypes[block.memoryTypeIndex].
+		heapIndex] -= allocation.size;
+	// Hand empty blocks back to the driver so memory usage tracks what is
+	//	actually allocated, except for one spare block per memory type.  
+	//	Otherwise freeing & re-allocating the last range of a block, which
+	//	happens every time a buffer gets re-created, would free & allocate
+	//	a whole block each time. //
+	if (block.ranges.getAllocatedRangeCount() == 0)
+	{
+		bool spareBlockExists = false;
+		for (size_t b = 0; b < blocks.size() && !spareBlockExists; b++)
+		{
+			spareBlockExists = b != allocation.blockIndex && 
+				blocks[b].memory != VK_NULL_HANDLE && !blocks[b].dedicated &&
+				blocks[b].memoryTypeIndex == block.memoryTypeIndex &&
+				blocks[b].ranges.getAllocatedRangeCount() == 0;
+		}
+		if (block.dedicated || spareBlockExists)
+		{
+			releaseBlock(allocation.blockIndex);
+		}
+	}
+	allocation = {};
+}
+void k10::GfxMemoryAllocator::updateBudget()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	if (getMemoryProperties2)
+	{
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = {
+			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+			nullptr// pNext
+		};
+		VkPhysicalDeviceMemoryProperties2KHR memoryProps2 = {
+			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+			&budgetProps // pNext
+		};
+		getMemoryProperties2(physicalDevice, &memoryProps2);
+		for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; h++)
+		{
+			heapBudgets[h] = budgetProps.heapBudget[h];
+			heapUsages[h] = budgetProps.heapUsage[h];
+		}
+	}
+	else
+	{
+		for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; h++)
+		{
+			heapBudgets[h] = memoryProperties.memoryHeaps[h].size;
+			heapUsages[h] = heapBlockBytes[h];
+		}
+	}
+	for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; h++)
+	{
+		heapBlockBytesAtBudgetUpdate[h] = heapBlockBytes[h];
+		checkBudget(h);
+	}
+}
+bool k10::GfxMemoryAllocator::isMemoryBudgetSupported() const
+{
+	return getMemoryProperties2 != nullptr;
+}
+void k10::GfxMemoryAllocator::setBudgetWarningThreshold(float f)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	SDL_assert(f > 0);
+	budgetWarningThreshold = f;
+}
+uint32_t k10::GfxMemoryAllocator::getHeapCount() const
+{
+	return memoryProperties.memoryHeapCount;
+}
+k10::GfxMemoryAllocator::HeapStats 
+	k10::GfxMemoryAllocator::getHeapStats(uint32_t h) const
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	SDL_assert(h < memoryProperties.memoryHeapCount);
+	HeapStats retVal;
+	retVal.size = memoryProperties.memoryHeaps[h].size;
+	retVal.budget = heapBudgets[h];
+	// the driver's usage is only as fresh as the last updateBudget, so add
+	//	on whatever our blocks have done since //
+	retVal.usage = heapUsages[h];
+	if (heapBlockBytes[h] >= heapBlockBytesAtBudgetUpdate[h])
+	{
+		retVal.usage += heapBlockBytes[h] - heapBlockBytesAtBudgetUpdate[h];
+	}
+	else
+	{
+		retVal.usage -= std::min(retVal.usage, 
+			heapBlockBytesAtBudgetUpdate[h] - heapBlockBytes[h]);
+	}
+	retVal.headroom = retVal.budget > retVal.usage ? 
+		retVal.budget - retVal.usage : 0;
+	retVal.blockBytes = heapBlockBytes[h];
+	retVal.allocatedBytes = heapAllocatedBytes[h];
+	retVal.deviceLocal = 
+		(memoryProperties.memoryHeaps[h].flags & 
+			VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+	retVal.nearBudget = retVal.usage >= 
+		static_cast<VkDeviceSize>(budgetWarningThreshold*retVal.budget);
+	return retVal;
+}
+void k10::GfxMemoryAllocator::logStats() const
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; h++)
+	{
+		const HeapStats hs = getHeapStats(h);
+		SDL_Log("Gfx memory heap %i: usage=%llu budget=%llu headroom=%llu "
+			"ours=%llu (%llu allocated)%s\n",
+			static_cast<int>(h),
+			static_cast<unsigned long long>(hs.usage),
+			static_cast<unsigned long long>(hs.budget),
+			static_cast<unsigned long long>(hs.headroom),
+			static_cast<unsigned long long>(hs.blockBytes),
+			static_cast<unsigned long long>(hs.allocatedBytes),
+			hs.nearBudget ? " NEAR BUDGET" : "");
+	}
+	size_t blockCount = 0;
+	VkDeviceSize totalSize = 0;
+	VkDeviceSize totalAllocatedSize = 0;
+	for (Block const& block : blocks)
+	{
+		if (block.memory != VK_NULL_HANDLE)
+		{
+			blockCount++;
+			totalSize += block.ranges.getSize();
+			totalAllocatedSize += block.ranges.getAllocatedSize();
+		}
+	}
+	SDL_Log("Gfx memory: %llu/%llu bytes allocated in %i blocks\n",
+		static_cast<unsigned long long>(totalAllocatedSize),
+		static_cast<unsigned long long>(totalSize),
+		static_cast<int>(blockCount));
+	for (size_t b = 0; b < blocks.size(); b++)
+	{
+		Block const& block = blocks[b];
+		if (block.memory == VK_NULL_HANDLE)
+		{
+			continue;
+		}
+		// fragmentation is the fraction of free memory that isn't part of
+		//	the largest free range, so 0 means all of it is usable by a
+		//	single allocation //
+		const VkDeviceSize freeSize =
+			block.ranges.getSize() - block.ranges.getAllocatedSize();
+		const VkDeviceSize largestFreeSize =
+			block.ranges.getLargestFreeRangeSize();
+		const double fragmentation = freeSize > 0 ?
+			1.0 - static_cast<double>(largestFreeSize) / freeSize : 0.0;
+		SDL_Log("\tblock %i: type=%i heap=%i%s size=%llu allocated=%llu "
+			"(%i allocations) free ranges=%i largest free=%llu "
+			"fragmentation=%.1f%%\n",
+			static_cast<int>(b),
+			static_cast<int>(block.memoryTypeIndex),
+			static_cast<int>(memoryProperties.
+				memoryTypes[block.memoryTypeIndex].heapIndex),
+			block.dedicated ? " dedicated" : "",
+			static_cast<unsigned long long>(block.ranges.getSize()),
+			static_cast<unsigned long long>(block.ranges.getAllocatedSize()),
+			static_cast<int>(block.ranges.getAllocatedRangeCount()),
+			static_cast<int>(block.ranges.getFreeRangeCount()),
+			static_cast<unsigned long long>(largestFreeSize),
+			fragmentation*100);
+	}
+}
+VkDevice k10::GfxMemoryAllocator::getDevice() const
+{
+	return device;
+}
+VkPhysicalDevice k10::GfxMemoryAllocator::getPhysicalDevice() const
+{
+	return physicalDevice;
+}
+VkPhysicalDeviceMemoryProperties const&
+	k10::GfxMemoryAllocator::getMemoryProperties() const
+{
+	return memoryProperties;
+}
+VkDeviceSize k10::GfxMemoryAllocator::getNonCoherentAtomSize() const
+{
+	return nonCoherentAtomSize;
+}
+size_t k10::GfxMemoryAllocator::createBlock(uint32_t memoryTypeIndex,
+											VkDeviceSize size,
+											bool dedicated)
+{
+	const uint32_t heapIndex = 
+		memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+	// going over budget doesn't necessarily fail, but it can start paging
+	//	memory out of VRAM, so at least make some noise about it //
+	{
+		const HeapStats hs = getHeapStats(heapIndex);
+		if (size > hs.headroom)
+		{
+			SDL_LogWarn(SDL_LOG_CATEGORY_VIDEO,
+				"Allocating a %llu byte block puts memory heap %i over "
+				"budget! usage=%llu budget=%llu\n",
+				static_cast<unsigned long long>(size),
+				static_cast<int>(heapIndex),
+				static_cast<unsigned long long>(hs.usage),
+				static_cast<unsigned long long>(hs.budget));
+		}
+	}
+	const VkMemoryAllocateInfo allocInfo = {
+		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		nullptr,// pNext
+		size,
+		memoryTypeIndex
+	};
+	Block block;
+	block.memoryTypeIndex = memoryTypeIndex;
+	block.dedicated = dedicated;
+	block.mappedData = nullptr;
+	if (vkAllocateMemory(device,
+						 &allocInfo,
+						 nullptr,
+						 &block.memory) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to allocate %llu byte block of memory type %i!\n",
+			static_cast<unsigned long long>(size),
+			static_cast<int>(memoryTypeIndex));
+		logStats();
+		SDL_assert(false);
+		return blocks.size();
+	}
+	if ((memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags &
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+		vkMapMemory(device, block.memory, 0, VK_WHOLE_SIZE,
+					VkMemoryMapFlags(0), &block.mappedData) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to map memory block!\n");
+		SDL_assert(false);
+		vkFreeMemory(device, block.memory, nullptr);
+		return blocks.size();
+	}
+	block.ranges.reset(size);
+	heapBlockBytes[heapIndex] += size;
+	checkBudget(heapIndex);
+	// re-use the slot of a block that was released if there is one, so the
+	//	block list doesn't keep growing as blocks come & go //
+	for (size_t b = 0; b < blocks.size(); b++)
+	{
+		if (blocks[b].memory == VK_NULL_HANDLE)
+		{
+			blocks[b] = block;
+			return b;
+		}
+	}
+	blocks.push_back(block);
+	return blocks.size() - 1;
+}
+void k10::GfxMemoryAllocator::releaseBlock(size_t blockIndex)
+{
+	Block& block = blocks[blockIndex];
+	if (block.mappedData)
+	{
+		vkUnmapMemory(device, block.memory);
+		block.mappedData = nullptr;
+	}
+	vkFreeMemory(device, block.memory, nullptr);
+	const uint32_t heapIndex = 
+		memoryProperties.memoryTypes[block.memoryTypeIndex].heapIndex;
+	heapBlockBytes[heapIndex] -= block.ranges.getSize();
+	block.memory = VK_NULL_HANDLE;
+	block.ranges.reset(0);
+	checkBudget(heapIndex);
+}
+void k10::GfxMemoryAllocator::checkBudget(uint32_t heapIndex)
+{
+	const HeapStats hs = getHeapStats(heapIndex);
+	if (hs.nearBudget && !heapNearBudget[heapIndex])
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_VIDEO,
+			"Gfx memory heap %i is near its budget! usage=%llu budget=%llu "
+			"(ours=%llu)\n",
+			static_cast<int>(heapIndex),
+			static_cast<unsigned long long>(hs.usage),
+			static_cast<unsigned long long>(hs.budget),
+			static_cast<unsigned long long>(hs.blockBytes));
+	}
+	heapNearBudget[heapIndex] = hs.nearBudget;
+}
\ No newline at end of file
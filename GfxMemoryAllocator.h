@@ -0,0 +1,155 @@
+#pragma once
+#include "RangeAllocator.h"
+namespace k10
+{
+	// Sub-allocates device memory out of large blocks, so the number of
+	//	vkAllocateMemory calls stays well below maxMemoryAllocationCount no
+	//	matter how many buffers get created.  Every block holds a single
+	//	memory type, and its ranges are handed out by a RangeAllocator.
+	//	Requests bigger than half a block get a dedicated block instead.
+	// Empty blocks are freed right away, except for one spare block per 
+	//	memory type that is kept around for the next allocation.
+	// Host visible blocks stay mapped for their whole lifetime, since a
+	//	VkDeviceMemory can only be mapped once at a time no matter how many
+	//	buffers are bound to it.
+	// Only buffers are sub-allocated from here, so bufferImageGranularity
+	//	never comes into play.
+	// Allocating, freeing & querying the budgets all lock the allocator, 
+	//	so buffers can be created & destroyed from any thread.
+	class GfxMemoryAllocator
+	{
+	public:
+		static const VkDeviceSize DEFAULT_BLOCK_SIZE;
+		static const float DEFAULT_BUDGET_WARNING_THRESHOLD;
+		enum class MemoryArchitecture : Uint8
+		{
+			// device local memory is only host visible through a small BAR
+			//	window (if at all), so uploads should go through staging
+			DISCRETE,
+			// resizable BAR: all of device local memory is host visible
+			DISCRETE_REBAR,
+			// the device shares system memory with the host, which means 
+			//	everything is device local & usually host visible too
+			UNIFIED
+		};
+		struct Allocation
+		{
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize offset = 0;
+			VkDeviceSize size = 0;
+			// points at offset within the block's mapping, or nullptr if the
+			//	memory isn't host visible
+			void* mappedData = nullptr;
+			VkMemoryPropertyFlags propertyFlags = 0;
+			uint32_t memoryTypeIndex = 0;
+			size_t blockIndex = 0;
+			RangeAllocator::RangeId rangeId = RangeAllocator::INVALID_RANGE;
+		};
+		struct HeapStats
+		{
+			VkDeviceSize size;
+			// How much of the heap this process can use before allocations
+			//	start to fail or get slow, & how much of it is in use by this
+			//	process.  Without VK_EXT_memory_budget the budget is the whole
+			//	heap, and the usage only counts our own blocks.
+			VkDeviceSize budget;
+			VkDeviceSize usage;
+			// budget - usage, or 0 once we're over budget
+			VkDeviceSize headroom;
+			// device memory held by our blocks on this heap, and how much of
+			//	it has been handed out as Allocations
+			VkDeviceSize blockBytes;
+			VkDeviceSize allocatedBytes;
+			bool deviceLocal;
+			// usage has reached the budget warning threshold
+			bool nearBudget;
+		};
+	public:
+		// logs the memory architecture & heaps of the physical device.
+		// getMemoryProperties2 should only be given if VK_EXT_memory_budget
+		//	is enabled on the device, otherwise budgets are estimated.
+		bool initialize(VkDevice d, VkPhysicalDevice pd,
+						VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE,
+						PFN_vkGetPhysicalDeviceMemoryProperties2KHR 
+							getMemoryProperties2 = nullptr);
+		// Every Allocation must be freed first.
+		void destroy();
+		// Returns the index of the best memory type in typeFilter that has
+		//	all of requiredFlags.  Types on device local heaps come first, 
+		//	except for host visible requests on a DISCRETE device where 
+		//	that would eat into the BAR window.  After that, types with 
+		//	fewer flags that weren't asked for win, then bigger heaps.
+		// Returns 'numeric_limits<uint64_t>::max()' on failure.
+		uint64_t findMemoryType(uint32_t typeFilter,
+								VkMemoryPropertyFlags requiredFlags) const;
+		MemoryArchitecture getMemoryArchitecture() const;
+		// true when device local memory can be written by the host, so 
+		//	uploads can write in place instead of going through staging
+		bool isDeviceLocalHostVisible() const;
+		// Allocations of memory types that aren't host coherent are aligned
+		//	& padded to nonCoherentAtomSize, so flushing the whole atoms of
+		//	one never touches another.
+		bool allocate(VkMemoryRequirements const& memRequirements,
+					  uint32_t memoryTypeIndex, Allocation& outAllocation);
+		void free(Allocation& allocation);
+		// Re-queries the heap budgets from the driver.  They change as other
+		//	processes allocate memory, so this should be called about once a
+		//	frame.  Logs a warning whenever a heap crosses the budget warning
+		//	threshold.
+		void updateBudget();
+		bool isMemoryBudgetSupported() const;
+		// fraction of a heap's budget that its usage can reach before we
+		//	start warning about it
+		void setBudgetWarningThreshold(float fractionOfBudget);
+		uint32_t getHeapCount() const;
+		// as of the last updateBudget, plus any blocks created since then
+		HeapStats getHeapStats(uint32_t heapIndex) const;
+		// logs the budget of every heap, and the usage & fragmentation of
+		//	every block
+		void logStats() const;
+		VkDevice getDevice() const;
+		VkPhysicalDevice getPhysicalDevice() const;
+		VkPhysicalDeviceMemoryProperties const& getMemoryProperties() const;
+		VkDeviceSize getNonCoherentAtomSize() const;
+	private:
+		struct Block
+		{
+			// VK_NULL_HANDLE once the block has been released, so that the
+			//	block indices of live Allocations stay valid
+			VkDeviceMemory memory;
+			uint32_t memoryTypeIndex;
+			bool dedicated;
+			void* mappedData;
+			RangeAllocator ranges;
+		};
+	private:
+		// Returns blocks.size() on failure.
+		size_t createBlock(uint32_t memoryTypeIndex, VkDeviceSize size,
+						   bool dedicated);
+		void releaseBlock(size_t blockIndex);
+		// warns about heapIndex if it is near its budget, once per crossing
+		void checkBudget(uint32_t heapIndex);
+	private:
+		VkDevice device;
+		VkPhysicalDevice physicalDevice;
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+		VkDeviceSize nonCoherentAtomSize;
+		VkDeviceSize blockSize;
+		MemoryArchitecture memoryArchitecture;
+		vector<Block> blocks;
+		PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2;
+		float budgetWarningThreshold;
+		VkDeviceSize heapBlockBytes[VK_MAX_MEMORY_HEAPS];
+		VkDeviceSize heapAllocatedBytes[VK_MAX_MEMORY_HEAPS];
+		// what the driver reported at the last updateBudget, and how much
+		//	memory our blocks held at the time, so that block changes since
+		//	then can be added to the reported usage
+		VkDeviceSize heapBudgets[VK_MAX_MEMORY_HEAPS];
+		VkDeviceSize heapUsages[VK_MAX_MEMORY_HEAPS];
+		VkDeviceSize heapBlockBytesAtBudgetUpdate[VK_MAX_MEMORY_HEAPS];
+		bool heapNearBudget[VK_MAX_MEMORY_HEAPS];
+		// recursive, since logging & checking budgets go through the public
+		//	getters
+		mutable std::recursive_mutex mutex;
+	};
+}
@@ -1,292 +1,3097 @@
-#include "QuadPool.h"
-const Uint8 k10::QuadPool::VERTICES_PER_QUAD = 6;
-const VkDeviceSize k10::QuadPool::QUAD_VERTEX_DATA_SIZE = sizeof(Vertex) * VERTICES_PER_QUAD;
-const VkVertexInputBindingDescription k10::Vertex::bindingDescription = {
-	0,// binding
-	sizeof(Vertex),
-	VK_VERTEX_INPUT_RATE_VERTEX
-};
-const vector<VkVertexInputAttributeDescription> k10::Vertex::attributeDescriptions = {
-	{0,//location
-		0,//binding
-		VK_FORMAT_R32G32_SFLOAT,
-		offsetof(Vertex, position)},
-	{1,//location
-		0,//binding
-		VK_FORMAT_R32G32B32A32_SFLOAT,
-		offsetof(Vertex, color)}
-};
-bool k10::GfxBuffer::createBuffer(VkDevice d, VkPhysicalDevice pd, 
-								  VkDeviceSize size,
-								  VkBufferUsageFlags usageFlags,
-								  VkMemoryPropertyFlags memPropFlags)
-{
-	device = d;
-	bufferSize = size;
-	const VkBufferCreateInfo bufferCreateInfo = {
-		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-		nullptr,// pNext
-		0,// flags
-		size,
-		usageFlags,
-		VK_SHARING_MODE_EXCLUSIVE,
-		0,// queue family index count
-		nullptr // queue family indices (unused if sharing mode is exclusive)
-	};
-	if (vkCreateBuffer(device, &bufferCreateInfo,
-					   nullptr, &buffer) != VK_SUCCESS)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to create Vulkan buffer!\n");
-		SDL_assert(false);
-		return false;
-	}
-	VkMemoryRequirements memRequirements;
-	vkGetBufferMemoryRequirements(d, buffer, &memRequirements);
-	const uint64_t memTypeIndex = findMemoryType(
-		memRequirements.memoryTypeBits,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		pd);
-	if (memTypeIndex == numeric_limits<uint64_t>::max())
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to find suitable memory type for vertex buffer!\n");
-		SDL_assert(false);
-		return false;
-	}
-	const VkMemoryAllocateInfo allocInfo = {
-		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		nullptr,// pNext
-		memRequirements.size,
-		static_cast<uint32_t>(memTypeIndex)
-	};
-	if (vkAllocateMemory(d, 
-						 &allocInfo, 
-						 nullptr, 
-						 &deviceMemory) != VK_SUCCESS)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to allocate memory for vertex buffer!\n");
-		SDL_assert(false);
-		return false;
-	}
-	vkBindBufferMemory(d, buffer, deviceMemory, 0);
-	return true;
-}
-void k10::GfxBuffer::destroyBuffer()
-{
-	vkDestroyBuffer(device, buffer, nullptr);
-	vkFreeMemory(device, deviceMemory, nullptr);
-}
-void k10::GfxBuffer::mapMemory(void** data, VkDeviceSize offset, VkDeviceSize size)
-{
-	vkMapMemory(device, deviceMemory, offset, size, VkMemoryMapFlags(0), data);
-}
-void k10::GfxBuffer::unmapMemory()
-{
-	vkUnmapMemory(device, deviceMemory);
-}
-VkBuffer k10::GfxBuffer::getBuffer() const
-{
-	return buffer;
-}
-uint64_t k10::GfxBuffer::findMemoryType(uint32_t typeFilter,
-									    VkMemoryPropertyFlags properties,
-									    VkPhysicalDevice pd)
-{
-	VkPhysicalDeviceMemoryProperties physicalMemProps;
-	vkGetPhysicalDeviceMemoryProperties(pd, &physicalMemProps);
-	for (uint32_t t = 0; t < physicalMemProps.memoryTypeCount; t++)
-	{
-		if ((typeFilter & (1 << t)) &&
-			(physicalMemProps.memoryTypes[t].propertyFlags & properties) == properties)
-		{
-			return t;
-		}
-	}
-	return numeric_limits<uint64_t>::max();
-}
-bool k10::QuadPool::fillPool(VkDevice d, VkPhysicalDevice pd, VkCommandPool cp,
-							 size_t mqc)
-{
-	device = d;
-	commandPool = cp;
-	maxQuadCount = mqc;
-	nextQuadId = 0;
-	largestQuadCount = 0;
-	quadSet.clear();
-	stagingQuads.clear();
-	const VkDeviceSize dataBufferSize = 
-		static_cast<VkDeviceSize>(QUAD_VERTEX_DATA_SIZE * maxQuadCount);
-	if (!quadDataBuffer.createBuffer(d, pd, dataBufferSize,
-									 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
-										VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-									 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to create quad pool data buffer!\n");
-		return false;
-	}
-	const VkDeviceSize stagingBufferVerticesSize =
-		static_cast<VkDeviceSize>(QUAD_VERTEX_DATA_SIZE * maxQuadCount);
-	if(!stagingBufferVertices.createBuffer(d, pd, stagingBufferVerticesSize,
-										   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-										   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-										   	  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to create quad pool vertex staging buffer!\n");
-		return false;
-	}
-	const VkFenceCreateInfo fenceCreateInfo = {
-		VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-		nullptr,// pNext
-		VK_FENCE_CREATE_SIGNALED_BIT // flags
-	};
-	if (vkCreateFence(device,
-					  &fenceCreateInfo,
-					  nullptr,
-					  &stagingMemoryTransferFence) != VK_SUCCESS)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to allocate stagingMemoryTransferFence!\n");
-		return false;
-	}
-	return true;
-}
-void k10::QuadPool::drainPool()
-{
-	vkDestroyFence(device, stagingMemoryTransferFence, nullptr);
-	quadDataBuffer.destroyBuffer();
-	stagingBufferVertices.destroyBuffer();
-}
-k10::QuadPool::QuadId k10::QuadPool::addQuad(vector<Vertex> const& vertices)
-{
-	SDL_assert(vertices.size() == VERTICES_PER_QUAD);
-	if (quadSet.size() >= maxQuadCount)
-	{
-		SDL_Log("Aborting attempt to add a quad to a filled pool.\n");
-		SDL_assert(false);
-		return numeric_limits<QuadId>::max();
-	}
-	while (quadSet.find(nextQuadId) != quadSet.end())
-	{
-		nextQuadId = (nextQuadId + 1) % maxQuadCount;
-	}
-	// at this point, we can guarantee that the nextQuadId is valid //
-	quadSet.insert(nextQuadId);
-	if (quadSet.size() > static_cast<size_t>(largestQuadCount))
-	{
-		largestQuadCount = static_cast<uint32_t>(quadSet.size());
-	}
-	// add the vertex data into the mapped staging buffer //
-	void* stagingData;
-	///TODO: change the vertex data offset once we interleave vertex data w/ index & uniform data~
-	const VkDeviceSize newQuadVertexDataOffset = nextQuadId*QUAD_VERTEX_DATA_SIZE;
-	stagingBufferVertices.mapMemory(&stagingData, 
-									newQuadVertexDataOffset, 
-									QUAD_VERTEX_DATA_SIZE);
-	memcpy(stagingData, vertices.data(), static_cast<size_t>(QUAD_VERTEX_DATA_SIZE));
-	stagingBufferVertices.unmapMemory();
-	stagingQuads.push_back({newQuadVertexDataOffset, STAGING_QUAD_DATA_BIT_ALL });
-	// prep the nextQuadId for the most likely next id to reduce # of set 
-	//	lookups //
-	const QuadId retVal = nextQuadId;
-	nextQuadId = (nextQuadId + 1) % maxQuadCount;
-	return retVal;
-}
-void k10::QuadPool::removeQuad(QuadId qid)
-{
-	auto quadSetIt = quadSet.find(qid);
-	if (quadSetIt == quadSet.end())
-	{
-		SDL_Log("WARNING: trying to remove quad that doesn't exist!\n");
-		SDL_assert(false);
-		return;
-	}
-	SDL_assert(false);
-	///TODO
-	quadSet.erase(quadSetIt);
-}
-void k10::QuadPool::flushVertexStaging(VkQueue qMemoryTransfer)
-{
-	if (stagingQuads.empty())
-	{
-		return;
-	}
-	VkCommandBuffer memoryCommandBuffer;
-	const VkCommandBufferAllocateInfo commandBufferAllocInfo = {
-		VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-		nullptr,// pNext
-		commandPool,
-		VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-		1 // command buffer count
-	};
-	vkAllocateCommandBuffers(device, &commandBufferAllocInfo, &memoryCommandBuffer);
-	const VkCommandBufferBeginInfo commandBufferBeginInfo = {
-		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-		nullptr,// pNext
-		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-		nullptr // inheritance info pointer
-	};
-	vkBeginCommandBuffer(memoryCommandBuffer, &commandBufferBeginInfo);
-	///TODO: maybe do some more work here to minimize the # of copy buffer 
-	///	commands we have to issue here (need to test for performance once
-	///	everything is up and running...
-	vector<VkBufferCopy> bufferCopyRegions(stagingQuads.size());
-	for (size_t r = 0; r < bufferCopyRegions.size(); r++)
-	{
-		StagingQuad const& sq = stagingQuads[r];
-		if (sq.stagingQuadDataBits != STAGING_QUAD_DATA_BIT_ALL)
-		{
-			SDL_Log("I haven't implemented partial Vertex updates yet.\n");
-			SDL_assert(false);
-			return;
-		}
-		const VkBufferCopy copyRegion = {
-			sq.dataBufferOffset,// src offset
-			sq.dataBufferOffset,// dst offset
-			QUAD_VERTEX_DATA_SIZE
-		};
-		bufferCopyRegions[r] = copyRegion;
-	}
-	vkCmdCopyBuffer(memoryCommandBuffer, 
-					stagingBufferVertices.getBuffer(),
-					quadDataBuffer.getBuffer(), 
-					static_cast<uint32_t>(bufferCopyRegions.size()), 
-					bufferCopyRegions.data());
-	stagingQuads.clear();
-	vkEndCommandBuffer(memoryCommandBuffer);
-	const VkSubmitInfo submitInfo = {
-		VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		nullptr,// pNext
-		0,// wait semaphore count
-		nullptr,// wait semaphores
-		nullptr,// wait dst stage mask
-		1,// command buffer count
-		&memoryCommandBuffer,
-		0,// signal semaphore count
-		nullptr // signal semaphores
-	};
-	vkResetFences(device, 1, &stagingMemoryTransferFence);
-	vkQueueSubmit(qMemoryTransfer, 1, &submitInfo, stagingMemoryTransferFence);
-	///vkQueueWaitIdle(qMemoryTransfer);
-	vkWaitForFences(device, 1, &stagingMemoryTransferFence, VK_TRUE, UINT64_MAX);
-	vkFreeCommandBuffers(device, commandPool, 1, &memoryCommandBuffer);
-}
-bool k10::QuadPool::flushRequired() const
-{
-	return !stagingQuads.empty();
-}
-void k10::QuadPool::issueCommands(VkCommandBuffer cb)
-{
-	if (largestQuadCount <= 0)
-	{
-		return;
-	}
-	VkBuffer vertexBuffers[] = { quadDataBuffer.getBuffer() };
-	VkDeviceSize vbOffsets[] = { 0 };
-	vkCmdBindVertexBuffers(cb, 0, 1, vertexBuffers, vbOffsets);
-	vkCmdDraw(cb, static_cast<uint32_t>(largestQuadCount * VERTICES_PER_QUAD), 1, 0, 0);
+#include "QuadPool.h"
+const Uint8 k10::QuadPool::VERTICES_PER_QUAD = 4;
+const Uint8 k10::QuadPool::INDICES_PER_QUAD = 6;
+const uint32_t k10::QuadPool::QUAD_CORNER_INDICES[] = { 0, 1, 2, 2, 3, 0 };
+const VkDeviceSize k10::QuadPool::DEFAULT_STAGING_RING_SIZE = 16 * 1024 * 1024;
+const VkDeviceSize k10::QuadPool::DIRTY_PAGE_SIZE = 16 * 1024;
+const k10::QuadPool::QuadId k10::QuadPool::DEFAULT_COMPACTION_MOVE_BUDGET = 
+	4096;
+const k10::QuadPool::QuadId k10::QuadPool::DEFAULT_CHUNK_QUAD_COUNT = 
+	64 * 1024;
+const k10::QuadPool::QuadId 
+	k10::QuadPool::Producer::DEFAULT_RESERVATION_QUAD_COUNT = 1024;
+const VkDeviceSize k10::QuadPool::CULL_OUTPUT_OFFSET = 32;
+const uint32_t k10::QuadPool::CULL_WORKGROUP_SIZE = 64;
+const VkDeviceSize k10::QuadPool::STAGING_BLOCK_SIZE = 64 * 1024;
+const uint32_t k10::QuadPool::CULL_DESCRIPTOR_POOL_SET_COUNT = 64;
+// slot indices have to stay below SlotAllocator::INVALID_SLOT
+const size_t k10::QuadPool::MAX_QUAD_COUNT = 
+	numeric_limits<k10::QuadPool::QuadId>::max() - 1;
+// every corner sits on the same point, so the quad has no area to rasterize
+const glm::vec2 k10::QuadPool::DEGENERATE_QUAD_POSITIONS[] = {
+	{0.f, 0.f},
+	{0.f, 0.f},
+	{0.f, 0.f},
+	{0.f, 0.f}
+};
+// a rect with no area
+const k10::QuadInstance k10::QuadPool::DEGENERATE_QUAD_INSTANCE = {
+	{0.f, 0.f, 0.f, 0.f},// rect
+	0.f,// depth
+	{0, 0, 0, 0} // corner colors
+};
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+const VkVertexInputBindingDescription k10::QuadInstance::bindingDescription = {
+	0,// binding
+	sizeof(QuadInstance),
+	VK_VERTEX_INPUT_RATE_INSTANCE
+};
+const vector<VkVertexInputAttributeDescription> k10::QuadInstance::attributeDescriptions = {
+	{0,//location
+		0,//binding
+		VK_FORMAT_R32G32B32A32_SFLOAT,
+		offsetof(QuadInstance, rect)},
+	{1,//location
+		0,//binding
+		VK_FORMAT_R32_SFLOAT,
+		offsetof(QuadInstance, depth)},
+	{2,//location
+		0,//binding
+		VK_FORMAT_R8G8B8A8_UNORM,
+		offsetof(QuadInstance, cornerColors) + 0*sizeof(Uint32)},
+	{3,//location
+		0,//binding
+		VK_FORMAT_R8G8B8A8_UNORM,
+		offsetof(QuadInstance, cornerColors) + 1*sizeof(Uint32)},
+	{4,//location
+		0,//binding
+		VK_FORMAT_R8G8B8A8_UNORM,
+		offsetof(QuadInstance, cornerColors) + 2*sizeof(Uint32)},
+	{5,//location
+		0,//binding
+		VK_FORMAT_R8G8B8A8_UNORM,
+		offsetof(QuadInstance, cornerColors) + 3*sizeof(Uint32)}
+};
+Uint32 k10::packUnorm8Color(glm::vec4 const& color)
+{
+	const glm::vec4 c = glm::clamp(color, 0.f, 1.f)*255.f + 0.5f;
+	return  static_cast<Uint32>(c.r)        |
+		   (static_cast<Uint32>(c.g) << 8 ) |
+		   (static_cast<Uint32>(c.b) << 16) |
+		   (static_cast<Uint32>(c.a) << 24);
+}
+glm::vec4 k10::unpackUnorm8Color(Uint32 packedColor)
+{
+	return glm::vec4( packedColor        & 0xFF,
+					 (packedColor >> 8 ) & 0xFF,
+					 (packedColor >> 16) & 0xFF,
+					 (packedColor >> 24) & 0xFF) / 255.f;
+}
+Sint16 k10::packSnorm16(float value)
+{
+	return static_cast<Sint16>(
+		std::round(glm::clamp(value, -1.f, 1.f)*32767.f));
+}
+float k10::unpackSnorm16(Sint16 packedValue)
+{
+	// both -32768 & -32767 map to -1, same as the device does it
+	return glm::max(packedValue / 32767.f, -1.f);
+}
+bool k10::GfxBuffer::createBuffer(GfxMemoryAllocator& a, 
+								  VkDeviceSize size,
+								  VkBufferUsageFlags usageFlags,
+								  VkMemoryPropertyFlags memPropFlags,
+								  bool persistentlyMapped,
+								  vector<uint32_t> const& sharingQueueFamilies)
+{
+	allocator = &a;
+	bufferSize = size;
+	persistentMapping = nullptr;
+	dirtyBegin = numeric_limits<VkDeviceSize>::max();
+	dirtyEnd = 0;
+	VkDevice const device = allocator->getDevice();
+	vector<uint32_t> uniqueQueueFamilies;
+	for (uint32_t qf : sharingQueueFamilies)
+	{
+		if (std::find(uniqueQueueFamilies.begin(), uniqueQueueFamilies.end(),
+					  qf) == uniqueQueueFamilies.end())
+		{
+			uniqueQueueFamilies.push_back(qf);
+		}
+	}
+	const bool concurrent = uniqueQueueFamilies.size() > 1;
+	const VkBufferCreateInfo bufferCreateInfo = {
+		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		nullptr,// pNext
+		0,// flags
+		size,
+		usageFlags,
+		concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+		concurrent ? static_cast<uint32_t>(uniqueQueueFamilies.size()) : 0,
+		// queue family indices (unused if sharing mode is exclusive)
+		concurrent ? uniqueQueueFamilies.data() : nullptr
+	};
+	if (vkCreateBuffer(device, &bufferCreateInfo,
+					   nullptr, &buffer) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create Vulkan buffer!\n");
+		SDL_assert(false);
+		return false;
+	}
+	VkMemoryRequirements memRequirements;
+	vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+	const uint64_t memTypeIndex = allocator->findMemoryType(
+		memRequirements.memoryTypeBits, memPropFlags);
+	if (memTypeIndex == numeric_limits<uint64_t>::max())
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to find suitable memory type for vertex buffer!\n");
+		SDL_assert(false);
+		return false;
+	}
+	if (!allocator->allocate(memRequirements, 
+							 static_cast<uint32_t>(memTypeIndex), 
+							 allocation))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to allocate memory for vertex buffer!\n");
+		SDL_assert(false);
+		return false;
+	}
+	vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+	if (persistentlyMapped)
+	{
+		SDL_assert(allocation.mappedData);
+		persistentMapping = allocation.mappedData;
+	}
+	return true;
+}
+void k10::GfxBuffer::destroyBuffer()
+{
+	if (!allocator)
+	{
+		return;
+	}
+	persistentMapping = nullptr;
+	vkDestroyBuffer(allocator->getDevice(), buffer, nullptr);
+	allocator->free(allocation);
+}
+void k10::GfxBuffer::mapMemory(void** data, VkDeviceSize offset, VkDeviceSize size)
+{
+	SDL_assert(!persistentMapping && allocation.mappedData);
+	SDL_assert(offset + size <= bufferSize);
+	*data = static_cast<Uint8*>(allocation.mappedData) + offset;
+	dirtyBegin = offset;
+	dirtyEnd = offset + size;
+}
+void k10::GfxBuffer::unmapMemory()
+{
+	flushMappedRanges();
+}
+void k10::GfxBuffer::flushMappedRanges()
+{
+	if (dirtyBegin >= dirtyEnd)
+	{
+		return;
+	}
+	if (!(allocation.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+	{
+		const VkMappedMemoryRange range = 
+			alignedMappedRange(dirtyBegin, dirtyEnd - dirtyBegin);
+		vkFlushMappedMemoryRanges(allocator->getDevice(), 1, &range);
+	}
+	dirtyBegin = numeric_limits<VkDeviceSize>::max();
+	dirtyEnd = 0;
+}
+void k10::GfxBuffer::flushMappedRange(VkDeviceSize offset, VkDeviceSize size)
+{
+	SDL_assert(persistentMapping);
+	if (!(allocation.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+	{
+		const VkMappedMemoryRange range = alignedMappedRange(offset, size);
+		vkFlushMappedMemoryRanges(allocator->getDevice(), 1, &range);
+	}
+}
+void k10::GfxBuffer::invalidateMappedRange(VkDeviceSize offset, 
+										   VkDeviceSize size)
+{
+	SDL_assert(persistentMapping);
+	if (!(allocation.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+	{
+		const VkMappedMemoryRange range = alignedMappedRange(offset, size);
+		vkInvalidateMappedMemoryRanges(allocator->getDevice(), 1, &range);
+	}
+}
+VkMappedMemoryRange k10::GfxBuffer::alignedMappedRange(VkDeviceSize offset,
+													   VkDeviceSize size) const
+{
+	// the allocator aligns & pads non-coherent allocations to whole atoms,
+	//	so the expanded range never leaves our allocation //
+	const VkDeviceSize atom = allocator->getNonCoherentAtomSize();
+	const VkDeviceSize begin = allocation.offset + offset;
+	const VkDeviceSize alignedBegin = (begin / atom) * atom;
+	const VkDeviceSize alignedEnd = std::min(
+		((begin + size + atom - 1) / atom) * atom,
+		allocation.offset + allocation.size);
+	return {
+		VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+		nullptr,// pNext
+		allocation.memory,
+		alignedBegin,
+		alignedEnd - alignedBegin
+	};
+}
+VkBuffer k10::GfxBuffer::getBuffer() const
+{
+	return buffer;
+}
+uint32_t k10::GfxBuffer::getMemoryHeapIndex() const
+{
+	return allocator->getMemoryProperties().
+		memoryTypes[allocation.memoryTypeIndex].heapIndex;
+}
+VkDeviceSize k10::GfxBuffer::getMemorySize() const
+{
+	return allocation.size;
+}
+bool k10::QuadPool::fillPool(GfxMemoryAllocator& allocator, 
+							 uint32_t transferQueueFamilyIndex,
+							 uint32_t graphicsQueueFamilyIndex,
+							 VkQueue qMemoryTransfer,
+							 size_t mqc, DrawMode dm, VertexFormat vf,
+							 VkDeviceSize srs, QuadId cqc)
+{
+	SDL_assert(cqc > 0);
+	device = allocator.getDevice();
+	this->allocator = &allocator;
+	drawMode = dm;
+	vertexFormat = vf;
+	chunkQuadCount = cqc;
+	maxQuadCount = std::min(
+		(std::min(mqc, MAX_QUAD_COUNT) + chunkQuadCount - 1) / 
+			chunkQuadCount * chunkQuadCount,
+		MAX_QUAD_COUNT / chunkQuadCount * chunkQuadCount);
+	largestQuadCount = 0;
+	// the pool starts out without any chunks, and grows as quads get 
+	//	added to it //
+	chunks.clear();
+	retiredChunks.clear();
+	frameFences.clear();
+	quadSlots.reset(0);
+	quadIds.reset(0);
+	quadIdSlots.clear();
+	slotQuadIds.clear();
+	dirtyPageCount = 0;
+	producerChangesPending = false;
+	inPlaceReaders.clear();
+	inPlaceReadersPending = false;
+	drawArgsUpdateBegin = 0;
+	drawArgsUpdateEnd = 0;
+	stagingArena = StagingArena();
+	stagingOverflowBlocks.clear();
+	nextStagedRunSequence = 0;
+	stagedRuns.clear();
+	quadDataStreams.clear();
+	if (drawMode == DrawMode::INSTANCED)
+	{
+		storedVerticesPerQuad = 0;
+		quadDataStreams.push_back({0, sizeof(QuadInstance), 
+								   STAGING_QUAD_DATA_BIT_ALL});
+		vertexBindingDescriptions = { QuadInstance::bindingDescription };
+		vertexAttributeDescriptions = QuadInstance::attributeDescriptions;
+	}
+	else
+	{
+		storedVerticesPerQuad = drawMode == DrawMode::INDEXED ?
+			VERTICES_PER_QUAD : INDICES_PER_QUAD;
+		const bool packed = vertexFormat == VertexFormat::PACKED;
+		const uint32_t positionSize = static_cast<uint32_t>(
+			packed ? 2*sizeof(Sint16) : sizeof(glm::vec2));
+		const uint32_t colorSize = static_cast<uint32_t>(
+			packed ? sizeof(Uint32) : sizeof(glm::vec4));
+		// positions & colors each get their own stream, so updating one of
+		//	them never has to upload the other //
+		const VkDeviceSize positionStreamSize = 
+			positionSize*storedVerticesPerQuad*chunkQuadCount;
+		quadDataStreams.push_back({0, 
+								   positionSize*storedVerticesPerQuad,
+								   STAGING_QUAD_DATA_BIT_POSITION});
+		quadDataStreams.push_back({positionStreamSize, 
+								   colorSize*storedVerticesPerQuad,
+								   STAGING_QUAD_DATA_BIT_COLOR});
+		vertexBindingDescriptions = {
+			{QUAD_DATA_STREAM_POSITION,// binding
+				positionSize,// stride
+				VK_VERTEX_INPUT_RATE_VERTEX},
+			{QUAD_DATA_STREAM_COLOR,// binding
+				colorSize,// stride
+				VK_VERTEX_INPUT_RATE_VERTEX} };
+		vertexAttributeDescriptions = {
+			{0,//location
+				QUAD_DATA_STREAM_POSITION,//binding
+				packed ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R32G32_SFLOAT,
+				0},//offset
+			{1,//location
+				QUAD_DATA_STREAM_COLOR,//binding
+				packed ? VK_FORMAT_R8G8B8A8_UNORM : 
+					VK_FORMAT_R32G32B32A32_SFLOAT,
+				0} };//offset
+	}
+	QuadDataStream const& lastStream = quadDataStreams.back();
+	chunkDataSize = lastStream.bufferOffset + 
+		static_cast<VkDeviceSize>(lastStream.quadDataSize * chunkQuadCount);
+	chunkPageCount = static_cast<size_t>(
+		(chunkDataSize + DIRTY_PAGE_SIZE - 1) / DIRTY_PAGE_SIZE);
+	sharingQueueFamilies = { transferQueueFamilyIndex,
+							 graphicsQueueFamilyIndex };
+	// when the host can see device local memory, staging the quad data 
+	//	first would just be an extra copy of the same bytes.  The price is
+	//	that writes have to wait for the frames in flight to stop reading 
+	//	the quad data. //
+	writeQuadDataInPlace = allocator.isDeviceLocalHostVisible();
+	// the ring has to fit at least two pages, and never needs to be bigger
+	//	than the biggest the pool can get //
+	stagingRingSize = std::max(
+		std::min(srs, chunkDataSize*(maxQuadCount / chunkQuadCount)), 
+		2*std::min(DIRTY_PAGE_SIZE, chunkDataSize));
+	stagingRingHead = 0;
+	stagingRingTail = 0;
+	stagingRingUploads.clear();
+	if(!writeQuadDataInPlace &&
+	   !stagingRing.createBuffer(allocator, stagingRingSize,
+								 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+								 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+								 true))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool staging ring!\n");
+		return false;
+	}
+	SDL_Log("Quad pool data: %llu bytes per chunk of %i quads, up to %llu "
+			"quads, %s\n",
+		static_cast<unsigned long long>(chunkDataSize),
+		static_cast<int>(chunkQuadCount),
+		static_cast<unsigned long long>(maxQuadCount),
+		writeQuadDataInPlace ? "written in place" : "uploaded via staging");
+	if (!writeQuadDataInPlace)
+	{
+		SDL_Log("Quad pool staging ring: %llu bytes in memory heap %i\n",
+			static_cast<unsigned long long>(stagingRingSize),
+			static_cast<int>(stagingRing.getMemoryHeapIndex()));
+	}
+	const VkCommandPoolCreateInfo poolCreateInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		nullptr,// pNext
+		// upload command buffers are short lived, and get re-recorded every
+		//	time the Upload they belong to gets re-used
+		VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+			VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,// flags
+		transferQueueFamilyIndex
+	};
+	if (vkCreateCommandPool(device,
+							&poolCreateInfo,
+							nullptr,
+							&commandPool) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool transfer command pool!\n");
+		return false;
+	}
+	uploads.clear();
+	// The culling pre-pass reads the quad counts out of the draw commands.
+	//	Every frame reads every command, so they are always updated by the
+	//	device, even when the quad data is written in place. //
+	drawArgs.clear();
+	if (!drawArgsBuffer.createBuffer(allocator, 
+									 (maxQuadCount / chunkQuadCount)*
+										sizeof(VkDrawIndexedIndirectCommand),
+									 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+										VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+										VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+									 false,// persistently mapped
+									 sharingQueueFamilies))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool draw args buffer!\n");
+		return false;
+	}
+	if (drawMode == DrawMode::INDEXED &&
+		!createIndexBuffer(allocator, qMemoryTransfer))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool index buffer!\n");
+		return false;
+	}
+	return true;
+}
+void k10::QuadPool::drainPool()
+{
+	SDL_assert(producers.empty());
+	for (Upload const& u : uploads)
+	{
+		vkDestroyFence(device, u.fence, nullptr);
+		vkDestroySemaphore(device, u.semaphore, nullptr);
+		vkDestroySemaphore(device, u.framesDoneSemaphore, nullptr);
+	}
+	uploads.clear();
+	// destroying the pool frees all the upload command buffers too //
+	vkDestroyCommandPool(device, commandPool, nullptr);
+	for (Chunk& chunk : chunks)
+	{
+		if (chunk.created)
+		{
+			destroyChunk(chunk);
+		}
+	}
+	chunks.clear();
+	for (RetiredChunk& retiredChunk : retiredChunks)
+	{
+		destroyChunk(retiredChunk.chunk);
+	}
+	retiredChunks.clear();
+	// destroying the pools frees all the chunk descriptor sets too //
+	for (VkDescriptorPool descriptorPool : cullDescriptorPools)
+	{
+		vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+	}
+	cullDescriptorPools.clear();
+	if (cullPipeline != VK_NULL_HANDLE)
+	{
+		vkDestroyPipeline(device, cullPipeline, nullptr);
+		vkDestroyPipelineLayout(device, cullPipelineLayout, nullptr);
+		vkDestroyDescriptorSetLayout(device, cullDescriptorSetLayout, nullptr);
+		cullPipeline = VK_NULL_HANDLE;
+		cullPipelineLayout = VK_NULL_HANDLE;
+		cullDescriptorSetLayout = VK_NULL_HANDLE;
+	}
+	gpuCulling = false;
+	if (!writeQuadDataInPlace)
+	{
+		stagingRing.destroyBuffer();
+	}
+	stagingRingUploads.clear();
+	stagingArena = StagingArena();
+	stagingOverflowBlocks.clear();
+	if (drawMode == DrawMode::INDEXED)
+	{
+		quadIndexBuffer.destroyBuffer();
+	}
+	drawArgsBuffer.destroyBuffer();
+	drawArgs.clear();
+	if (streamingFrameCount > 0)
+	{
+		streamingBuffer.destroyBuffer();
+		streamingFrameCount = 0;
+	}
+}
+k10::QuadPool::QuadId k10::QuadPool::addQuad(vector<Vertex> const& vertices)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(drawMode != DrawMode::INSTANCED);
+	SDL_assert(vertices.size() == VERTICES_PER_QUAD);
+	const QuadId newQuadId = allocateQuad();
+	if (newQuadId == SlotAllocator::INVALID_SLOT)
+	{
+		return numeric_limits<QuadId>::max();
+	}
+	const QuadSlot slot = quadIdSlots[newQuadId];
+	const StagingWindow window = 
+		stageQuadData(slot, 1, STAGING_QUAD_DATA_BIT_ALL);
+	storeQuadVertices(window, slot, vertices.data());
+	return newQuadId;
+}
+bool k10::QuadPool::addQuads(size_t quadCount, QuadFiller const& fillQuad,
+							 vector<QuadId>* outQuadIds)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(drawMode != DrawMode::INSTANCED);
+	return allocateQuadRuns(quadCount, 
+		[this, &fillQuad](size_t firstQuadIndex, 
+						  StagingWindow const& window)->void
+		{
+			Vertex quadVertices[VERTICES_PER_QUAD];
+			for (QuadId q = 0; q < window.quadCount; q++)
+			{
+				fillQuad(firstQuadIndex + q, quadVertices);
+				storeQuadVertices(window, window.firstSlot + q, quadVertices);
+			}
+		}, outQuadIds);
+}
+bool k10::QuadPool::addQuads(vector<Vertex> const& vertices,
+							 vector<QuadId>* outQuadIds)
+{
+	SDL_assert(vertices.size() % VERTICES_PER_QUAD == 0);
+	return addQuads(vertices.size() / VERTICES_PER_QUAD,
+		[&vertices](size_t quadIndex, Vertex* quadVertices)->void
+		{
+			memcpy(quadVertices, &vertices[quadIndex*VERTICES_PER_QUAD],
+				   sizeof(Vertex) * VERTICES_PER_QUAD);
+		}, outQuadIds);
+}
+k10::QuadPool::QuadId k10::QuadPool::addQuadInstance(
+	QuadInstance const& instance)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(drawMode == DrawMode::INSTANCED);
+	const QuadId newQuadId = allocateQuad();
+	if (newQuadId == SlotAllocator::INVALID_SLOT)
+	{
+		return numeric_limits<QuadId>::max();
+	}
+	const QuadSlot slot = quadIdSlots[newQuadId];
+	const StagingWindow window = 
+		stageQuadData(slot, 1, STAGING_QUAD_DATA_BIT_ALL);
+	storeQuadInstance(window, slot, instance);
+	return newQuadId;
+}
+bool k10::QuadPool::addQuadInstances(size_t quadCount, 
+									 QuadInstanceFiller const& fillQuad,
+									 vector<QuadId>* outQuadIds)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(drawMode == DrawMode::INSTANCED);
+	return allocateQuadRuns(quadCount, 
+		[this, &fillQuad](size_t firstQuadIndex, 
+						  StagingWindow const& window)->void
+		{
+			// the instances are stored exactly the way the caller sees
+			//	them, so let them write straight into the staged data //
+			QuadInstance*const runInstances = 
+				reinterpret_cast<QuadInstance*>(getStagedQuadData(window,
+					QUAD_DATA_STREAM_INSTANCE, window.firstSlot));
+			for (QuadId q = 0; q < window.quadCount; q++)
+			{
+				fillQuad(firstQuadIndex + q, runInstances[q]);
+			}
+		}, outQuadIds);
+}
+void k10::QuadPool::updateQuadPositions(QuadId qid, 
+										glm::vec2 const* cornerPositions)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(drawMode != DrawMode::INSTANCED);
+	if (!validateQuadId(qid))
+	{
+		return;
+	}
+	const QuadSlot slot = quadIdSlots[qid];
+	const StagingWindow window = 
+		stageQuadData(slot, 1, STAGING_QUAD_DATA_BIT_POSITION);
+	storeQuadPositions(window, slot, cornerPositions);
+}
+void k10::QuadPool::updateQuadColors(QuadId qid, glm::vec4 const* cornerColors)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(drawMode != DrawMode::INSTANCED);
+	if (!validateQuadId(qid))
+	{
+		return;
+	}
+	const QuadSlot slot = quadIdSlots[qid];
+	const StagingWindow window = 
+		stageQuadData(slot, 1, STAGING_QUAD_DATA_BIT_COLOR);
+	storeQuadColors(window, slot, cornerColors);
+}
+void k10::QuadPool::updateQuadInstance(QuadId qid, 
+									   QuadInstance const& instance)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(drawMode == DrawMode::INSTANCED);
+	if (!validateQuadId(qid))
+	{
+		return;
+	}
+	const QuadSlot slot = quadIdSlots[qid];
+	const StagingWindow window = 
+		stageQuadData(slot, 1, STAGING_QUAD_DATA_BIT_ALL);
+	storeQuadInstance(window, slot, instance);
+}
+k10::QuadPool::QuadId k10::QuadPool::allocateQuad()
+{
+	if (!reserveSlots(1))
+	{
+		SDL_Log("Aborting attempt to add a quad to a filled pool.\n");
+		SDL_assert(false);
+		return SlotAllocator::INVALID_SLOT;
+	}
+	const QuadSlot newSlot = allocateSlot();
+	if (newSlot >= largestQuadCount)
+	{
+		largestQuadCount = newSlot + 1;
+	}
+	return bindQuadId(newSlot);
+}
+k10::QuadPool::QuadId k10::QuadPool::bindQuadId(QuadSlot slot)
+{
+	// there are never more live quads than slots, so growing to match 
+	//	quadSlots is always enough room //
+	if (quadIds.getAllocatedCount() == quadIds.getSlotCount())
+	{
+		quadIds.resize(quadSlots.getSlotCount());
+		quadIdSlots.resize(quadSlots.getSlotCount(), 
+						   SlotAllocator::INVALID_SLOT);
+	}
+	const QuadId qid = quadIds.allocate();
+	SDL_assert(qid != SlotAllocator::INVALID_SLOT);
+	quadIdSlots[qid] = slot;
+	slotQuadIds[slot] = qid;
+	return qid;
+}
+bool k10::QuadPool::reserveSlots(size_t quadCount)
+{
+	const size_t freeSlotCount = 
+		quadSlots.getSlotCount() - quadSlots.getAllocatedCount();
+	if (maxQuadCount - quadSlots.getAllocatedCount() < quadCount)
+	{
+		return false;
+	}
+	if (freeSlotCount < quadCount)
+	{
+		const size_t newChunkCount = chunks.size() + 
+			(quadCount - freeSlotCount + chunkQuadCount - 1) / chunkQuadCount;
+		chunks.resize(newChunkCount);
+		quadSlots.resize(newChunkCount*chunkQuadCount);
+		slotQuadIds.resize(newChunkCount*chunkQuadCount, 
+						   SlotAllocator::INVALID_SLOT);
+	}
+	// slots are always handed out lowest first, so the next quadCount 
+	//	slots are the first free ones of each chunk in order //
+	size_t remainingQuadCount = quadCount;
+	for (size_t c = 0; c < chunks.size() && remainingQuadCount > 0; c++)
+	{
+		const size_t chunkFreeSlotCount = 
+			chunkQuadCount - chunks[c].liveQuadCount;
+		if (chunkFreeSlotCount == 0)
+		{
+			continue;
+		}
+		if (!chunks[c].created && !createChunk(c))
+		{
+			return false;
+		}
+		remainingQuadCount -= 
+			std::min(chunkFreeSlotCount, remainingQuadCount);
+	}
+	return true;
+}
+k10::QuadPool::QuadSlot k10::QuadPool::allocateSlot()
+{
+	const QuadSlot slot = quadSlots.allocate();
+	SDL_assert(slot != SlotAllocator::INVALID_SLOT);
+	Chunk& chunk = chunks[slot / chunkQuadCount];
+	SDL_assert(chunk.created);
+	const QuadId chunkSlot = slot % chunkQuadCount;
+	chunk.liveQuadCount++;
+	chunk.writtenQuadCount = std::max(chunk.writtenQuadCount, chunkSlot + 1);
+	return slot;
+}
+void k10::QuadPool::releaseSlot(QuadSlot slot)
+{
+	quadSlots.release(slot);
+	Chunk& chunk = chunks[slot / chunkQuadCount];
+	SDL_assert(chunk.liveQuadCount > 0);
+	chunk.liveQuadCount--;
+}
+bool k10::QuadPool::createChunk(size_t chunkIndex)
+{
+	Chunk& chunk = chunks[chunkIndex];
+	SDL_assert(!chunk.created && chunk.liveQuadCount == 0);
+	// the culling pre-pass reads the quad data as a storage buffer //
+	if (!chunk.dataBuffer.createBuffer(*allocator, chunkDataSize,
+									   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+										VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+										VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+										VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+									   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+										(writeQuadDataInPlace ?
+											VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT :
+											0),
+									   writeQuadDataInPlace,
+									   sharingQueueFamilies))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool chunk!\n");
+		return false;
+	}
+	chunk.created = true;
+	chunk.writtenQuadCount = 0;
+	// whatever an earlier chunk left in the draw command is stale //
+	chunk.drawArgsQuadCount = numeric_limits<QuadId>::max();
+	chunk.dirtyPages.assign((chunkPageCount + 63) / 64, 0);
+	if (cullPipeline != VK_NULL_HANDLE && !createChunkCullResources(chunk))
+	{
+		destroyChunk(chunk);
+		chunk = Chunk();
+		return false;
+	}
+#ifndef NDEBUG
+	SDL_LogDebug(SDL_LOG_CATEGORY_VIDEO,
+		"QuadPool chunk %i created in memory heap %i\n",
+		static_cast<int>(chunkIndex),
+		static_cast<int>(chunk.dataBuffer.getMemoryHeapIndex()));
+#endif
+	return true;
+}
+void k10::QuadPool::retireChunk(size_t chunkIndex)
+{
+	Chunk& chunk = chunks[chunkIndex];
+	SDL_assert(chunk.created && chunk.liveQuadCount == 0);
+	// nothing is left in the chunk that is worth uploading //
+	for (Uint64 dirtyWord : chunk.dirtyPages)
+	{
+		for (; dirtyWord != 0; dirtyWord &= dirtyWord - 1)
+		{
+			dirtyPageCount--;
+		}
+	}
+	chunk.dirtyPages.clear();
+	// Any frame that is still in flight might be drawing the chunk, and 
+	//	any upload that is still in flight might be copying to or from it.
+	//	Frame fences that get reset & re-submitted in the meantime just 
+	//	make us wait a little longer. //
+	RetiredChunk retiredChunk = { chunk, frameFences };
+	for (Upload const& u : uploads)
+	{
+		if (u.inFlight)
+		{
+			retiredChunk.fences.push_back(u.fence);
+		}
+	}
+	retiredChunks.push_back(retiredChunk);
+	chunk = Chunk();
+#ifndef NDEBUG
+	SDL_LogDebug(SDL_LOG_CATEGORY_VIDEO,
+		"QuadPool chunk %i released\n", static_cast<int>(chunkIndex));
+#endif
+}
+void k10::QuadPool::releaseEmptyChunks()
+{
+	// Empty chunks inside the draw range are about to get filled back up
+	//	by compaction, so they're only worth releasing when it's disabled.
+	//	The first chunk past the draw range is kept around as a spare, so a
+	//	pool that hovers around the end of a chunk doesn't keep creating & 
+	//	releasing it. //
+	const size_t usedChunkCount = 
+		(largestQuadCount + chunkQuadCount - 1) / chunkQuadCount;
+	const size_t keptChunkCount = std::min(usedChunkCount + 1, chunks.size());
+	for (size_t c = 0; c < chunks.size(); c++)
+	{
+		if (!chunks[c].created || chunks[c].liveQuadCount > 0)
+		{
+			continue;
+		}
+		if (c >= keptChunkCount || 
+			(c < usedChunkCount && compactionMoveBudget == 0))
+		{
+			retireChunk(c);
+		}
+	}
+	if (keptChunkCount < chunks.size())
+	{
+		chunks.resize(keptChunkCount);
+		quadSlots.resize(keptChunkCount*chunkQuadCount);
+		slotQuadIds.resize(keptChunkCount*chunkQuadCount);
+	}
+}
+bool k10::QuadPool::createChunkCullResources(Chunk& chunk)
+{
+	const VkDeviceSize cullOutputQuadSize = drawMode == DrawMode::INSTANCED ?
+		sizeof(QuadInstance) : INDICES_PER_QUAD*sizeof(uint32_t);
+	// the visible quads of each workgroup get counted after the output //
+	const VkDeviceSize cullGroupCount = 
+		(chunkQuadCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE;
+	// only the graphics queue ever touches the cull buffer //
+	if (!chunk.cullBuffer.createBuffer(*allocator, 
+									   CULL_OUTPUT_OFFSET + 
+										cullOutputQuadSize*chunkQuadCount +
+										sizeof(uint32_t)*cullGroupCount,
+									   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+										VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+										(drawMode == DrawMode::INSTANCED ?
+											VK_BUFFER_USAGE_VERTEX_BUFFER_BIT :
+											VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+									   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool chunk cull buffer!\n");
+		return false;
+	}
+	// every set is the same size, so a pool that fails to allocate one is
+	//	simply full //
+	for (size_t p = cullDescriptorPools.size(); p > 0; p--)
+	{
+		const VkDescriptorSetAllocateInfo allocInfo = {
+			VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			nullptr,// pNext
+			cullDescriptorPools[p - 1],
+			1,// descriptor set count
+			&cullDescriptorSetLayout
+		};
+		if (vkAllocateDescriptorSets(device, &allocInfo, 
+									 &chunk.cullDescriptorSet) == VK_SUCCESS)
+		{
+			chunk.cullDescriptorPool = cullDescriptorPools[p - 1];
+			break;
+		}
+	}
+	if (chunk.cullDescriptorSet == VK_NULL_HANDLE)
+	{
+		const VkDescriptorPoolSize poolSize = {
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			3*CULL_DESCRIPTOR_POOL_SET_COUNT // descriptor count
+		};
+		const VkDescriptorPoolCreateInfo poolCreateInfo = {
+			VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			nullptr,// pNext
+			VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,// flags
+			CULL_DESCRIPTOR_POOL_SET_COUNT,// max sets
+			1, &poolSize
+		};
+		VkDescriptorPool descriptorPool;
+		if (vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, 
+								   &descriptorPool) != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to create quad pool cull descriptor pool!\n");
+			return false;
+		}
+		cullDescriptorPools.push_back(descriptorPool);
+		const VkDescriptorSetAllocateInfo allocInfo = {
+			VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			nullptr,// pNext
+			descriptorPool,
+			1,// descriptor set count
+			&cullDescriptorSetLayout
+		};
+		if (vkAllocateDescriptorSets(device, &allocInfo, 
+									 &chunk.cullDescriptorSet) != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to allocate quad pool cull descriptor set!\n");
+			chunk.cullDescriptorSet = VK_NULL_HANDLE;
+			return false;
+		}
+		chunk.cullDescriptorPool = descriptorPool;
+	}
+	// the pre-pass only needs the positions, which always come first //
+	QuadDataStream const& cullStream = quadDataStreams[0];
+	const VkDescriptorBufferInfo bufferInfos[] = {
+		{chunk.dataBuffer.getBuffer(),
+			cullStream.bufferOffset,// offset
+			cullStream.quadDataSize*chunkQuadCount},// range
+		{chunk.cullBuffer.getBuffer(),
+			0,// offset
+			VK_WHOLE_SIZE},// range
+		{drawArgsBuffer.getBuffer(),
+			0,// offset
+			VK_WHOLE_SIZE} };// range
+	const VkWriteDescriptorSet descriptorWrites[] = {
+		{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			nullptr,// pNext
+			chunk.cullDescriptorSet,
+			0,// binding
+			0,// array element
+			1,// descriptor count
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			nullptr,// image info
+			&bufferInfos[0],
+			nullptr},// texel buffer view
+		{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			nullptr,// pNext
+			chunk.cullDescriptorSet,
+			1,// binding
+			0,// array element
+			1,// descriptor count
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			nullptr,// image info
+			&bufferInfos[1],
+			nullptr},// texel buffer view
+		{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			nullptr,// pNext
+			chunk.cullDescriptorSet,
+			2,// binding
+			0,// array element
+			1,// descriptor count
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			nullptr,// image info
+			&bufferInfos[2],
+			nullptr} };// texel buffer view
+	vkUpdateDescriptorSets(device, 3, descriptorWrites, 0, nullptr);
+	return true;
+}
+void k10::QuadPool::destroyChunk(Chunk& chunk)
+{
+	chunk.dataBuffer.destroyBuffer();
+	if (chunk.cullDescriptorSet != VK_NULL_HANDLE)
+	{
+		vkFreeDescriptorSets(device, chunk.cullDescriptorPool, 1, 
+							 &chunk.cullDescriptorSet);
+		chunk.cullDescriptorSet = VK_NULL_HANDLE;
+	}
+	chunk.cullBuffer.destroyBuffer();
+}
+k10::QuadPool::QuadId k10::QuadPool::getChunkDrawQuadCount(
+	size_t chunkIndex) const
+{
+	Chunk const& chunk = chunks[chunkIndex];
+	if (chunk.liveQuadCount == 0 || 
+		chunkIndex*chunkQuadCount >= largestQuadCount)
+	{
+		return 0;
+	}
+	return std::min(chunk.writtenQuadCount,
+		static_cast<QuadId>(largestQuadCount - chunkIndex*chunkQuadCount));
+}
+void k10::QuadPool::destroyRetiredChunks()
+{
+	for (size_t r = 0; r < retiredChunks.size();)
+	{
+		RetiredChunk& retiredChunk = retiredChunks[r];
+		bool inUse = false;
+		for (VkFence fence : retiredChunk.fences)
+		{
+			if (vkGetFenceStatus(device, fence) != VK_SUCCESS)
+			{
+				inUse = true;
+				break;
+			}
+		}
+		if (inUse)
+		{
+			r++;
+			continue;
+		}
+		destroyChunk(retiredChunk.chunk);
+		retiredChunks.erase(retiredChunks.begin() + r);
+	}
+}
+VkDeviceSize k10::QuadPool::getQuadDataOffset(QuadDataStream const& stream,
+											  QuadSlot slot) const
+{
+	return (slot / chunkQuadCount)*chunkDataSize + stream.bufferOffset + 
+		(slot % chunkQuadCount)*stream.quadDataSize;
+}
+Uint8* k10::QuadPool::getQuadDataWindow(VkDeviceSize quadDataOffset, 
+										VkDeviceSize size)
+{
+	Chunk& chunk = chunks[quadDataOffset / chunkDataSize];
+	const VkDeviceSize chunkOffset = quadDataOffset % chunkDataSize;
+	SDL_assert(writeQuadDataInPlace);
+	SDL_assert(chunk.created && chunkOffset + size <= chunkDataSize);
+	waitForInPlaceReaders(quadDataOffset);
+	return chunk.dataBuffer.getMappedWindow<Uint8>(chunkOffset, 
+		static_cast<size_t>(size));
+}
+Uint8* k10::QuadPool::allocateStagedRun(StagingArena& arena, 
+										VkDeviceSize quadDataOffset, 
+										VkDeviceSize size)
+{
+	SDL_assert(!writeQuadDataInPlace && size > 0);
+	if (!arena.blockData || arena.blockUsedSize + size > arena.blockSize)
+	{
+		allocateStagingBlock(arena, size);
+	}
+	const StagedRun run = {
+		arena.blockData + arena.blockUsedSize,
+		arena.blockRingOffset + arena.blockUsedSize,// ring offset
+		arena.blockInRing,
+		quadDataOffset,
+		size,
+		nextStagedRunSequence++ // sequence
+	};
+	arena.runs.push_back(run);
+	arena.blockUsedSize += size;
+	return run.data;
+}
+void k10::QuadPool::allocateStagingBlock(StagingArena& arena, 
+										 VkDeviceSize minSize)
+{
+	std::lock_guard<std::mutex> lock(stagingBlockMutex);
+	// whatever is left of the last block is wasted until the next flush
+	//	frees it along with the runs in it //
+	arena.blockSize = std::max(minSize, 
+		std::min(STAGING_BLOCK_SIZE, stagingRingSize / 2));
+	arena.blockUsedSize = 0;
+	arena.blockInRing = arena.blockSize <= stagingRingSize / 2 &&
+		allocateStagingRing(arena.blockSize, arena.blockRingOffset);
+	if (arena.blockInRing)
+	{
+		arena.blockData = stagingRing.getWriteWindow<Uint8>(
+			arena.blockRingOffset, static_cast<size_t>(arena.blockSize));
+		return;
+	}
+	// The ring is still full of uploads that haven't finished, so rather
+	//	than waiting on them the block is held on the host until the next
+	//	flush copies it into the ring.  The blocks never get resized, so 
+	//	pointers into them stay valid. //
+	stagingOverflowBlocks.emplace_back(static_cast<size_t>(arena.blockSize));
+	arena.blockRingOffset = 0;
+	arena.blockData = stagingOverflowBlocks.back().data();
+}
+void k10::QuadPool::markQuadDataDirty(VkDeviceSize quadDataOffset, 
+									  VkDeviceSize size)
+{
+	SDL_assert(size > 0);
+	Chunk& chunk = chunks[quadDataOffset / chunkDataSize];
+	const VkDeviceSize chunkOffset = quadDataOffset % chunkDataSize;
+	const size_t lastPage = 
+		static_cast<size_t>((chunkOffset + size - 1) / DIRTY_PAGE_SIZE);
+	for (size_t page = static_cast<size_t>(chunkOffset / DIRTY_PAGE_SIZE);
+		 page <= lastPage; page++)
+	{
+		Uint64& dirtyWord = chunk.dirtyPages[page / 64];
+		const Uint64 pageBit = Uint64(1) << (page % 64);
+		if (!(dirtyWord & pageBit))
+		{
+			dirtyWord |= pageBit;
+			dirtyPageCount++;
+		}
+	}
+}
+void k10::QuadPool::waitForInPlaceReaders(VkDeviceSize quadDataOffset)
+{
+	if (!inPlaceReadersPending)
+	{
+		return;
+	}
+	// a frame draws the first N quads of every stream in a chunk, so only
+	//	the quad's slot within its chunk matters //
+	const size_t chunkIndex = static_cast<size_t>(quadDataOffset / 
+												  chunkDataSize);
+	const VkDeviceSize chunkOffset = quadDataOffset % chunkDataSize;
+	QuadId chunkSlot = 0;
+	for (QuadDataStream const& stream : quadDataStreams)
+	{
+		if (chunkOffset >= stream.bufferOffset)
+		{
+			chunkSlot = static_cast<QuadId>(
+				(chunkOffset - stream.bufferOffset) / stream.quadDataSize);
+		}
+	}
+	std::lock_guard<std::mutex> lock(inPlaceReaderMutex);
+	// the readers we wait on are done, so they get dropped //
+	size_t keptReaderCount = 0;
+	for (size_t r = 0; r < inPlaceReaders.size(); r++)
+	{
+		InPlaceReader& reader = inPlaceReaders[r];
+		if (chunkIndex < reader.chunkDrawQuadCounts.size() &&
+			chunkSlot < reader.chunkDrawQuadCounts[chunkIndex])
+		{
+			vkWaitForFences(device, 1, &reader.fence, VK_TRUE, 
+							numeric_limits<uint64_t>::max());
+			continue;
+		}
+		if (r != keptReaderCount)
+		{
+			std::swap(inPlaceReaders[keptReaderCount], reader);
+		}
+		keptReaderCount++;
+	}
+	inPlaceReaders.resize(keptReaderCount);
+	inPlaceReadersPending = keptReaderCount > 0;
+}
+void k10::QuadPool::collectDirtyRuns()
+{
+	dirtyRegions.clear();
+	lastFlushStats.dirtyPageCount = dirtyPageCount;
+	for (size_t c = 0; c < chunks.size() && dirtyPageCount > 0; c++)
+	{
+		vector<Uint64>& dirtyPages = chunks[c].dirtyPages;
+		for (size_t w = 0; w < dirtyPages.size(); w++)
+		{
+			while (dirtyPages[w] != 0)
+			{
+				// a run can carry on into the words after this one //
+				const size_t firstPage = w*64 + lowestSetBit(dirtyPages[w]);
+				size_t endPage = firstPage;
+				for (; endPage < chunkPageCount && 
+						(dirtyPages[endPage / 64] >> (endPage % 64)) & 1; 
+					 endPage++)
+				{
+					dirtyPages[endPage / 64] &= 
+						~(Uint64(1) << (endPage % 64));
+					dirtyPageCount--;
+				}
+				const VkDeviceSize runOffset = firstPage*DIRTY_PAGE_SIZE;
+				const VkDeviceSize runEnd = 
+					std::min(endPage*DIRTY_PAGE_SIZE, chunkDataSize);
+				const VkBufferCopy dirtyRegion = {
+					0,// src offset
+					c*chunkDataSize + runOffset,// dst offset
+					runEnd - runOffset
+				};
+				dirtyRegions.push_back(dirtyRegion);
+			}
+		}
+	}
+	SDL_assert(dirtyPageCount == 0);
+	lastFlushStats.dirtyRunCount = dirtyRegions.size();
+}
+void k10::QuadPool::collectStagedRuns()
+{
+	// the rest of the pool's block goes away with the runs in it //
+	vector<StagedRun>& writtenRuns = stagingArena.runs;
+	stagingArena.blockData = nullptr;
+	stagedRuns.clear();
+	// Going through the runs latest first, each one only keeps the parts
+	//	that none of the runs after it wrote.  coveredRanges holds the 
+	//	start & end of every range of quad data taken so far, where ranges
+	//	that touch get merged. //
+	std::sort(writtenRuns.begin(), writtenRuns.end(),
+		[](StagedRun const& a, StagedRun const& b)
+		{
+			return a.sequence > b.sequence;
+		});
+	std::map<VkDeviceSize, VkDeviceSize> coveredRanges;
+	for (StagedRun const& run : writtenRuns)
+	{
+		SDL_assert(chunks[run.quadDataOffset / chunkDataSize].created);
+		auto keepRange = [&](VkDeviceSize begin, VkDeviceSize end)->void
+		{
+			StagedRun keptRun = run;
+			keptRun.data += begin - run.quadDataOffset;
+			keptRun.ringOffset += begin - run.quadDataOffset;
+			keptRun.quadDataOffset = begin;
+			keptRun.size = end - begin;
+			stagedRuns.push_back(keptRun);
+		};
+		const VkDeviceSize runEnd = run.quadDataOffset + run.size;
+		auto firstCovered = coveredRanges.upper_bound(run.quadDataOffset);
+		if (firstCovered != coveredRanges.begin() && 
+			std::prev(firstCovered)->second >= run.quadDataOffset)
+		{
+			firstCovered--;
+		}
+		VkDeviceSize uncovered = run.quadDataOffset;
+		VkDeviceSize mergedBegin = run.quadDataOffset;
+		VkDeviceSize mergedEnd = runEnd;
+		auto lastCovered = firstCovered;
+		for (; lastCovered != coveredRanges.end() && 
+				lastCovered->first <= runEnd; 
+			 lastCovered++)
+		{
+			if (lastCovered->first > uncovered)
+			{
+				keepRange(uncovered, lastCovered->first);
+			}
+			uncovered = std::max(uncovered, lastCovered->second);
+			mergedBegin = std::min(mergedBegin, lastCovered->first);
+			mergedEnd = std::max(mergedEnd, lastCovered->second);
+		}
+		if (uncovered < runEnd)
+		{
+			keepRange(uncovered, runEnd);
+		}
+		coveredRanges.erase(firstCovered, lastCovered);
+		coveredRanges[mergedBegin] = mergedEnd;
+	}
+	writtenRuns.clear();
+	// runs next to each other in staging memory that land next to each 
+	//	other in the same chunk can go out as a single copy region //
+	std::sort(stagedRuns.begin(), stagedRuns.end(),
+		[](StagedRun const& a, StagedRun const& b)
+		{
+			return a.quadDataOffset < b.quadDataOffset;
+		});
+	size_t coalescedRunCount = 0;
+	for (size_t r = 0; r < stagedRuns.size(); r++)
+	{
+		StagedRun const& run = stagedRuns[r];
+		if (coalescedRunCount > 0)
+		{
+			StagedRun& lastRun = stagedRuns[coalescedRunCount - 1];
+			if (lastRun.inRing == run.inRing && 
+				lastRun.data + lastRun.size == run.data &&
+				lastRun.quadDataOffset + lastRun.size == run.quadDataOffset &&
+				run.quadDataOffset % chunkDataSize != 0)
+			{
+				lastRun.size += run.size;
+				continue;
+			}
+		}
+		stagedRuns[coalescedRunCount++] = run;
+	}
+	stagedRuns.resize(coalescedRunCount);
+	// the runs in the ring are all copied by the first upload //
+	std::stable_partition(stagedRuns.begin(), stagedRuns.end(),
+		[](StagedRun const& run)
+		{
+			return run.inRing;
+		});
+	lastFlushStats.dirtyRunCount = stagedRuns.size();
+	for (StagedRun const& run : stagedRuns)
+	{
+		lastFlushStats.copiedByteCount += run.size;
+	}
+}
+void k10::QuadPool::recordQuadDataCopies(VkCommandBuffer cb, 
+										 GfxBuffer* srcBuffer,
+										 vector<VkBufferCopy>& regions)
+{
+	auto srcChunk = [&](VkBufferCopy const& region)->size_t
+	{
+		return srcBuffer ? 0 : region.srcOffset / chunkDataSize;
+	};
+	auto dstChunk = [&](VkBufferCopy const& region)->size_t
+	{
+		return region.dstOffset / chunkDataSize;
+	};
+	std::stable_sort(regions.begin(), regions.end(),
+		[&](VkBufferCopy const& a, VkBufferCopy const& b)
+		{
+			return srcChunk(a) != srcChunk(b) ? srcChunk(a) < srcChunk(b) :
+				dstChunk(a) < dstChunk(b);
+		});
+	size_t first = 0;
+	while (first < regions.size())
+	{
+		const size_t sc = srcChunk(regions[first]);
+		const size_t dc = dstChunk(regions[first]);
+		size_t last = first;
+		for (; last < regions.size() && srcChunk(regions[last]) == sc && 
+				dstChunk(regions[last]) == dc; last++)
+		{
+			if (!srcBuffer)
+			{
+				regions[last].srcOffset -= sc*chunkDataSize;
+			}
+			regions[last].dstOffset -= dc*chunkDataSize;
+		}
+		SDL_assert(chunks[dc].created && (srcBuffer || chunks[sc].created));
+		vkCmdCopyBuffer(cb,
+						srcBuffer ? srcBuffer->getBuffer() : 
+							chunks[sc].dataBuffer.getBuffer(),
+						chunks[dc].dataBuffer.getBuffer(),
+						static_cast<uint32_t>(last - first), &regions[first]);
+		first = last;
+	}
+}
+bool k10::QuadPool::allocateQuadRuns(size_t quadCount, 
+									 QuadRunWriter const& writeRun,
+									 vector<QuadId>* outQuadIds)
+{
+	if (!reserveSlots(quadCount))
+	{
+		SDL_Log("Aborting attempt to add %i quads to a pool with only %i "
+				"free slots.\n", static_cast<int>(quadCount), 
+				static_cast<int>(maxQuadCount - 
+								 quadSlots.getAllocatedCount()));
+		SDL_assert(false);
+		return false;
+	}
+	if (outQuadIds)
+	{
+		outQuadIds->reserve(outQuadIds->size() + quadCount);
+	}
+	size_t quadIndex = 0;
+	while (quadIndex < quadCount)
+	{
+		// reserve the longest run of consecutive slots we can get, so that
+		//	the whole run can be staged in one go //
+		const QuadSlot runFirstSlot = allocateSlot();
+		QuadId runQuadCount = 1;
+		while (quadIndex + runQuadCount < quadCount)
+		{
+			const QuadSlot nextSlot = allocateSlot();
+			if (nextSlot != runFirstSlot + runQuadCount)
+			{
+				// the slot isn't part of this run; give it back so the next
+				//	run can start with it //
+				releaseSlot(nextSlot);
+				break;
+			}
+			runQuadCount++;
+		}
+		if (runFirstSlot + runQuadCount > largestQuadCount)
+		{
+			largestQuadCount = runFirstSlot + runQuadCount;
+		}
+		// the run gets staged in pieces that don't cross into the next 
+		//	chunk //
+		QuadId pieceQuadCount;
+		for (QuadId q = 0; q < runQuadCount; q += pieceQuadCount)
+		{
+			const QuadId pieceChunkSlot = (runFirstSlot + q) % chunkQuadCount;
+			pieceQuadCount = std::min(runQuadCount - q, 
+									  chunkQuadCount - pieceChunkSlot);
+			writeRun(quadIndex + q, stageQuadData(runFirstSlot + q, 
+												  pieceQuadCount, 
+												  STAGING_QUAD_DATA_BIT_ALL));
+		}
+		for (QuadId q = 0; q < runQuadCount; q++)
+		{
+			const QuadId qid = bindQuadId(runFirstSlot + q);
+			if (outQuadIds)
+			{
+				outQuadIds->push_back(qid);
+			}
+		}
+		quadIndex += runQuadCount;
+	}
+	return true;
+}
+void k10::QuadPool::removeQuad(QuadId qid)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	if (!validateQuadId(qid))
+	{
+		return;
+	}
+	const QuadSlot slot = quadIdSlots[qid];
+	releaseQuad(qid);
+	// Quads that are still inside the draw range need to be overwritten with
+	//	degenerate geometry so they stop getting rasterized.  Quads outside of
+	//	the draw range are never drawn, and will be completely overwritten
+	//	when their slot gets re-used, so we can just leave them alone.
+	if (slot < largestQuadCount)
+	{
+		storeDegenerateQuad(
+			stageQuadData(slot, 1, getDegenerateQuadDataBits()), slot);
+	}
+}
+void k10::QuadPool::releaseQuad(QuadId qid)
+{
+	const QuadSlot slot = quadIdSlots[qid];
+	quadIds.release(qid);
+	releaseSlot(slot);
+	quadIdSlots[qid] = SlotAllocator::INVALID_SLOT;
+	slotQuadIds[slot] = SlotAllocator::INVALID_SLOT;
+	// If we just emptied the tail of the pool, shrink the draw range down
+	//	to the last quad that is still alive so the render pass stops 
+	//	processing the dead vertices at the end of the buffer //
+	if (slot + 1 == largestQuadCount)
+	{
+		const QuadSlot lastSlot = quadSlots.findLastAllocated(slot);
+		largestQuadCount = lastSlot == SlotAllocator::INVALID_SLOT ? 
+			0 : lastSlot + 1;
+	}
+}
+size_t k10::QuadPool::getDirtyPageIndex(VkDeviceSize quadDataOffset) const
+{
+	return static_cast<size_t>(quadDataOffset / chunkDataSize)*chunkPageCount +
+		static_cast<size_t>((quadDataOffset % chunkDataSize) / DIRTY_PAGE_SIZE);
+}
+void k10::QuadPool::mergeProducer(Producer& producer)
+{
+	// the Producer's pages can only be in chunks that still have live 
+	//	quads, since nothing gets released until its removed quads are 
+	//	merged right after this //
+	for (size_t w = 0; w < producer.dirtyPages.size(); w++)
+	{
+		for (Uint64& dirtyWord = producer.dirtyPages[w]; dirtyWord != 0; 
+			 dirtyWord &= dirtyWord - 1)
+		{
+			const size_t page = w*64 + lowestSetBit(dirtyWord);
+			const size_t c = page / chunkPageCount;
+			SDL_assert(c < chunks.size() && chunks[c].created);
+			markQuadDataDirty(c*chunkDataSize + 
+				(page % chunkPageCount)*DIRTY_PAGE_SIZE, 1);
+		}
+	}
+	// the Producer's block goes away with the runs in it //
+	stagingArena.runs.insert(stagingArena.runs.end(), 
+							 producer.stagingArena.runs.begin(),
+							 producer.stagingArena.runs.end());
+	producer.stagingArena.runs.clear();
+	producer.stagingArena.blockData = nullptr;
+	for (QuadId qid : producer.removedQuadIds)
+	{
+		if (validateQuadId(qid))
+		{
+			releaseQuad(qid);
+		}
+	}
+	producer.removedQuadIds.clear();
+}
+VkDrawIndexedIndirectCommand k10::QuadPool::getDrawArgs(
+	QuadId quadCount) const
+{
+	return {
+		drawMode == DrawMode::INSTANCED ? 
+			INDICES_PER_QUAD : quadCount*INDICES_PER_QUAD,// index count
+		drawMode == DrawMode::INSTANCED ? quadCount : 1,// instance count
+		0,// first index (or first vertex)
+		0,// vertex offset (or first instance)
+		0 // first instance
+	};
+}
+bool k10::QuadPool::drawArgsOutdated() const
+{
+	for (size_t c = 0; c < chunks.size(); c++)
+	{
+		if (chunks[c].created && 
+			chunks[c].drawArgsQuadCount != getChunkDrawQuadCount(c))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+bool k10::QuadPool::updateDrawArgs(VkCommandBuffer cb)
+{
+	drawArgs.resize(chunks.size());
+	// the commands of every chunk in between two outdated chunks get 
+	//	written along with them, since that's still a single update //
+	size_t firstOutdated = chunks.size();
+	size_t lastOutdated = 0;
+	for (size_t c = 0; c < chunks.size(); c++)
+	{
+		Chunk& chunk = chunks[c];
+		const QuadId chunkDrawQuadCount = getChunkDrawQuadCount(c);
+		if (!chunk.created || chunk.drawArgsQuadCount == chunkDrawQuadCount)
+		{
+			continue;
+		}
+		chunk.drawArgsQuadCount = chunkDrawQuadCount;
+		drawArgs[c] = getDrawArgs(chunkDrawQuadCount);
+		firstOutdated = std::min(firstOutdated, c);
+		lastOutdated = c;
+	}
+	if (firstOutdated > lastOutdated)
+	{
+		return false;
+	}
+	if (writeQuadDataInPlace)
+	{
+		// frames in flight might still be reading the commands, so they 
+		//	get written by the next frame's command buffer instead //
+		if (drawArgsUpdateBegin >= drawArgsUpdateEnd)
+		{
+			drawArgsUpdateBegin = firstOutdated;
+			drawArgsUpdateEnd = lastOutdated + 1;
+		}
+		else
+		{
+			drawArgsUpdateBegin = std::min(drawArgsUpdateBegin, firstOutdated);
+			drawArgsUpdateEnd = std::max(drawArgsUpdateEnd, lastOutdated + 1);
+		}
+		return true;
+	}
+	recordDrawArgsUpdates(cb, firstOutdated, lastOutdated + 1);
+	return true;
+}
+void k10::QuadPool::recordDrawArgsUpdates(VkCommandBuffer cb, 
+										  size_t firstChunk,
+										  size_t endChunk) const
+{
+	// vkCmdUpdateBuffer can only write 65536 bytes at a time //
+	const size_t maxUpdateCommandCount = 
+		65536 / sizeof(VkDrawIndexedIndirectCommand);
+	for (size_t c = firstChunk; c < endChunk; c += maxUpdateCommandCount)
+	{
+		const size_t commandCount = 
+			std::min(endChunk - c, maxUpdateCommandCount);
+		vkCmdUpdateBuffer(cb, drawArgsBuffer.getBuffer(), 
+						  c*sizeof(VkDrawIndexedIndirectCommand),
+						  commandCount*sizeof(VkDrawIndexedIndirectCommand),
+						  &drawArgs[c]);
+	}
+}
+void k10::QuadPool::flushVertexStaging(VkQueue qMemoryTransfer, 
+										VkQueue qGraphics)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	submitStaging(qMemoryTransfer, qGraphics);
+}
+void k10::QuadPool::setCompactionMoveBudget(QuadId maxMovesPerFlush)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	compactionMoveBudget = maxMovesPerFlush;
+}
+bool k10::QuadPool::createCullPipeline(GfxProgram const* cullProgram)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(cullPipeline == VK_NULL_HANDLE);
+	// binding 0 is the quad data the pre-pass reads, binding 1 is the cull
+	//	buffer it writes, and binding 2 holds the draw commands it reads 
+	//	the quad counts out of //
+	const VkDescriptorSetLayoutBinding layoutBindings[] = {
+		{0,// binding
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			1,// descriptor count
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			nullptr},// immutable samplers
+		{1,// binding
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			1,// descriptor count
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			nullptr},// immutable samplers
+		{2,// binding
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			1,// descriptor count
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			nullptr} };// immutable samplers
+	const VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		nullptr,// pNext
+		0,// flags
+		3, layoutBindings
+	};
+	if (vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr,
+									&cullDescriptorSetLayout) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool cull descriptor set layout!\n");
+		SDL_assert(false);
+		return false;
+	}
+	const VkPushConstantRange pushConstantRange = {
+		VK_SHADER_STAGE_COMPUTE_BIT,
+		0,// offset
+		sizeof(CullParams)
+	};
+	const VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		nullptr,// pNext
+		0,// flags
+		1, &cullDescriptorSetLayout,
+		1, &pushConstantRange
+	};
+	if (vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr,
+							   &cullPipelineLayout) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool cull pipeline layout!\n");
+		SDL_assert(false);
+		return false;
+	}
+	const VkComputePipelineCreateInfo pipelineCreateInfo = {
+		VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		nullptr,// pNext
+		0,// flags
+		cullProgram->getPipelineShaderStageCreateInfo(),
+		cullPipelineLayout,
+		VK_NULL_HANDLE,// base pipeline handle
+		-1 // base pipeline index
+	};
+	if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, 
+								 &pipelineCreateInfo, nullptr,
+								 &cullPipeline) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool cull pipeline!\n");
+		SDL_assert(false);
+		cullPipeline = VK_NULL_HANDLE;
+		return false;
+	}
+	// chunks created before now don't have anything to cull into yet //
+	for (Chunk& chunk : chunks)
+	{
+		if (chunk.created && !createChunkCullResources(chunk))
+		{
+			return false;
+		}
+	}
+	gpuCulling = true;
+	return true;
+}
+void k10::QuadPool::setGpuCulling(bool enabled)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	gpuCulling = enabled && cullPipeline != VK_NULL_HANDLE;
+}
+bool k10::QuadPool::isGpuCullingEnabled() const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+	return gpuCulling;
+}
+void k10::QuadPool::submitStaging(VkQueue qMemoryTransfer, 
+								  VkQueue qGraphics)
+{
+	for (Producer* producer : producers)
+	{
+		mergeProducer(*producer);
+	}
+	producerChangesPending = false;
+	destroyRetiredChunks();
+	const bool compact = compactionRequired();
+	if (dirtyPageCount == 0 && !compact && !drawArgsOutdated())
+	{
+		releaseEmptyChunks();
+		return;
+	}
+	lastFlushStats = {};
+	if (writeQuadDataInPlace)
+	{
+		// the host writes just have to be visible by the next queue 
+		//	submission, which happens implicitly once they are flushed.
+		//	Compaction writes its moves in place too, so it goes first. //
+		if (compact)
+		{
+			compactQuads();
+		}
+		collectDirtyRuns();
+		for (VkBufferCopy const& dirtyRegion : dirtyRegions)
+		{
+			chunks[dirtyRegion.dstOffset / chunkDataSize].dataBuffer.
+				flushMappedRange(dirtyRegion.dstOffset % chunkDataSize, 
+								 dirtyRegion.size);
+			lastFlushStats.copiedByteCount += dirtyRegion.size;
+		}
+		updateDrawArgs(VK_NULL_HANDLE);
+		releaseEmptyChunks();
+		return;
+	}
+	// the dirty pages only decided that there is something to flush //
+	collectDirtyRuns();
+	collectStagedRuns();
+	reclaimStagingRing(false);
+	const VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		nullptr,// pNext
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		nullptr // inheritance info pointer
+	};
+	// Uploads don't wait for each other to finish, so make sure the copies
+	//	of any earlier upload on this queue are done writing before ours 
+	//	start writing on top of them.  When the graphics queue is this same
+	//	queue, the frames submitted before us also have to be done reading
+	//	the quad data we are about to overwrite. //
+	const VkMemoryBarrier transferBarrier = {
+		VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		nullptr,// pNext
+		VK_ACCESS_TRANSFER_WRITE_BIT,// src access mask
+		VK_ACCESS_TRANSFER_WRITE_BIT // dst access mask
+	};
+	const VkPipelineStageFlags transferBarrierSrcStages = 
+		VK_PIPELINE_STAGE_TRANSFER_BIT |
+		(qGraphics == qMemoryTransfer ?
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+				(cullPipeline != VK_NULL_HANDLE ?
+					VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : 0) :
+			0);
+	// the staged run being copied, & how much of it has been copied
+	size_t sr = 0;
+	VkDeviceSize runCopiedSize = 0;
+	// the ring up to here is held by uploads that were already submitted
+	VkDeviceSize submittedRingEnd = stagingRingUploads.empty() ? 
+		stagingRingTail : uploads[stagingRingUploads.back()].stagingRingEnd;
+	bool lastUpload = false;
+	bool framesWaited = false;
+	while (!lastUpload)
+	{
+		const size_t uploadIndex = acquireUpload();
+		if (uploadIndex >= uploads.size())
+		{
+			return;
+		}
+		Upload& upload = uploads[uploadIndex];
+		// The runs already in the ring go out with the first upload.  The
+		//	ones held on the host get copied into the ring as far as it can
+		//	fit them.  If it's full of uploads that were submitted already 
+		//	we have to wait for the oldest one, otherwise whatever didn't 
+		//	fit goes out with the next upload //
+		bufferCopyRegions.clear();
+		while (sr < stagedRuns.size())
+		{
+			StagedRun const& run = stagedRuns[sr];
+			if (run.inRing)
+			{
+				const VkBufferCopy copyRegion = {
+					run.ringOffset,// src offset
+					run.quadDataOffset,// dst offset
+					run.size
+				};
+				bufferCopyRegions.push_back(copyRegion);
+				sr++;
+				continue;
+			}
+			const VkDeviceSize copySize = 
+				std::min(run.size - runCopiedSize, stagingRingSize / 2);
+			VkDeviceSize stagingOffset;
+			if (!allocateStagingRing(copySize, stagingOffset))
+			{
+				if (stagingRingHead > submittedRingEnd)
+				{
+					break;
+				}
+				reclaimStagingRing(true);
+				continue;
+			}
+			memcpy(stagingRing.getWriteWindow<Uint8>(stagingOffset, 
+				static_cast<size_t>(copySize)),
+				   run.data + runCopiedSize, static_cast<size_t>(copySize));
+			const VkBufferCopy copyRegion = {
+				stagingOffset,// src offset
+				run.quadDataOffset + runCopiedSize,// dst offset
+				copySize
+			};
+			bufferCopyRegions.push_back(copyRegion);
+			runCopiedSize += copySize;
+			if (runCopiedSize == run.size)
+			{
+				sr++;
+				runCopiedSize = 0;
+			}
+		}
+		lastUpload = sr == stagedRuns.size();
+		stagingRing.flushMappedRanges();
+		vkBeginCommandBuffer(upload.commandBuffer, &commandBufferBeginInfo);
+		vkCmdPipelineBarrier(upload.commandBuffer,
+							 transferBarrierSrcStages,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 0,// dependency flags
+							 1, &transferBarrier,
+							 0, nullptr,
+							 0, nullptr);
+		recordQuadDataCopies(upload.commandBuffer, &stagingRing, 
+							 bufferCopyRegions);
+		// Compaction moves have to read the data of the quads they move,
+		//	which might have only just been copied into their old slots //
+		if (lastUpload && compact)
+		{
+			compactQuads();
+		}
+		const bool movesQuads = 
+			lastUpload && compact && !compactionCopyRegions.empty();
+		if (movesQuads)
+		{
+			const VkMemoryBarrier compactionBarrier = {
+				VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				nullptr,// pNext
+				VK_ACCESS_TRANSFER_WRITE_BIT,// src access mask
+				VK_ACCESS_TRANSFER_READ_BIT |
+					VK_ACCESS_TRANSFER_WRITE_BIT // dst access mask
+			};
+			vkCmdPipelineBarrier(upload.commandBuffer,
+								 VK_PIPELINE_STAGE_TRANSFER_BIT,
+								 VK_PIPELINE_STAGE_TRANSFER_BIT,
+								 0,// dependency flags
+								 1, &compactionBarrier,
+								 0, nullptr,
+								 0, nullptr);
+			recordQuadDataCopies(upload.commandBuffer, nullptr, 
+								 compactionCopyRegions);
+		}
+		// the draw counts depend on where compaction left the end of the 
+		//	draw range //
+		const bool updatesDrawArgs = 
+			lastUpload && updateDrawArgs(upload.commandBuffer);
+		vkEndCommandBuffer(upload.commandBuffer);
+		// The staging copies & compaction moves overwrite quad data that 
+		//	frames still in flight might be drawing: moves land in holes 
+		//	that were only just removed.  The draw command updates 
+		//	overwrite what those frames' indirect draws & culling read.
+		//	Only the first upload carrying any of them has to wait for the
+		//	frames, since the uploads after it are ordered after its 
+		//	wait. //
+		const VkPipelineStageFlags framesDoneWaitStage = 
+			VK_PIPELINE_STAGE_TRANSFER_BIT;
+		const bool writesFrameData = 
+			!bufferCopyRegions.empty() || movesQuads || updatesDrawArgs;
+		const bool waitForFrames = !framesWaited && writesFrameData && 
+			qGraphics != qMemoryTransfer &&
+			signalFramesDone(qGraphics, upload.framesDoneSemaphore);
+		framesWaited = framesWaited || writesFrameData;
+		const VkSubmitInfo submitInfo = {
+			VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			nullptr,// pNext
+			waitForFrames ? 1u : 0u,// wait semaphore count
+			&upload.framesDoneSemaphore,
+			&framesDoneWaitStage,
+			1,// command buffer count
+			&upload.commandBuffer,
+			1,// signal semaphore count
+			&upload.semaphore // signal semaphores
+		};
+		vkResetFences(device, 1, &upload.fence);
+		if (vkQueueSubmit(qMemoryTransfer, 1, &submitInfo, 
+						  upload.fence) != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to submit quad pool upload!\n");
+			SDL_assert(false);
+			return;
+		}
+		// Any page that gets dirty again before this upload finishes just 
+		//	gets copied again by the next flush, which will be ordered after
+		//	this one by the barrier above.
+		upload.inFlight = true;
+		upload.consumerFence = VK_NULL_HANDLE;
+		upload.stagingRingEnd = stagingRingHead;
+		submittedRingEnd = stagingRingHead;
+		stagingRingUploads.push_back(uploadIndex);
+	}
+	stagedRuns.clear();
+	stagingOverflowBlocks.clear();
+#ifndef NDEBUG
+	SDL_LogDebug(SDL_LOG_CATEGORY_VIDEO,
+		"QuadPool flush: dirty pages=%i dirty runs=%i bytes=%llu\n",
+		static_cast<int>(lastFlushStats.dirtyPageCount),
+		static_cast<int>(lastFlushStats.dirtyRunCount),
+		static_cast<unsigned long long>(lastFlushStats.copiedByteCount));
+#endif
+	releaseEmptyChunks();
+}
+bool k10::QuadPool::signalFramesDone(VkQueue qGraphics, 
+									VkSemaphore semaphore)
+{
+	bool framesPending = false;
+	for (VkFence frameFence : frameFences)
+	{
+		if (vkGetFenceStatus(device, frameFence) != VK_SUCCESS)
+		{
+			framesPending = true;
+			break;
+		}
+	}
+	if (!framesPending)
+	{
+		return false;
+	}
+	// a semaphore signal covers every command submitted to the queue 
+	//	before it, so it doesn't need any command buffers of its own //
+	const VkSubmitInfo submitInfo = {
+		VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		nullptr,// pNext
+		0,// wait semaphore count
+		nullptr,// wait semaphores
+		nullptr,// wait dst stage mask
+		0,// command buffer count
+		nullptr,// command buffers
+		1,// signal semaphore count
+		&semaphore // signal semaphores
+	};
+	if (vkQueueSubmit(qGraphics, 1, &submitInfo, 
+					  VK_NULL_HANDLE) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to submit quad pool frames done signal!\n");
+		SDL_assert(false);
+		return false;
+	}
+	return true;
+}
+void k10::QuadPool::consumeUploadSemaphores(
+	VkFence frameFence,
+	vector<VkSemaphore>& waitSemaphores,
+	vector<VkPipelineStageFlags>& waitStages)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	if (std::find(frameFences.begin(), frameFences.end(), 
+				  frameFence) == frameFences.end())
+	{
+		frameFences.push_back(frameFence);
+	}
+	// The submission draws the quads the draw commands cover, so writes 
+	//	in place to those have to wait for it.  The fence has already been
+	//	waited on, so whatever it was guarding before is done. //
+	if (writeQuadDataInPlace)
+	{
+		std::lock_guard<std::mutex> lock(inPlaceReaderMutex);
+		size_t r = 0;
+		while (r < inPlaceReaders.size() && 
+			   inPlaceReaders[r].fence != frameFence)
+		{
+			r++;
+		}
+		if (r == inPlaceReaders.size())
+		{
+			inPlaceReaders.push_back({frameFence, {}});
+		}
+		vector<QuadId>& chunkDrawQuadCounts = 
+			inPlaceReaders[r].chunkDrawQuadCounts;
+		chunkDrawQuadCounts.resize(chunks.size());
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			chunkDrawQuadCounts[c] = chunks[c].created ? 
+				chunks[c].drawArgsQuadCount : 0;
+		}
+		inPlaceReadersPending = true;
+	}
+	for (Upload& u : uploads)
+	{
+		if (u.inFlight && u.consumerFence == VK_NULL_HANDLE)
+		{
+			// the culling pre-pass reads the quad data before any vertices
+			//	get pulled out of it //
+			waitSemaphores.push_back(u.semaphore);
+			waitStages.push_back(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+				(cullPipeline != VK_NULL_HANDLE ? 
+					VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : 0));
+			u.consumerFence = frameFence;
+		}
+	}
+}
+void k10::QuadPool::forgetFrameFences()
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	for (RetiredChunk& retiredChunk : retiredChunks)
+	{
+		destroyChunk(retiredChunk.chunk);
+	}
+	retiredChunks.clear();
+	// Uploads that were already waited on keep their own fence as the 
+	//	consumer fence, which is signaled by now, so they still get recycled
+	//	the usual way.  The rest still have to be waited on by the next 
+	//	frame. //
+	for (Upload& u : uploads)
+	{
+		if (u.consumerFence != VK_NULL_HANDLE)
+		{
+			u.consumerFence = u.fence;
+		}
+	}
+	frameFences.clear();
+	{
+		std::lock_guard<std::mutex> lock(inPlaceReaderMutex);
+		inPlaceReaders.clear();
+		inPlaceReadersPending = false;
+	}
+	streamingFrameFence = VK_NULL_HANDLE;
+}
+k10::QuadPool::FlushStats k10::QuadPool::getLastFlushStats() const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+	return lastFlushStats;
+}
+VkDeviceSize k10::QuadPool::getGfxMemorySize() const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+	VkDeviceSize retVal = quadIndexBuffer.getMemorySize() + 
+		stagingRing.getMemorySize() + drawArgsBuffer.getMemorySize() +
+		streamingBuffer.getMemorySize();
+	for (Chunk const& chunk : chunks)
+	{
+		retVal += chunk.dataBuffer.getMemorySize() + 
+			chunk.cullBuffer.getMemorySize();
+	}
+	for (RetiredChunk const& retiredChunk : retiredChunks)
+	{
+		retVal += retiredChunk.chunk.dataBuffer.getMemorySize() + 
+			retiredChunk.chunk.cullBuffer.getMemorySize();
+	}
+	return retVal;
+}
+k10::QuadPool::DrawMode k10::QuadPool::getDrawMode() const
+{
+	return drawMode;
+}
+k10::QuadPool::VertexFormat k10::QuadPool::getVertexFormat() const
+{
+	return vertexFormat;
+}
+vector<VkVertexInputBindingDescription> const& 
+	k10::QuadPool::getVertexBindingDescriptions() const
+{
+	return vertexBindingDescriptions;
+}
+vector<VkVertexInputAttributeDescription> const& 
+	k10::QuadPool::getVertexAttributeDescriptions() const
+{
+	return vertexAttributeDescriptions;
+}
+bool k10::QuadPool::flushRequired() const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+	return dirtyPageCount > 0 || producerChangesPending || 
+		drawArgsOutdated() || compactionRequired();
+}
+void k10::QuadPool::issueUpdateCommands(VkCommandBuffer cb)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	const size_t endChunk = std::min(drawArgsUpdateEnd, drawArgs.size());
+	const size_t firstChunk = drawArgsUpdateBegin;
+	drawArgsUpdateBegin = 0;
+	drawArgsUpdateEnd = 0;
+	if (firstChunk >= endChunk)
+	{
+		return;
+	}
+	// Earlier submissions might still be reading the commands, so let them
+	//	finish first.  Only reads happened, so there is nothing to make 
+	//	visible. //
+	vkCmdPipelineBarrier(cb,
+						 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+							VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 0,// dependency flags
+						 0, nullptr,
+						 0, nullptr,
+						 0, nullptr);
+	recordDrawArgsUpdates(cb, firstChunk, endChunk);
+	const VkMemoryBarrier updateBarrier = {
+		VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		nullptr,// pNext
+		VK_ACCESS_TRANSFER_WRITE_BIT,// src access mask
+		VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+			VK_ACCESS_SHADER_READ_BIT // dst access mask
+	};
+	vkCmdPipelineBarrier(cb,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+							VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 0,// dependency flags
+						 1, &updateBarrier,
+						 0, nullptr,
+						 0, nullptr);
+}
+void k10::QuadPool::issueCullCommands(VkCommandBuffer cb)
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+	if (!gpuCulling)
+	{
+		return;
+	}
+	// Earlier submissions might still be drawing out of the cull buffers, 
+	//	so let them finish before the pre-pass overwrites them.  Only reads
+	//	happened, so there is nothing to make visible. //
+	vkCmdPipelineBarrier(cb,
+						 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+							VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+						 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 0,// dependency flags
+						 0, nullptr,
+						 0, nullptr,
+						 0, nullptr);
+	vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+	// Each pass reads what the one before it wrote for every chunk, so the
+	//	chunks are batched up per pass & only 2 barriers are needed. //
+	const VkMemoryBarrier passBarrier = {
+		VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		nullptr,// pNext
+		VK_ACCESS_SHADER_WRITE_BIT,// src access mask
+		VK_ACCESS_SHADER_READ_BIT |
+			VK_ACCESS_SHADER_WRITE_BIT // dst access mask
+	};
+	for (uint32_t pass = 0; pass < 3; pass++)
+	{
+		if (pass > 0)
+		{
+			vkCmdPipelineBarrier(cb,
+								 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+								 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+								 0,// dependency flags
+								 1, &passBarrier,
+								 0, nullptr,
+								 0, nullptr);
+		}
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			if (!chunks[c].created)
+			{
+				continue;
+			}
+			const CullParams cullParams = {
+				static_cast<uint32_t>(c),// chunk index
+				static_cast<uint32_t>(drawMode),
+				static_cast<uint32_t>(vertexFormat),
+				storedVerticesPerQuad,
+				static_cast<uint32_t>(chunkQuadCount),
+				pass
+			};
+			vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE,
+									cullPipelineLayout, 
+									0,// first set
+									1, &chunks[c].cullDescriptorSet,
+									0, nullptr);
+			vkCmdPushConstants(cb, cullPipelineLayout, 
+							   VK_SHADER_STAGE_COMPUTE_BIT, 0, 
+							   sizeof(CullParams), &cullParams);
+			// The # of quads isn't known until the pre-pass reads it, so 
+			//	passes 0 & 2 cover the whole chunk.  Pass 1 scans the 
+			//	workgroup counts with a single workgroup. //
+			vkCmdDispatch(cb, 
+				pass == 1 ? 1 : 
+					static_cast<uint32_t>((chunkQuadCount + 
+						CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE), 
+				1, 1);
+		}
+	}
+	const VkMemoryBarrier cullBarrier = {
+		VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		nullptr,// pNext
+		VK_ACCESS_SHADER_WRITE_BIT,// src access mask
+		VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+			VK_ACCESS_INDEX_READ_BIT |
+			VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT // dst access mask
+	};
+	vkCmdPipelineBarrier(cb,
+						 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+							VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+						 0,// dependency flags
+						 1, &cullBarrier,
+						 0, nullptr,
+						 0, nullptr);
+}
+void k10::QuadPool::issueCommands(VkCommandBuffer cb)
+{
+	issueChunkCommands(cb, 0, numeric_limits<size_t>::max());
+}
+size_t k10::QuadPool::getChunkSlotCount() const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+	return chunks.size();
+}
+void k10::QuadPool::issueChunkCommands(VkCommandBuffer cb, 
+									   size_t firstChunk, 
+									   size_t chunkCount) const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+	if (firstChunk >= chunks.size())
+	{
+		return;
+	}
+	const size_t endChunk = 
+		std::min(chunks.size() - firstChunk, chunkCount) + firstChunk;
+	if (drawMode == DrawMode::INDEXED && !gpuCulling)
+	{
+		vkCmdBindIndexBuffer(cb, quadIndexBuffer.getBuffer(), 0, 
+							 VK_INDEX_TYPE_UINT32);
+	}
+	vector<VkBuffer> vertexBuffers(quadDataStreams.size());
+	vector<VkDeviceSize> vbOffsets(quadDataStreams.size());
+	for (size_t c = firstChunk; c < endChunk; c++)
+	{
+		Chunk const& chunk = chunks[c];
+		if (!chunk.created)
+		{
+			continue;
+		}
+		// every stream lives in the chunk's data buffer, bound to the 
+		//	vertex binding matching its index.  Culled INSTANCED pools draw
+		//	the visible instances out of the cull buffer instead. //
+		for (size_t s = 0; s < quadDataStreams.size(); s++)
+		{
+			vertexBuffers[s] = chunk.dataBuffer.getBuffer();
+			vbOffsets[s] = quadDataStreams[s].bufferOffset;
+		}
+		if (gpuCulling && drawMode == DrawMode::INSTANCED)
+		{
+			vertexBuffers[QUAD_DATA_STREAM_INSTANCE] = 
+				chunk.cullBuffer.getBuffer();
+			vbOffsets[QUAD_DATA_STREAM_INSTANCE] = CULL_OUTPUT_OFFSET;
+		}
+		vkCmdBindVertexBuffers(cb, 0, 
+							   static_cast<uint32_t>(vertexBuffers.size()),
+							   vertexBuffers.data(), vbOffsets.data());
+		if (gpuCulling)
+		{
+			// the pre-pass turns VERTEX_LIST pools into indexed draws too,
+			//	since the visible quads are never next to each other //
+			if (drawMode == DrawMode::INSTANCED)
+			{
+				vkCmdDrawIndirect(cb, chunk.cullBuffer.getBuffer(), 0, 1, 
+								  sizeof(VkDrawIndirectCommand));
+			}
+			else
+			{
+				vkCmdBindIndexBuffer(cb, chunk.cullBuffer.getBuffer(), 
+									 CULL_OUTPUT_OFFSET, VK_INDEX_TYPE_UINT32);
+				vkCmdDrawIndexedIndirect(cb, chunk.cullBuffer.getBuffer(), 
+										 0, 1, 
+										 sizeof(VkDrawIndexedIndirectCommand));
+			}
+			continue;
+		}
+		// the # of quads drawn comes from the chunk's draw command, which 
+		//	flushes keep up to date //
+		const VkDeviceSize drawArgsOffset = 
+			c*sizeof(VkDrawIndexedIndirectCommand);
+		if (drawMode == DrawMode::INDEXED)
+		{
+			vkCmdDrawIndexedIndirect(cb, drawArgsBuffer.getBuffer(), 
+									 drawArgsOffset, 1, 
+									 sizeof(VkDrawIndexedIndirectCommand));
+		}
+		else
+		{
+			vkCmdDrawIndirect(cb, drawArgsBuffer.getBuffer(), drawArgsOffset,
+							  1, sizeof(VkDrawIndexedIndirectCommand));
+		}
+	}
+}
+bool k10::QuadPool::createStreamingFrames(uint32_t frameCount, 
+										 size_t quadsPerFrame)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(streamingFrameCount == 0);
+	SDL_assert(frameCount > 0 && quadsPerFrame > 0);
+	streamingChunkCount = 
+		(std::min(quadsPerFrame, MAX_QUAD_COUNT) + chunkQuadCount - 1) / 
+			chunkQuadCount;
+	// every chunk has to start on a non-coherent atom so it can be flushed 
+	//	on its own, and vertex attributes are never bigger than a vec4 //
+	const VkDeviceSize alignment = std::max(
+		allocator->getNonCoherentAtomSize(), VkDeviceSize(sizeof(glm::vec4)));
+	streamingChunksOffset = alignUp(
+		streamingChunkCount*sizeof(VkDrawIndexedIndirectCommand), alignment);
+	streamingChunkStride = alignUp(chunkDataSize, alignment);
+	streamingFrameSize = 
+		streamingChunksOffset + streamingChunkCount*streamingChunkStride;
+	// the device reads the quads straight out of host visible memory, which
+	//	ends up in device local memory whenever the host can see it //
+	if (!streamingBuffer.createBuffer(*allocator, 
+									  frameCount*streamingFrameSize,
+									  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+										VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+									  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+									  true))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool streaming buffer!\n");
+		SDL_assert(false);
+		return false;
+	}
+	streamingFrameCount = frameCount;
+	// nothing has been drawn out of any region yet, so every region starts
+	//	out drawing nothing //
+	for (uint32_t f = 0; f < streamingFrameCount; f++)
+	{
+		memset(streamingBuffer.getMappedWindow<Uint8>(
+				f*streamingFrameSize, streamingChunksOffset), 
+			0, static_cast<size_t>(streamingChunksOffset));
+		streamingBuffer.flushMappedRange(f*streamingFrameSize, 
+										 streamingChunksOffset);
+	}
+	streamingFrame = 0;
+	streamingQuadCount = 0;
+	streamingFrameFence = VK_NULL_HANDLE;
+	SDL_Log("Quad pool streaming: %i frames of %i quads, %llu bytes in "
+			"memory heap %i\n",
+		static_cast<int>(streamingFrameCount),
+		static_cast<int>(streamingChunkCount*chunkQuadCount),
+		static_cast<unsigned long long>(frameCount*streamingFrameSize),
+		static_cast<int>(streamingBuffer.getMemoryHeapIndex()));
+	return true;
+}
+void k10::QuadPool::beginStreamingFrame(uint32_t frameIndex, 
+										VkFence frameFence)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	if (streamingFrameCount == 0)
+	{
+		return;
+	}
+	SDL_assert(frameIndex < streamingFrameCount);
+	streamingFrame = frameIndex;
+	streamingQuadCount = 0;
+	streamingFrameFence = frameFence;
+}
+bool k10::QuadPool::addStreamingQuads(size_t quadCount, 
+									  QuadFiller const& fillQuad)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(drawMode != DrawMode::INSTANCED);
+	Vertex quadVertices[VERTICES_PER_QUAD];
+	return allocateStreamingRuns(quadCount,
+		[&](size_t firstQuadIndex, StagingWindow const& window)->void
+		{
+			for (QuadId q = 0; q < window.quadCount; q++)
+			{
+				fillQuad(firstQuadIndex + q, quadVertices);
+				storeQuadVertices(window, window.firstSlot + q, quadVertices);
+			}
+		});
+}
+bool k10::QuadPool::addStreamingQuadInstances(
+	size_t quadCount, QuadInstanceFiller const& fillQuad)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	SDL_assert(drawMode == DrawMode::INSTANCED);
+	return allocateStreamingRuns(quadCount,
+		[&](size_t firstQuadIndex, StagingWindow const& window)->void
+		{
+			for (QuadId q = 0; q < window.quadCount; q++)
+			{
+				fillQuad(firstQuadIndex + q, 
+					*reinterpret_cast<QuadInstance*>(getStagedQuadData(
+						window, QUAD_DATA_STREAM_INSTANCE, 
+						window.firstSlot + q)));
+			}
+		});
+}
+size_t k10::QuadPool::getStreamingQuadCount() const
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+	return streamingQuadCount;
+}
+void k10::QuadPool::endStreamingFrame()
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mutex);
+	if (streamingFrameCount == 0)
+	{
+		return;
+	}
+	waitForStreamingFrame();
+	VkDrawIndexedIndirectCommand*const drawCommands = 
+		streamingBuffer.getMappedWindow<VkDrawIndexedIndirectCommand>(
+			streamingFrame*streamingFrameSize, streamingChunkCount);
+	for (size_t c = 0; c < streamingChunkCount; c++)
+	{
+		const QuadId chunkQuads = static_cast<QuadId>(
+			std::min(streamingQuadCount - 
+						std::min(streamingQuadCount, c*chunkQuadCount), 
+					 static_cast<size_t>(chunkQuadCount)));
+		drawCommands[c] = getDrawArgs(chunkQuads);
+		if (chunkQuads > 0)
+		{
+			streamingBuffer.flushMappedRange(
+				getStreamingChunkOffset(streamingFrame, c), chunkDataSize);
+		}
+	}
+	streamingBuffer.flushMappedRange(streamingFrame*streamingFrameSize, 
+		streamingChunkCount*sizeof(VkDrawIndexedIndirectCommand));
+}
+void k10::QuadPool::issueStreamingCommands(VkCommandBuffer cb, 
+										   uint32_t frameIndex)
+{
+	std::shared_lock<std::shared_timed_mutex> lock(mutex);
+	if (streamingFrameCount == 0)
+	{
+		return;
+	}
+	SDL_assert(frameIndex < streamingFrameCount);
+	if (drawMode == DrawMode::INDEXED)
+	{
+		vkCmdBindIndexBuffer(cb, quadIndexBuffer.getBuffer(), 0, 
+							 VK_INDEX_TYPE_UINT32);
+	}
+	vector<VkBuffer> vertexBuffers(quadDataStreams.size(), 
+								   streamingBuffer.getBuffer());
+	vector<VkDeviceSize> vbOffsets(quadDataStreams.size());
+	for (size_t c = 0; c < streamingChunkCount; c++)
+	{
+		for (size_t s = 0; s < quadDataStreams.size(); s++)
+		{
+			vbOffsets[s] = getStreamingChunkOffset(frameIndex, c) + 
+				quadDataStreams[s].bufferOffset;
+		}
+		vkCmdBindVertexBuffers(cb, 0, 
+							   static_cast<uint32_t>(vertexBuffers.size()),
+							   vertexBuffers.data(), vbOffsets.data());
+		const VkDeviceSize drawCommandOffset = frameIndex*streamingFrameSize +
+			c*sizeof(VkDrawIndexedIndirectCommand);
+		if (drawMode == DrawMode::INDEXED)
+		{
+			vkCmdDrawIndexedIndirect(cb, streamingBuffer.getBuffer(), 
+									 drawCommandOffset, 1, 
+									 sizeof(VkDrawIndexedIndirectCommand));
+		}
+		else
+		{
+			vkCmdDrawIndirect(cb, streamingBuffer.getBuffer(), 
+							  drawCommandOffset, 1, 
+							  sizeof(VkDrawIndexedIndirectCommand));
+		}
+	}
+}
+VkDeviceSize k10::QuadPool::getStreamingChunkOffset(uint32_t frameIndex, 
+													size_t chunkIndex) const
+{
+	return frameIndex*streamingFrameSize + streamingChunksOffset + 
+		chunkIndex*streamingChunkStride;
+}
+void k10::QuadPool::waitForStreamingFrame()
+{
+	if (streamingFrameFence != VK_NULL_HANDLE)
+	{
+		vkWaitForFences(device, 1, &streamingFrameFence, VK_TRUE, 
+						UINT64_MAX);
+		streamingFrameFence = VK_NULL_HANDLE;
+	}
+}
+bool k10::QuadPool::allocateStreamingRuns(size_t quadCount, 
+										  QuadRunWriter const& writeRun)
+{
+	if (quadCount > 
+		streamingChunkCount*chunkQuadCount - streamingQuadCount)
+	{
+		SDL_Log("Aborting attempt to stream %i quads into a frame with only"
+				" %i free slots.\n", static_cast<int>(quadCount), 
+				static_cast<int>(streamingChunkCount*chunkQuadCount - 
+								 streamingQuadCount));
+		SDL_assert(false);
+		return false;
+	}
+	if (quadCount == 0)
+	{
+		return true;
+	}
+	waitForStreamingFrame();
+	size_t quadIndex = 0;
+	while (quadIndex < quadCount)
+	{
+		const size_t c = streamingQuadCount / chunkQuadCount;
+		const QuadSlot runFirstSlot = 
+			static_cast<QuadSlot>(streamingQuadCount % chunkQuadCount);
+		const QuadId runQuadCount = static_cast<QuadId>(std::min(
+			quadCount - quadIndex, 
+			static_cast<size_t>(chunkQuadCount - runFirstSlot)));
+		// the run is addressed by its slot within the chunk, so the store
+		//	functions work the same as they do on a pool chunk //
+		StagingWindow window = {};
+		window.firstSlot = runFirstSlot;
+		window.quadCount = runQuadCount;
+		for (size_t s = 0; s < quadDataStreams.size(); s++)
+		{
+			QuadDataStream const& stream = quadDataStreams[s];
+			window.streamData[s] = streamingBuffer.getMappedWindow<Uint8>(
+				getStreamingChunkOffset(streamingFrame, c) + 
+					stream.bufferOffset + runFirstSlot*stream.quadDataSize,
+				static_cast<size_t>(runQuadCount*stream.quadDataSize));
+		}
+		writeRun(quadIndex, window);
+		quadIndex += runQuadCount;
+		streamingQuadCount += runQuadCount;
+	}
+	return true;
+}
+Uint8 k10::QuadPool::storedVertexCorner(Uint8 storedVertex) const
+{
+	// VERTEX_LIST pools expand the corners out into the vertices of both 
+	//	triangles //
+	return drawMode == DrawMode::VERTEX_LIST ?
+		static_cast<Uint8>(QUAD_CORNER_INDICES[storedVertex]) : storedVertex;
+}
+void k10::QuadPool::storeQuadPositions(StagingWindow const& window, 
+									   QuadSlot slot, 
+									   glm::vec2 const* cornerPositions) const
+{
+	SDL_assert(drawMode != DrawMode::INSTANCED);
+	Uint8*const data = getStagedQuadData(window, QUAD_DATA_STREAM_POSITION, slot);
+	switch (vertexFormat)
+	{
+	case VertexFormat::FULL:
+	{
+		glm::vec2*const positions = reinterpret_cast<glm::vec2*>(data);
+		for (Uint8 v = 0; v < storedVerticesPerQuad; v++)
+		{
+			positions[v] = cornerPositions[storedVertexCorner(v)];
+		}
+	} break;
+	case VertexFormat::PACKED:
+	{
+		Sint16*const positions = reinterpret_cast<Sint16*>(data);
+		for (Uint8 v = 0; v < storedVerticesPerQuad; v++)
+		{
+			glm::vec2 const& p = cornerPositions[storedVertexCorner(v)];
+			positions[2*v    ] = packSnorm16(p.x);
+			positions[2*v + 1] = packSnorm16(p.y);
+		}
+	} break;
+	}
+}
+void k10::QuadPool::storeQuadColors(StagingWindow const& window, 
+									QuadSlot slot, 
+									glm::vec4 const* cornerColors) const
+{
+	SDL_assert(drawMode != DrawMode::INSTANCED);
+	Uint8*const data = getStagedQuadData(window, QUAD_DATA_STREAM_COLOR, slot);
+	switch (vertexFormat)
+	{
+	case VertexFormat::FULL:
+	{
+		glm::vec4*const colors = reinterpret_cast<glm::vec4*>(data);
+		for (Uint8 v = 0; v < storedVerticesPerQuad; v++)
+		{
+			colors[v] = cornerColors[storedVertexCorner(v)];
+		}
+	} break;
+	case VertexFormat::PACKED:
+	{
+		Uint32*const colors = reinterpret_cast<Uint32*>(data);
+		for (Uint8 v = 0; v < storedVerticesPerQuad; v++)
+		{
+			colors[v] = packUnorm8Color(cornerColors[storedVertexCorner(v)]);
+		}
+	} break;
+	}
+}
+void k10::QuadPool::storeQuadVertices(StagingWindow const& window, 
+									  QuadSlot slot, 
+									  Vertex const* quadVertices) const
+{
+	glm::vec2 cornerPositions[VERTICES_PER_QUAD];
+	glm::vec4 cornerColors[VERTICES_PER_QUAD];
+	for (Uint8 c = 0; c < VERTICES_PER_QUAD; c++)
+	{
+		cornerPositions[c] = quadVertices[c].position;
+		cornerColors[c] = quadVertices[c].color;
+	}
+	storeQuadPositions(window, slot, cornerPositions);
+	storeQuadColors(window, slot, cornerColors);
+}
+void k10::QuadPool::storeQuadInstance(StagingWindow const& window, 
+									  QuadSlot slot, 
+									  QuadInstance const& instance) const
+{
+	SDL_assert(drawMode == DrawMode::INSTANCED);
+	*reinterpret_cast<QuadInstance*>(getStagedQuadData(window, 
+		QUAD_DATA_STREAM_INSTANCE, slot)) = instance;
+}
+Uint8 k10::QuadPool::getDegenerateQuadDataBits() const
+{
+	// collapsing the positions is enough to stop the quad from being 
+	//	rasterized, so the colors can be left alone //
+	return drawMode == DrawMode::INSTANCED ? 
+		STAGING_QUAD_DATA_BIT_ALL : STAGING_QUAD_DATA_BIT_POSITION;
+}
+void k10::QuadPool::storeDegenerateQuad(StagingWindow const& window, 
+										QuadSlot slot) const
+{
+	if (drawMode == DrawMode::INSTANCED)
+	{
+		storeQuadInstance(window, slot, DEGENERATE_QUAD_INSTANCE);
+	}
+	else
+	{
+		storeQuadPositions(window, slot, DEGENERATE_QUAD_POSITIONS);
+	}
+}
+k10::QuadPool::StagingWindow k10::QuadPool::getStagingWindow(
+	QuadSlot firstSlot, QuadId quadCount, Uint8 dataBits, 
+	StagingArena& arena)
+{
+	SDL_assert(firstSlot / chunkQuadCount == 
+			   (firstSlot + quadCount - 1) / chunkQuadCount);
+	StagingWindow window = {};
+	window.firstSlot = firstSlot;
+	window.quadCount = quadCount;
+	for (size_t s = 0; s < quadDataStreams.size(); s++)
+	{
+		QuadDataStream const& stream = quadDataStreams[s];
+		if (!(stream.dataBits & dataBits))
+		{
+			continue;
+		}
+		const VkDeviceSize offset = getQuadDataOffset(stream, firstSlot);
+		const VkDeviceSize size = quadCount*stream.quadDataSize;
+		window.streamData[s] = writeQuadDataInPlace ? 
+			getQuadDataWindow(offset, size) :
+			allocateStagedRun(arena, offset, size);
+	}
+	return window;
+}
+k10::QuadPool::StagingWindow k10::QuadPool::stageQuadData(
+	QuadSlot firstSlot, QuadId quadCount, Uint8 dataBits)
+{
+	for (QuadDataStream const& stream : quadDataStreams)
+	{
+		if (stream.dataBits & dataBits)
+		{
+			markQuadDataDirty(getQuadDataOffset(stream, firstSlot), 
+							  quadCount*stream.quadDataSize);
+		}
+	}
+	return getStagingWindow(firstSlot, quadCount, dataBits, stagingArena);
+}
+Uint8* k10::QuadPool::getStagedQuadData(StagingWindow const& window, 
+										Uint8 streamIndex, 
+										QuadSlot slot) const
+{
+	SDL_assert(window.streamData[streamIndex]);
+	SDL_assert(slot >= window.firstSlot && 
+			   slot - window.firstSlot < window.quadCount);
+	return window.streamData[streamIndex] + 
+		(slot - window.firstSlot)*quadDataStreams[streamIndex].quadDataSize;
+}
+bool k10::QuadPool::allocateStagingRing(VkDeviceSize size, 
+									  VkDeviceSize& outOffset)
+{
+	SDL_assert(size <= stagingRingSize / 2);
+	// allocations never wrap around the end of the ring, so if one doesn't
+	//	fit in what is left of it we skip to the start //
+	auto paddingNeeded = [&]()->VkDeviceSize
+	{
+		const VkDeviceSize headOffset = stagingRingHead % stagingRingSize;
+		return headOffset + size > stagingRingSize ? 
+			stagingRingSize - headOffset : 0;
+	};
+	auto fits = [&]()->bool
+	{
+		return stagingRingHead - stagingRingTail + paddingNeeded() + size <= 
+			stagingRingSize;
+	};
+	if (!fits())
+	{
+		reclaimStagingRing(false);
+		if (!fits())
+		{
+			return false;
+		}
+	}
+	stagingRingHead += paddingNeeded();
+	outOffset = stagingRingHead % stagingRingSize;
+	stagingRingHead += size;
+	return true;
+}
+void k10::QuadPool::reclaimStagingRing(bool waitForOldestUpload)
+{
+	// uploads finish in the order they were submitted, since each one
+	//	waits for the copies of the last one //
+	while (!stagingRingUploads.empty())
+	{
+		Upload const& upload = uploads[stagingRingUploads.front()];
+		if (waitForOldestUpload)
+		{
+			vkWaitForFences(device, 1, &upload.fence, VK_TRUE, 
+							numeric_limits<uint64_t>::max());
+			waitForOldestUpload = false;
+		}
+		else if (vkGetFenceStatus(device, upload.fence) != VK_SUCCESS)
+		{
+			break;
+		}
+		stagingRingTail = upload.stagingRingEnd;
+		stagingRingUploads.erase(stagingRingUploads.begin());
+	}
+}
+bool k10::QuadPool::compactionRequired() const
+{
+	return compactionMoveBudget > 0 && 
+		quadSlots.getAllocatedCount() < largestQuadCount;
+}
+void k10::QuadPool::compactQuads()
+{
+	compactionCopyRegions.clear();
+	// Always moving the last quad of the draw range into the lowest hole
+	//	means a quad is never moved twice in one go, so none of the copy 
+	//	regions overlap: every hole filled so far is below the next hole,
+	//	which is below the next quad to move. //
+	QuadId movedQuadCount = 0;
+	while (movedQuadCount < compactionMoveBudget && compactionRequired())
+	{
+		const QuadSlot srcSlot = largestQuadCount - 1;
+		SDL_assert(quadSlots.isAllocated(srcSlot));
+		// the lowest hole can be in a chunk that was released while 
+		//	compaction was disabled //
+		if (!reserveSlots(1))
+		{
+			break;
+		}
+		const QuadSlot dstSlot = allocateSlot();
+		SDL_assert(dstSlot < srcSlot);
+		for (QuadDataStream const& stream : quadDataStreams)
+		{
+			const VkDeviceSize srcOffset = getQuadDataOffset(stream, srcSlot);
+			const VkDeviceSize dstOffset = getQuadDataOffset(stream, dstSlot);
+			// Every byte of the chunks was written by the host, so there 
+			//	is nothing to invalidate before reading it when they are 
+			//	written in place. //
+			if (writeQuadDataInPlace)
+			{
+				Uint8 const*const src = 
+					getQuadDataWindow(srcOffset, stream.quadDataSize);
+				memcpy(getQuadDataWindow(dstOffset, stream.quadDataSize),
+					   src, static_cast<size_t>(stream.quadDataSize));
+				markQuadDataDirty(dstOffset, stream.quadDataSize);
+			}
+			else
+			{
+				const VkBufferCopy copyRegion = {
+					srcOffset,
+					dstOffset,
+					stream.quadDataSize
+				};
+				compactionCopyRegions.push_back(copyRegion);
+			}
+		}
+		const QuadId qid = slotQuadIds[srcSlot];
+		quadIdSlots[qid] = dstSlot;
+		slotQuadIds[dstSlot] = qid;
+		slotQuadIds[srcSlot] = SlotAllocator::INVALID_SLOT;
+		releaseSlot(srcSlot);
+		// the slot we just emptied is outside of the draw range now, so it
+		//	never needs to be made degenerate //
+		const QuadSlot lastSlot = quadSlots.findLastAllocated(srcSlot);
+		largestQuadCount = lastSlot == SlotAllocator::INVALID_SLOT ? 
+			0 : lastSlot + 1;
+		movedQuadCount++;
+	}
+	lastFlushStats.movedQuadCount = movedQuadCount;
+#ifndef NDEBUG
+	SDL_LogDebug(SDL_LOG_CATEGORY_VIDEO,
+		"QuadPool compaction: moved quads=%i draw range=%i live quads=%i\n",
+		static_cast<int>(movedQuadCount),
+		static_cast<int>(largestQuadCount),
+		static_cast<int>(quadSlots.getAllocatedCount()));
+#endif
+}
+bool k10::QuadPool::validateQuadId(QuadId qid) const
+{
+	if (!quadIds.isAllocated(qid))
+	{
+		SDL_Log("WARNING: trying to access quad that doesn't exist!\n");
+		SDL_assert(false);
+		return false;
+	}
+	return true;
+}
+size_t k10::QuadPool::acquireUpload()
+{
+	// An Upload can only be re-used once its copies are done, and the 
+	//	graphics submission that waited on its semaphore is done as well.  
+	//	The consumer fence might have been reset & re-submitted for a later
+	//	frame since then, which just makes us wait a little longer.
+	for (size_t u = 0; u < uploads.size(); u++)
+	{
+		Upload& upload = uploads[u];
+		if (upload.inFlight &&
+			upload.consumerFence != VK_NULL_HANDLE &&
+			vkGetFenceStatus(device, upload.fence) == VK_SUCCESS &&
+			vkGetFenceStatus(device, upload.consumerFence) == VK_SUCCESS &&
+			std::find(stagingRingUploads.begin(), stagingRingUploads.end(),
+					  u) == stagingRingUploads.end())
+		{
+			upload.inFlight = false;
+		}
+		if (!upload.inFlight)
+		{
+			return u;
+		}
+	}
+	Upload newUpload;
+	const VkCommandBufferAllocateInfo commandBufferAllocInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		nullptr,// pNext
+		commandPool,
+		VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		1 // command buffer count
+	};
+	if (vkAllocateCommandBuffers(device, &commandBufferAllocInfo, 
+								 &newUpload.commandBuffer) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to allocate quad pool upload command buffer!\n");
+		return uploads.size();
+	}
+	const VkFenceCreateInfo fenceCreateInfo = {
+		VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+		nullptr,// pNext
+		VK_FENCE_CREATE_SIGNALED_BIT // flags
+	};
+	if (vkCreateFence(device, &fenceCreateInfo, 
+					  nullptr, &newUpload.fence) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool upload fence!\n");
+		vkFreeCommandBuffers(device, commandPool, 1, &newUpload.commandBuffer);
+		return uploads.size();
+	}
+	const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+		VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		nullptr,// pNext
+		0 // flags
+	};
+	if (vkCreateSemaphore(device, &semaphoreCreateInfo,
+						  nullptr, &newUpload.semaphore) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool upload semaphore!\n");
+		vkDestroyFence(device, newUpload.fence, nullptr);
+		vkFreeCommandBuffers(device, commandPool, 1, &newUpload.commandBuffer);
+		return uploads.size();
+	}
+	if (vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, 
+						  &newUpload.framesDoneSemaphore) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool frames done semaphore!\n");
+		vkDestroySemaphore(device, newUpload.semaphore, nullptr);
+		vkDestroyFence(device, newUpload.fence, nullptr);
+		vkFreeCommandBuffers(device, commandPool, 1, &newUpload.commandBuffer);
+		return uploads.size();
+	}
+	uploads.push_back(newUpload);
+	return uploads.size() - 1;
+}
+bool k10::QuadPool::createIndexBuffer(
+	GfxMemoryAllocator& allocator, VkQueue qMemoryTransfer)
+{
+	const size_t indexCount = INDICES_PER_QUAD * chunkQuadCount;
+	const VkDeviceSize indexDataSize = 
+		static_cast<VkDeviceSize>(sizeof(uint32_t) * indexCount);
+	if (!quadIndexBuffer.createBuffer(allocator, indexDataSize,
+									  VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+										VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+										(writeQuadDataInPlace ?
+											VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT :
+											0),
+									  writeQuadDataInPlace,
+									  sharingQueueFamilies))
+	{
+		return false;
+	}
+	auto writeIndices = [&](GfxBuffer& buffer)
+	{
+		uint32_t*const indices = 
+			buffer.getWriteWindow<uint32_t>(0, indexCount);
+		for (size_t q = 0; q < chunkQuadCount; q++)
+		{
+			const uint32_t firstVertex = 
+				static_cast<uint32_t>(q*VERTICES_PER_QUAD);
+			for (Uint8 i = 0; i < INDICES_PER_QUAD; i++)
+			{
+				indices[q*INDICES_PER_QUAD + i] = 
+					firstVertex + QUAD_CORNER_INDICES[i];
+			}
+		}
+		buffer.flushMappedRanges();
+	};
+	if (writeQuadDataInPlace)
+	{
+		writeIndices(quadIndexBuffer);
+		return true;
+	}
+	// the indices never change, so they only need to go through a staging
+	//	buffer once //
+	GfxBuffer stagingBufferIndices;
+	if (!stagingBufferIndices.createBuffer(allocator, indexDataSize,
+										   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+										   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+										   true))
+	{
+		return false;
+	}
+	writeIndices(stagingBufferIndices);
+	VkCommandBuffer commandBuffer;
+	const VkCommandBufferAllocateInfo commandBufferAllocInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		nullptr,// pNext
+		commandPool,
+		VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		1 // command buffer count
+	};
+	if (vkAllocateCommandBuffers(device, &commandBufferAllocInfo, 
+								 &commandBuffer) != VK_SUCCESS)
+	{
+		stagingBufferIndices.destroyBuffer();
+		return false;
+	}
+	const VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		nullptr,// pNext
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		nullptr // inheritance info pointer
+	};
+	vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+	const VkBufferCopy copyRegion = {
+		0,// src offset
+		0,// dst offset
+		indexDataSize
+	};
+	vkCmdCopyBuffer(commandBuffer, 
+					stagingBufferIndices.getBuffer(),
+					quadIndexBuffer.getBuffer(), 
+					1, &copyRegion);
+	vkEndCommandBuffer(commandBuffer);
+	const VkSubmitInfo submitInfo = {
+		VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		nullptr,// pNext
+		0,// wait semaphore count
+		nullptr,// wait semaphores
+		nullptr,// wait dst stage mask
+		1,// command buffer count
+		&commandBuffer,
+		0,// signal semaphore count
+		nullptr // signal semaphores
+	};
+	const bool submitted = 
+		vkQueueSubmit(qMemoryTransfer, 1, &submitInfo, 
+					  VK_NULL_HANDLE) == VK_SUCCESS;
+	if (submitted)
+	{
+		vkQueueWaitIdle(qMemoryTransfer);
+	}
+	vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+	stagingBufferIndices.destroyBuffer();
+	return submitted;
+}
+k10::QuadPool::Producer::Producer(QuadPool& p, QuadId rqc)
+	: pool(p)
+	, reservationQuadCount(rqc)
+{
+	SDL_assert(reservationQuadCount > 0);
+	std::unique_lock<std::shared_timed_mutex> lock(pool.mutex);
+	pool.producers.push_back(this);
+}
+k10::QuadPool::Producer::~Producer()
+{
+	std::unique_lock<std::shared_timed_mutex> lock(pool.mutex);
+	pool.mergeProducer(*this);
+	// reserved quads are degenerate already //
+	for (size_t r = nextReservedQuad; r < reservedQuadIds.size(); r++)
+	{
+		pool.releaseQuad(reservedQuadIds[r]);
+	}
+	pool.producers.erase(std::find(pool.producers.begin(), 
+								   pool.producers.end(), this));
+	pool.producerChangesPending = true;
+}
+bool k10::QuadPool::Producer::addQuads(size_t quadCount, 
+									   QuadFiller const& fillQuad,
+									   vector<QuadId>* outQuadIds)
+{
+	SDL_assert(pool.drawMode != DrawMode::INSTANCED);
+	if (!reserveQuads(quadCount))
+	{
+		return false;
+	}
+	std::shared_lock<std::shared_timed_mutex> lock(pool.mutex);
+	if (outQuadIds)
+	{
+		outQuadIds->reserve(outQuadIds->size() + quadCount);
+	}
+	Vertex quadVertices[VERTICES_PER_QUAD];
+	for (size_t q = 0; q < quadCount; q++)
+	{
+		// compaction might have moved the quad since it got reserved //
+		const QuadId qid = reservedQuadIds[nextReservedQuad++];
+		const QuadSlot slot = pool.quadIdSlots[qid];
+		fillQuad(q, quadVertices);
+		pool.storeQuadVertices(stageQuadData(slot, STAGING_QUAD_DATA_BIT_ALL),
+							   slot, quadVertices);
+		if (outQuadIds)
+		{
+			outQuadIds->push_back(qid);
+		}
+	}
+	return true;
+}
+bool k10::QuadPool::Producer::addQuadInstances(
+	size_t quadCount, QuadInstanceFiller const& fillQuad,
+	vector<QuadId>* outQuadIds)
+{
+	SDL_assert(pool.drawMode == DrawMode::INSTANCED);
+	if (!reserveQuads(quadCount))
+	{
+		return false;
+	}
+	std::shared_lock<std::shared_timed_mutex> lock(pool.mutex);
+	if (outQuadIds)
+	{
+		outQuadIds->reserve(outQuadIds->size() + quadCount);
+	}
+	for (size_t q = 0; q < quadCount; q++)
+	{
+		const QuadId qid = reservedQuadIds[nextReservedQuad++];
+		const QuadSlot slot = pool.quadIdSlots[qid];
+		fillQuad(q, *reinterpret_cast<QuadInstance*>(pool.getStagedQuadData(
+			stageQuadData(slot, STAGING_QUAD_DATA_BIT_ALL),
+			QUAD_DATA_STREAM_INSTANCE, slot)));
+		if (outQuadIds)
+		{
+			outQuadIds->push_back(qid);
+		}
+	}
+	return true;
+}
+void k10::QuadPool::Producer::updateQuadPositions(
+	QuadId qid, glm::vec2 const* cornerPositions)
+{
+	SDL_assert(pool.drawMode != DrawMode::INSTANCED);
+	std::shared_lock<std::shared_timed_mutex> lock(pool.mutex);
+	if (!validateQuadId(qid))
+	{
+		return;
+	}
+	const QuadSlot slot = pool.quadIdSlots[qid];
+	pool.storeQuadPositions(
+		stageQuadData(slot, STAGING_QUAD_DATA_BIT_POSITION), 
+		slot, cornerPositions);
+}
+void k10::QuadPool::Producer::updateQuadColors(QuadId qid, 
+											   glm::vec4 const* cornerColors)
+{
+	SDL_assert(pool.drawMode != DrawMode::INSTANCED);
+	std::shared_lock<std::shared_timed_mutex> lock(pool.mutex);
+	if (!validateQuadId(qid))
+	{
+		return;
+	}
+	const QuadSlot slot = pool.quadIdSlots[qid];
+	pool.storeQuadColors(stageQuadData(slot, STAGING_QUAD_DATA_BIT_COLOR), 
+						 slot, cornerColors);
+}
+void k10::QuadPool::Producer::updateQuadInstance(QuadId qid, 
+												 QuadInstance const& instance)
+{
+	SDL_assert(pool.drawMode == DrawMode::INSTANCED);
+	std::shared_lock<std::shared_timed_mutex> lock(pool.mutex);
+	if (!validateQuadId(qid))
+	{
+		return;
+	}
+	const QuadSlot slot = pool.quadIdSlots[qid];
+	pool.storeQuadInstance(stageQuadData(slot, STAGING_QUAD_DATA_BIT_ALL), 
+						   slot, instance);
+}
+void k10::QuadPool::Producer::removeQuad(QuadId qid)
+{
+	std::shared_lock<std::shared_timed_mutex> lock(pool.mutex);
+	if (!validateQuadId(qid))
+	{
+		return;
+	}
+	// a live quad is always inside the draw range //
+	const QuadSlot slot = pool.quadIdSlots[qid];
+	pool.storeDegenerateQuad(
+		stageQuadData(slot, pool.getDegenerateQuadDataBits()), slot);
+	removedQuadIds.insert(qid);
+	pool.producerChangesPending = true;
+}
+bool k10::QuadPool::Producer::reserveQuads(size_t quadCount)
+{
+	if (reservedQuadIds.size() - nextReservedQuad >= quadCount)
+	{
+		return true;
+	}
+	std::unique_lock<std::shared_timed_mutex> lock(pool.mutex);
+	reservedQuadIds.erase(reservedQuadIds.begin(), 
+						  reservedQuadIds.begin() + nextReservedQuad);
+	nextReservedQuad = 0;
+	// Reserved quads are live as far as the pool is concerned, so they
+	//	have to be degenerate until they get handed out //
+	const size_t reserveQuadCount = std::max(
+		quadCount - reservedQuadIds.size(), 
+		static_cast<size_t>(reservationQuadCount));
+	QuadPool& p = pool;
+	return pool.allocateQuadRuns(reserveQuadCount,
+		[&p](size_t, StagingWindow const& window)->void
+		{
+			for (QuadId q = 0; q < window.quadCount; q++)
+			{
+				p.storeDegenerateQuad(window, window.firstSlot + q);
+			}
+		}, &reservedQuadIds);
+}
+bool k10::QuadPool::Producer::validateQuadId(QuadId qid) const
+{
+	if (!pool.validateQuadId(qid))
+	{
+		return false;
+	}
+	// the pool still sees a removed quad as live until the next flush //
+	if (removedQuadIds.find(qid) != removedQuadIds.end())
+	{
+		SDL_Log("WARNING: trying to access quad that was already removed!\n");
+		SDL_assert(false);
+		return false;
+	}
+	return true;
+}
+k10::QuadPool::StagingWindow k10::QuadPool::Producer::stageQuadData(
+	QuadSlot slot, Uint8 dataBits)
+{
+	for (QuadDataStream const& stream : pool.quadDataStreams)
+	{
+		if (!(stream.dataBits & dataBits))
+		{
+			continue;
+		}
+		const VkDeviceSize offset = pool.getQuadDataOffset(stream, slot);
+		const size_t lastPage = 
+			pool.getDirtyPageIndex(offset + stream.quadDataSize - 1);
+		if (lastPage / 64 >= dirtyPages.size())
+		{
+			dirtyPages.resize(lastPage / 64 + 1, 0);
+		}
+		for (size_t page = pool.getDirtyPageIndex(offset); page <= lastPage;
+			 page++)
+		{
+			dirtyPages[page / 64] |= Uint64(1) << (page % 64);
+		}
+	}
+	pool.producerChangesPending = true;
+	return pool.getStagingWindow(slot, 1, dataBits, stagingArena);
 }
\ No newline at end of file
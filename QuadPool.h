@@ -1,106 +1,849 @@
-#pragma once
-namespace k10
-{
-	struct Vertex
-	{
-		static const VkVertexInputBindingDescription bindingDescription;
-		static const vector<VkVertexInputAttributeDescription> attributeDescriptions;
-		glm::vec2 position;
-		glm::vec4 color;
-	};
-	class GfxBuffer
-	{
-	public:
-		bool createBuffer(VkDevice d, VkPhysicalDevice pd,
-						  VkDeviceSize size, 
-						  VkBufferUsageFlags usageFlags,
-						  VkMemoryPropertyFlags memPropFlags);
-		void destroyBuffer();
-		void mapMemory(void** data, VkDeviceSize offset, VkDeviceSize size);
-		void unmapMemory();
-		VkBuffer getBuffer() const;
-	private:
-		// Returns a uint32_t that represents the index of the physicalDevice's
-		//	memory types that satisfies the params.
-		// Returns 'numeric_limits<uint64_t>::max()' on failure.
-		static uint64_t findMemoryType(uint32_t typeFilter, 
-									   VkMemoryPropertyFlags properties,
-									   VkPhysicalDevice pd);
-	private:
-		VkDevice device;
-		VkBuffer buffer;
-		VkDeviceMemory deviceMemory;
-		VkDeviceSize bufferSize;
-	};
-	class QuadPool
-	{
-	public:
-		using QuadId = uint32_t;
-	public:
-		bool fillPool(VkDevice d, VkPhysicalDevice pd, VkCommandPool cp,
-					  size_t maxQuadCount);
-		void drainPool();
-		// returns the max value of QuadId if we have already reached the 
-		//	maximum possible # of quads in the pool
-		QuadId addQuad(vector<Vertex> const& vertices);
-		void removeQuad(QuadId qid);
-		void flushVertexStaging(VkQueue qMemoryTransfer);
-		bool flushRequired() const;
-		void issueCommands(VkCommandBuffer cb);
-	private:
-		static const Uint8 VERTICES_PER_QUAD;
-		static const VkDeviceSize QUAD_VERTEX_DATA_SIZE;
-		struct Quad
-		{
-			VkDeviceSize dataBufferOffset;
-		};
-		enum StagingQuadDataBits
-		{
-			STAGING_QUAD_DATA_BIT_POSITION = 0x01,
-			STAGING_QUAD_DATA_BIT_COLOR    = 0x02,
-			// prefer to select the ALL mask, since it should allow us to group
-			//	together multiple staging data command transfers into a batch
-			STAGING_QUAD_DATA_BIT_ALL      = 0x03
-		};
-		struct StagingQuad
-		{
-			VkDeviceSize dataBufferOffset;
-			Uint8 stagingQuadDataBits = 0;
-			// there is no need to store data in the staging quad array because
-			//	currently I am just immediately storing the necessary data in
-			//	a mapped staging buffer immediately after the changes are sent
-			//	to the pool //
-///			Vertex data[4];
-		};
-	private:
-		VkDevice device;
-		VkCommandPool commandPool;
-		GfxBuffer quadDataBuffer;
-		GfxBuffer stagingBufferVertices;
-		size_t maxQuadCount;
-		// maxQuadId is used to determine how many quads in the buffer should 
-		//	be sent to the render pass command buffer.  Removed quads will 
-		//	still attempt to be drawn, but we can assume they are degenerate
-		//	geometry.  This is to prevent the need for having to initialize
-		//	the entire quad data buffer to degenerate geometry when the pool
-		//	gets filled, which would probably take a long time if our pool
-		//	size is large!
-		QuadId largestQuadCount;
-		QuadId nextQuadId;
-///		// this layer of indirection from QuadId=>bufferOffset is required if we want
-///		//	the ability to defragment the quads so they are all at the beginning of
-///		//	the buffer
-///		std::unordered_map<QuadId, Quad> quads;
-		// It shouldn't be necessary to defragment the quads so that they are 
-		//	all aligned in GPU memory, as my current draw strategy is to just 
-		//	allow potentially the entire buffer to be sent to a draw command 
-		//	buffer. This strategy should work if I set quads that were 
-		//	"removed" from the pool to just be degenerate geometry.
-		std::unordered_set<QuadId> quadSet;
-		// stagingQuads represents a collection of meta data describing the
-		//	data that has already been added to the staging buffer which is
-		//	waiting to be added to the quad data buffer.
-		vector<StagingQuad> stagingQuads;
-		VkFence stagingMemoryTransferFence;
-	};
-}
+#pragma once
+#include "SlotAllocator.h"
+#include "GfxMemoryAllocator.h"
+#include "GfxProgram.h"
+namespace k10
+{
+	// packs a [0,1] RGBA color into 8 bits per channel, in the byte order
+	//	expected by VK_FORMAT_R8G8B8A8_UNORM
+	Uint32 packUnorm8Color(glm::vec4 const& color);
+	glm::vec4 unpackUnorm8Color(Uint32 packedColor);
+	// packs a [-1,1] value into 16 bits, as expected by the *_SNORM formats
+	Sint16 packSnorm16(float value);
+	float unpackSnorm16(Sint16 packedValue);
+	struct Vertex
+	{
+		glm::vec2 position;
+		glm::vec4 color;
+	};
+	// A whole quad packed into a single per-instance record.  The vertex 
+	//	shader expands the rect out into the same corners a Vertex quad 
+	//	would use: left-bottom, left-top, right-top, right-bottom.
+	struct QuadInstance
+	{
+		static const VkVertexInputBindingDescription bindingDescription;
+		static const vector<VkVertexInputAttributeDescription> attributeDescriptions;
+		// left, top, right, bottom
+		glm::vec4 rect;
+		float depth;
+		// colors of each corner in the same order as the corners, packed 
+		//	using packUnorm8Color
+		Uint32 cornerColors[4];
+	};
+	class GfxBuffer
+	{
+	public:
+		// The buffer's memory is sub-allocated from allocator, which must
+		//	outlive the buffer.  memPropFlags are the memory properties the
+		//	buffer requires, see GfxMemoryAllocator::findMemoryType.
+		// If persistentlyMapped is set, writes must go through 
+		//	getWriteWindow instead of mapMemory/unmapMemory.
+		// If sharingQueueFamilies contains more than one distinct queue 
+		//	family, the buffer is created with concurrent sharing so it can
+		//	be used by all of them without ownership transfers.
+		bool createBuffer(GfxMemoryAllocator& allocator,
+						  VkDeviceSize size, 
+						  VkBufferUsageFlags usageFlags,
+						  VkMemoryPropertyFlags memPropFlags,
+						  bool persistentlyMapped = false,
+						  vector<uint32_t> const& sharingQueueFamilies = {});
+		void destroyBuffer();
+		// host visible memory is always mapped, so this just hands out a 
+		//	pointer into it & unmapMemory flushes what was handed out
+		void mapMemory(void** data, VkDeviceSize offset, VkDeviceSize size);
+		void unmapMemory();
+		// Returns a pointer to count T elements starting at byte offset of a
+		//	persistently mapped buffer, and marks that range as dirty so it 
+		//	gets picked up by the next flushMappedRanges.
+		template<class T>
+		T* getWriteWindow(VkDeviceSize offset, size_t count);
+		// doesn't mark the range dirty, see flushMappedRange
+		template<class T>
+		T* getMappedWindow(VkDeviceSize offset, size_t count);
+		// Makes host writes to the dirty range visible to the device.  This
+		//	is a no-op for host coherent memory.
+		void flushMappedRanges();
+		void flushMappedRange(VkDeviceSize offset, VkDeviceSize size);
+		// Makes device writes visible to the host before reading them out of
+		//	the mapped memory.  This is a no-op for host coherent memory.
+		void invalidateMappedRange(VkDeviceSize offset, VkDeviceSize size);
+		VkBuffer getBuffer() const;
+		uint32_t getMemoryHeapIndex() const;
+		// bytes of device memory the buffer is holding on to, or 0 if it 
+		//	hasn't been created
+		VkDeviceSize getMemorySize() const;
+	private:
+		// expands [offset, offset + size) out to nonCoherentAtomSize 
+		//	boundaries, as required by vkFlush/InvalidateMappedMemoryRanges
+		VkMappedMemoryRange alignedMappedRange(VkDeviceSize offset,
+											   VkDeviceSize size) const;
+	private:
+		GfxMemoryAllocator* allocator = nullptr;
+		GfxMemoryAllocator::Allocation allocation;
+		VkBuffer buffer;
+		VkDeviceSize bufferSize;
+		void* persistentMapping = nullptr;
+		// the range of the mapping written to since the last 
+		//	flushMappedRanges.  Empty when dirtyBegin >= dirtyEnd.
+		VkDeviceSize dirtyBegin = numeric_limits<VkDeviceSize>::max();
+		VkDeviceSize dirtyEnd = 0;
+	};
+	template<class T>
+	T* GfxBuffer::getWriteWindow(VkDeviceSize offset, size_t count)
+	{
+		const VkDeviceSize windowSize = 
+			static_cast<VkDeviceSize>(sizeof(T) * count);
+		if (offset < dirtyBegin)
+		{
+			dirtyBegin = offset;
+		}
+		if (offset + windowSize > dirtyEnd)
+		{
+			dirtyEnd = offset + windowSize;
+		}
+		return getMappedWindow<T>(offset, count);
+	}
+	template<class T>
+	T* GfxBuffer::getMappedWindow(VkDeviceSize offset, size_t count)
+	{
+		SDL_assert(persistentMapping);
+		SDL_assert(offset + static_cast<VkDeviceSize>(sizeof(T) * count) <= 
+				   bufferSize);
+		return reinterpret_cast<T*>(
+			static_cast<Uint8*>(persistentMapping) + offset);
+	}
+	class QuadPool
+	{
+	public:
+		// QuadIds stay the same for as long as the quad is alive, even when
+		//	compaction moves its data to a different slot of the buffer.
+		using QuadId = uint32_t;
+		// fills in the VERTICES_PER_QUAD vertices of the quad at quadIndex 
+		//	within a batch passed to addQuads
+		using QuadFiller = std::function<void(size_t quadIndex, 
+											  Vertex* quadVertices)>;
+		// fills in the instance record of the quad at quadIndex within a
+		//	batch passed to addQuadInstances
+		using QuadInstanceFiller = std::function<void(size_t quadIndex,
+													  QuadInstance& instance)>;
+		// Every quad is described by its 4 corner vertices, in the order 
+		//	they are wound around the quad.  The triangles drawn are always
+		//	made out of the corners 0-1-2 & 2-3-0.
+		static const Uint8 VERTICES_PER_QUAD;
+		enum class DrawMode : Uint8
+		{
+			// each quad is stored as the 6 vertices of its 2 triangles, and
+			//	drawn with a plain vkCmdDraw
+			VERTEX_LIST,
+			// each quad only stores its 4 unique corners, and is drawn with
+			//	vkCmdDrawIndexed using a static index buffer shared by every
+			//	quad in the pool
+			INDEXED,
+			// each quad is stored as a single QuadInstance, and drawn as an
+			//	instance of a 6 vertex quad.  This requires a vertex shader
+			//	that builds the corners out of the instance attributes, like
+			//	shaders/simple-draw-instanced.vert
+			INSTANCED
+		};
+		// The layout of the vertex attributes stored by VERTEX_LIST & 
+		//	INDEXED pools.  Callers always work with Vertex, and the vertex
+		//	shader always sees a vec2 position & vec4 color, regardless of 
+		//	this setting.
+		enum class VertexFormat : Uint8
+		{
+			// R32G32_SFLOAT positions & R32G32B32A32_SFLOAT colors
+			FULL,
+			// R16G16_SNORM positions & R8G8B8A8_UNORM colors.  Positions 
+			//	are clamped to normalized device coordinates [-1,1] & 
+			//	rounded to the nearest multiple of 1/32767, so they move by
+			//	up to 0.5/32767 (~1.5e-5), which is under 1/30 of a pixel on
+			//	a 3840 wide swap chain.  Color channels are clamped to [0,1]
+			//	& move by up to 0.5/255.
+			PACKED
+		};
+		struct FlushStats
+		{
+			// DIRTY_PAGE_SIZE pages written to since the last flush
+			size_t dirtyPageCount;
+			// copy regions, or flushed ranges when written in place
+			size_t dirtyRunCount;
+			VkDeviceSize copiedByteCount;
+			// # of quads moved into holes by compaction
+			size_t movedQuadCount;
+		};
+		// the default size of the ring that staged quad data gets written
+		//	into before it is copied to the quad data buffer
+		static const VkDeviceSize DEFAULT_STAGING_RING_SIZE;
+		// the granularity writes to the quad data are tracked at
+		static const VkDeviceSize DIRTY_PAGE_SIZE;
+		static const QuadId DEFAULT_COMPACTION_MOVE_BUDGET;
+		static const QuadId DEFAULT_CHUNK_QUAD_COUNT;
+		// the most quads a pool can ever address
+		static const size_t MAX_QUAD_COUNT;
+		class Producer;
+	public:
+		// Staging uploads are recorded & submitted on the queue family at
+		//	transferQueueFamilyIndex, while the quad data is drawn from the
+		//	queue family at graphicsQueueFamilyIndex (these can be the same).
+		// qMemoryTransfer must belong to the transfer queue family.  It is 
+		//	only used here to upload the static index buffer, which blocks 
+		//	until it's done.
+		// The quad data lives in chunks of chunkQuadCount quads, created as
+		//	they fill up.  maxQuadCount is rounded up to a whole # of chunks.
+		// If allocator reports host visible device local memory (UMA or
+		//	ReBAR), the quad data is written in place & never staged.  
+		//	Writing a quad that a frame in flight draws waits for that 
+		//	frame, while quads past the frames' draw ranges never wait.
+		// Otherwise quad data is written into a staging ring of 
+		//	stagingRingSize bytes, which flushes copy into the chunks.
+		bool fillPool(GfxMemoryAllocator& allocator, 
+					  uint32_t transferQueueFamilyIndex,
+					  uint32_t graphicsQueueFamilyIndex,
+					  VkQueue qMemoryTransfer,
+					  size_t maxQuadCount, 
+					  DrawMode dm = DrawMode::INDEXED,
+					  VertexFormat vf = VertexFormat::FULL,
+					  VkDeviceSize stagingRingSize = DEFAULT_STAGING_RING_SIZE,
+					  QuadId chunkQuadCount = DEFAULT_CHUNK_QUAD_COUNT);
+		// The caller must make sure the device is idle first, and that every
+		//	Producer of the pool has been destroyed.
+		void drainPool();
+		// the vertex input layout of pipelines used to draw this pool
+		vector<VkVertexInputBindingDescription> const& 
+			getVertexBindingDescriptions() const;
+		vector<VkVertexInputAttributeDescription> const& 
+			getVertexAttributeDescriptions() const;
+		// The Vertex based add functions can't be used by INSTANCED pools, 
+		//	and the QuadInstance based add functions can only be used by 
+		//	INSTANCED pools.
+		// returns the max value of QuadId if we have already reached the 
+		//	maximum possible # of quads in the pool
+		QuadId addQuad(vector<Vertex> const& vertices);
+		// Adds quadCount quads to the pool at once.  fillQuad gets called for 
+		//	each quad to fill in its vertices, which then get written straight
+		//	into the quad data.  The new QuadIds are appended to 
+		//	outQuadIds in the same order as the quadIndex values passed to 
+		//	fillQuad.
+		// returns false without adding any quads if the pool doesn't have 
+		//	enough room left for all of them
+		bool addQuads(size_t quadCount, QuadFiller const& fillQuad,
+					  vector<QuadId>* outQuadIds = nullptr);
+		// same as above, except the vertices of every quad are copied out of
+		//	a contiguous array of VERTICES_PER_QUAD*quadCount vertices
+		bool addQuads(vector<Vertex> const& vertices,
+					  vector<QuadId>* outQuadIds = nullptr);
+		QuadId addQuadInstance(QuadInstance const& instance);
+		// same as addQuads, except fillQuad writes a QuadInstance directly 
+		//	into the quad data
+		bool addQuadInstances(size_t quadCount, 
+							  QuadInstanceFiller const& fillQuad,
+							  vector<QuadId>* outQuadIds = nullptr);
+		// Replace the positions or colors of the VERTICES_PER_QUAD corners of
+		//	an existing quad.  Only the pages holding the attribute being 
+		//	updated get uploaded on the next flush.
+		// Can't be used by INSTANCED pools.
+		void updateQuadPositions(QuadId qid, glm::vec2 const* cornerPositions);
+		void updateQuadColors(QuadId qid, glm::vec4 const* cornerColors);
+		// INSTANCED pools only
+		void updateQuadInstance(QuadId qid, QuadInstance const& instance);
+		void removeQuad(QuadId qid);
+		// Merges every Producer & submits the quad data staged since the 
+		//	last flush to qMemoryTransfer without waiting for it.  The next
+		//	graphics submission that reads from the pool must wait on the
+		//	semaphores handed out by consumeUploadSemaphores.
+		// The copies overwrite quad data that frames still in flight might 
+		//	be drawing, so the first upload waits for every graphics 
+		//	submission made before the flush: through a semaphore signaled
+		//	by an empty submission to qGraphics, or through a barrier when
+		//	qGraphics is qMemoryTransfer.
+		// Quad data written in place only gets its dirty pages flushed.
+		// Each flush also compacts the pool by moving up to the compaction
+		//	move budget of quads from the end of the draw range into the 
+		//	holes left by removed quads, so the draw range shrinks back 
+		//	down to the # of live quads over a few frames.  The moves are
+		//	buffer to buffer copies on qMemoryTransfer that wait for the 
+		//	frames in flight like the staging copies do, or host copies 
+		//	when the quad data is written in place.
+		// Chunks left empty are released at the end of the flush.
+		void flushVertexStaging(VkQueue qMemoryTransfer, VkQueue qGraphics);
+		// the most quads a single flush moves while compacting the pool.  
+		//	0 disables compaction.
+		void setCompactionMoveBudget(QuadId maxMovesPerFlush);
+		// Creates the compute pipeline of the GPU culling pre-pass out of
+		//	cullProgram (shaders/quad-cull.comp), and turns culling on.  
+		//	Every chunk gets a cull buffer which the pre-pass fills with the
+		//	indices (or instances) of the chunk's quads that are inside the
+		//	viewport, along with the indirect command that draws them, so
+		//	vertex work follows the # of visible quads instead of the draw 
+		//	range.  Visible quads are compacted in slot order, so they get 
+		//	drawn in the same order as they would be without culling.
+		bool createCullPipeline(GfxProgram const* cullProgram);
+		// Takes effect the next time draw commands are issued.  Does 
+		//	nothing without a cull pipeline.
+		void setGpuCulling(bool enabled);
+		bool isGpuCullingEnabled() const;
+		// Appends a semaphore for every upload that no graphics submission
+		//	has waited on yet to waitSemaphores (along with the stage they
+		//	need to be waited on at).  frameFence must be the fence of the
+		//	graphics submission that waits on them, so we know when the 
+		//	semaphores can be recycled.  This should be called for every 
+		//	frame, since its fences are also used to tell when released 
+		//	chunks stop being drawn, and when quad data written in place
+		//	stops being read.  frameFence has to be reset already, since 
+		//	writes made after this wait on it.
+		void consumeUploadSemaphores(VkFence frameFence,
+									 vector<VkSemaphore>& waitSemaphores,
+									 vector<VkPipelineStageFlags>& waitStages);
+		// Drops every frame fence handed to consumeUploadSemaphores & 
+		//	beginStreamingFrame, so that they can be destroyed.  The device
+		//	has to be idle, since whatever they were guarding is treated as
+		//	done: retired chunks get destroyed right away.
+		void forgetFrameFences();
+		// true when a flush has something to upload, which includes the # 
+		//	of quads each chunk draws
+		bool flushRequired() const;
+		FlushStats getLastFlushStats() const;
+		// bytes held by the pool's buffers, including released chunks
+		VkDeviceSize getGfxMemorySize() const;
+		DrawMode getDrawMode() const;
+		VertexFormat getVertexFormat() const;
+		// Records the draw command updates left by the flushes since the 
+		//	last call, which only happens when the quad data is written in 
+		//	place.  Has to be recorded outside of the render pass, before 
+		//	issueCullCommands.
+		void issueUpdateCommands(VkCommandBuffer cb);
+		// Records the culling pre-pass of every created chunk if culling is
+		//	enabled.  Has to be recorded outside of the render pass, before
+		//	issueCommands.
+		void issueCullCommands(VkCommandBuffer cb);
+		// Records an indirect draw for each created chunk out of 
+		//	drawArgsBuffer, or out of its cull buffer if culling is enabled.
+		void issueCommands(VkCommandBuffer cb);
+		// # of chunks that issueChunkCommands can be given, including the
+		//	slots of released chunks
+		size_t getChunkSlotCount() const;
+		// Same as issueCommands, but only for the chunks in 
+		//	[firstChunk, firstChunk + chunkCount).  Only takes a shared 
+		//	lock, so several threads can record disjoint ranges of chunks 
+		//	into their own command buffers at the same time.
+		void issueChunkCommands(VkCommandBuffer cb, size_t firstChunk, 
+								size_t chunkCount) const;
+		// Streaming quads //
+		// Streaming quads only live for a single frame, and are meant for 
+		//	content that changes every frame anyway (particles, UI, ...).
+		//	Instead of going through the quad data chunks, they get written
+		//	straight into a host visible region of their frame, which the 
+		//	device draws out of without any copies or transfer commands.
+		// Creates frameCount regions that each fit quadsPerFrame streaming
+		//	quads (rounded up to a whole # of chunks).  frameCount should be
+		//	the # of frames that can be in flight at once, since a region 
+		//	can only be re-used once the frame that drew it is done.
+		bool createStreamingFrames(uint32_t frameCount, size_t quadsPerFrame);
+		// Throws away the streaming quads of the frame at frameIndex & 
+		//	starts streaming new ones into it.  frameFence must be the fence
+		//	of the last submission that drew the frame, which the first 
+		//	write to the region waits on.
+		void beginStreamingFrame(uint32_t frameIndex, VkFence frameFence);
+		// Appends quadCount quads to the current streaming frame.  These 
+		//	work like addQuads/addQuadInstances, except no QuadIds are 
+		//	handed out since the quads go away on their own.
+		// returns false without adding any quads if the frame doesn't have
+		//	enough room left for all of them
+		bool addStreamingQuads(size_t quadCount, QuadFiller const& fillQuad);
+		bool addStreamingQuadInstances(size_t quadCount, 
+									   QuadInstanceFiller const& fillQuad);
+		// the # of quads streamed into the current frame so far
+		size_t getStreamingQuadCount() const;
+		// Writes the indirect draw commands of the current streaming frame &
+		//	makes its quads visible to the device.  Has to be called before 
+		//	the submission that draws the frame.
+		void endStreamingFrame();
+		// Records an indirect draw of each chunk of the streaming region of
+		//	the frame at frameIndex.  The draw counts are only read when the
+		//	commands execute, so the command buffer never has to be 
+		//	re-recorded when the # of streaming quads changes.
+		void issueStreamingCommands(VkCommandBuffer cb, uint32_t frameIndex);
+		// /////////////////////////////////////////// end streaming quads //
+	private:
+		static const Uint8 INDICES_PER_QUAD;
+		// which of a quad's corners make up each of its triangle vertices
+		static const uint32_t QUAD_CORNER_INDICES[];
+		static const glm::vec2 DEGENERATE_QUAD_POSITIONS[];
+		static const QuadInstance DEGENERATE_QUAD_INSTANCE;
+		// where the visible quads start in a cull buffer, after the 
+		//	indirect draw command
+		static const VkDeviceSize CULL_OUTPUT_OFFSET;
+		// local_size_x of shaders/quad-cull.comp
+		static const uint32_t CULL_WORKGROUP_SIZE;
+		// the size of the staging blocks handed out to the pool & its 
+		//	Producers, unless a run needs a bigger one
+		static const VkDeviceSize STAGING_BLOCK_SIZE;
+		static const uint32_t CULL_DESCRIPTOR_POOL_SET_COUNT;
+		// the push constants of shaders/quad-cull.comp
+		struct CullParams
+		{
+			// the pre-pass reads the chunk's quad count out of its draw 
+			//	command in drawArgsBuffer
+			uint32_t chunkIndex;
+			uint32_t drawMode;
+			uint32_t vertexFormat;
+			uint32_t storedVerticesPerQuad;
+			uint32_t chunkQuadCount;
+			// which of the shader's 3 passes to run
+			uint32_t pass;
+		};
+		// the index of a quad's data in each QuadDataStream
+		using QuadSlot = SlotAllocator::SlotIndex;
+		static const Uint8 MAX_QUAD_DATA_STREAM_COUNT = 2;
+		enum StagingQuadDataBits
+		{
+			STAGING_QUAD_DATA_BIT_POSITION = 0x01,
+			STAGING_QUAD_DATA_BIT_COLOR    = 0x02,
+			// prefer to select the ALL mask, since it should allow us to group
+			//	together multiple staging data command transfers into a batch
+			STAGING_QUAD_DATA_BIT_ALL      = 0x03
+		};
+		// Quad data is split up into streams which each get their own 
+		//	contiguous range of every chunk's data buffer & their own vertex
+		//	binding, so that each stream can be updated independently.
+		//	VERTEX_LIST & INDEXED pools store positions & colors in separate
+		//	streams, while INSTANCED pools only have one stream.
+		struct QuadDataStream
+		{
+			VkDeviceSize bufferOffset;
+			// the # of bytes each quad takes up in this stream
+			VkDeviceSize quadDataSize;
+			// the StagingQuadDataBits this stream contains
+			Uint8 dataBits;
+		};
+		enum QuadDataStreamIndex : Uint8
+		{
+			QUAD_DATA_STREAM_POSITION = 0,
+			QUAD_DATA_STREAM_COLOR    = 1,
+			QUAD_DATA_STREAM_INSTANCE = 0
+		};
+		// the resources of a single submission of staged data to the GPU
+		struct Upload
+		{
+			VkCommandBuffer commandBuffer;
+			// signaled once the transfer commands complete
+			VkFence fence;
+			// waited on by the first graphics submission after the upload
+			VkSemaphore semaphore;
+			// signaled by the graphics queue once the frames submitted 
+			//	before the upload are done, if the upload waits on them
+			VkSemaphore framesDoneSemaphore;
+			bool inFlight = false;
+			// the frame fence of the graphics submission that waited on the
+			//	semaphore, or VK_NULL_HANDLE if nothing has waited on it yet
+			VkFence consumerFence = VK_NULL_HANDLE;
+			// stagingRingHead at the time of submission, so the ring can be
+			//	released up to here once the fence is signaled
+			VkDeviceSize stagingRingEnd = 0;
+		};
+		struct Chunk
+		{
+			// only valid while created is set
+			GfxBuffer dataBuffer;
+			bool created = false;
+			QuadId liveQuadCount = 0;
+			// one past the highest slot written since the chunk was created
+			QuadId writtenQuadCount = 0;
+			// the # of quads the chunk's command in drawArgsBuffer draws.  
+			//	Starts out invalid so the next flush always writes it.
+			QuadId drawArgsQuadCount = numeric_limits<QuadId>::max();
+			// a bit for each DIRTY_PAGE_SIZE page of the chunk's data that
+			//	has been written since the last flush
+			vector<Uint64> dirtyPages;
+			// only created while the pool has a cull pipeline
+			GfxBuffer cullBuffer;
+			VkDescriptorSet cullDescriptorSet = VK_NULL_HANDLE;
+			// the pool cullDescriptorSet came from
+			VkDescriptorPool cullDescriptorPool = VK_NULL_HANDLE;
+		};
+		struct RetiredChunk
+		{
+			Chunk chunk;
+			// the chunk is destroyed once every one of these is signaled
+			vector<VkFence> fences;
+		};
+		// Quad data written into staging memory since the last flush, 
+		//	waiting to be copied to where it belongs in the chunks.
+		struct StagedRun
+		{
+			// a mapping of stagingRing at ringOffset if inRing is set
+			Uint8* data;
+			VkDeviceSize ringOffset;
+			bool inRing;
+			VkDeviceSize quadDataOffset;
+			VkDeviceSize size;
+			// the latest run of each byte is the one that gets copied
+			Uint64 sequence;
+		};
+		// a block of staging memory split into runs by a single owner
+		struct StagingArena
+		{
+			// the block that runs are handed out of, or nullptr if there
+			//	isn't one
+			Uint8* blockData = nullptr;
+			VkDeviceSize blockRingOffset = 0;
+			bool blockInRing = false;
+			VkDeviceSize blockSize = 0;
+			VkDeviceSize blockUsedSize = 0;
+			// every run handed out since the last flush
+			vector<StagedRun> runs;
+		};
+		// the memory of a run of quads handed out by stageQuadData
+		struct StagingWindow
+		{
+			// nullptr for streams that weren't staged
+			Uint8* streamData[MAX_QUAD_DATA_STREAM_COUNT];
+			QuadSlot firstSlot;
+			QuadId quadCount;
+		};
+		// writes the data of the quads in window into the staged quad data,
+		//	using the quads starting at firstQuadIndex of an add batch
+		using QuadRunWriter = std::function<void(size_t firstQuadIndex,
+												 StagingWindow const& window)>;
+	private:
+		// Allocates both a QuadId & a slot for a new quad.
+		// returns SlotAllocator::INVALID_SLOT if the pool is full
+		QuadId allocateQuad();
+		// hands out a new QuadId for the quad living in slot
+		QuadId bindQuadId(QuadSlot slot);
+		// creates the chunks of the next quadCount slots allocateSlot hands
+		//	out.  Returns false if the pool can't grow that much.
+		bool reserveSlots(size_t quadCount);
+		QuadSlot allocateSlot();
+		void releaseSlot(QuadSlot slot);
+		bool createChunk(size_t chunkIndex);
+		// creates the cull buffer of a created chunk & the descriptor set 
+		//	the pre-pass uses to read the chunk
+		bool createChunkCullResources(Chunk& chunk);
+		// destroys the buffers of a created or retired chunk
+		void destroyChunk(Chunk& chunk);
+		// the # of quads at the start of the chunk that get drawn, or 0 if 
+		//	the chunk doesn't get drawn at all
+		QuadId getChunkDrawQuadCount(size_t chunkIndex) const;
+		// moves the chunk into retiredChunks
+		void retireChunk(size_t chunkIndex);
+		// retires empty chunks & drops the slots past the draw range
+		void releaseEmptyChunks();
+		// destroys the retired chunks whose fences have all been signaled
+		void destroyRetiredChunks();
+		// offsets into every chunk's data laid out back to back
+		VkDeviceSize getQuadDataOffset(QuadDataStream const& stream, 
+									   QuadSlot slot) const;
+		// only used when the quad data is written in place
+		Uint8* getQuadDataWindow(VkDeviceSize quadDataOffset, 
+								 VkDeviceSize size);
+		// the whole run has to be written, since all of it gets copied
+		Uint8* allocateStagedRun(StagingArena& arena, 
+								 VkDeviceSize quadDataOffset, 
+								 VkDeviceSize size);
+		// out of the staging ring, or host memory if the ring is full
+		void allocateStagingBlock(StagingArena& arena, VkDeviceSize minSize);
+		// marks the pages holding size bytes at a quad data offset as dirty
+		void markQuadDataDirty(VkDeviceSize quadDataOffset, VkDeviceSize size);
+		// waits for the frames in flight that draw the quad at a quad data
+		//	offset before it gets written in place
+		void waitForInPlaceReaders(VkDeviceSize quadDataOffset);
+		// fills dirtyRegions & clears the dirty bits
+		void collectDirtyRuns();
+		// fills stagedRuns with the coalesced parts of the runs that no 
+		//	later run overwrote, the ones in the staging ring first
+		void collectStagedRuns();
+		// one vkCmdCopyBuffer per pair of chunks.  A null srcBuffer means 
+		//	the source offsets are quad data offsets too.
+		void recordQuadDataCopies(VkCommandBuffer cb, GfxBuffer* srcBuffer,
+								  vector<VkBufferCopy>& regions);
+		// Allocates quadCount quads in runs of consecutive slots within a 
+		//	chunk, & stages each run using the data written by writeRun.
+		// returns false without adding any quads if the pool doesn't have 
+		//	enough room left for all of them
+		bool allocateQuadRuns(size_t quadCount, QuadRunWriter const& writeRun,
+							  vector<QuadId>* outQuadIds);
+		// returns the corner of the quad that a vertex stored in the quad 
+		//	data buffer comes from
+		Uint8 storedVertexCorner(Uint8 storedVertex) const;
+		// write a quad's data in the layout of the DrawMode & VertexFormat
+		void storeQuadPositions(StagingWindow const& window, QuadSlot slot, 
+								glm::vec2 const* cornerPositions) const;
+		void storeQuadColors(StagingWindow const& window, QuadSlot slot, 
+							 glm::vec4 const* cornerColors) const;
+		void storeQuadVertices(StagingWindow const& window, QuadSlot slot, 
+							   Vertex const* quadVertices) const;
+		void storeQuadInstance(StagingWindow const& window, QuadSlot slot, 
+							   QuadInstance const& instance) const;
+		// the StagingQuadDataBits that have to be overwritten to make a 
+		//	quad degenerate, so it stops getting rasterized
+		Uint8 getDegenerateQuadDataBits() const;
+		// window has to contain getDegenerateQuadDataBits
+		void storeDegenerateQuad(StagingWindow const& window, 
+								 QuadSlot slot) const;
+		// the memory of the streams containing dataBits, without marking 
+		//	anything as dirty.  The quads have to be in the same chunk.
+		StagingWindow getStagingWindow(QuadSlot firstSlot, QuadId quadCount,
+									   Uint8 dataBits, StagingArena& arena);
+		// Same as getStagingWindow, except the streams also get marked as
+		//	dirty so they get sent to the device on the next flush.
+		StagingWindow stageQuadData(QuadSlot firstSlot, QuadId quadCount, 
+									Uint8 dataBits);
+		// the memory in window for the quad in slot of the stream at 
+		//	streamIndex
+		Uint8* getStagedQuadData(StagingWindow const& window, 
+								 Uint8 streamIndex, QuadSlot slot) const;
+		// the offset of a streaming chunk's data within the streaming buffer
+		VkDeviceSize getStreamingChunkOffset(uint32_t frameIndex, 
+											 size_t chunkIndex) const;
+		// waits for the device to stop drawing out of the current streaming
+		//	frame if it hasn't already
+		void waitForStreamingFrame();
+		// Appends quadCount quads to the current streaming frame, calling
+		//	writeRun for each run of them that sits in the same chunk.
+		// returns false if the frame doesn't have enough room left
+		bool allocateStreamingRuns(size_t quadCount, 
+								   QuadRunWriter const& writeRun);
+		// returns false if the ring is full even after reclaiming it
+		bool allocateStagingRing(VkDeviceSize size, VkDeviceSize& outOffset);
+		// releases the ring space of every upload that has finished, 
+		//	waiting for the oldest one first if waitForOldestUpload is set
+		void reclaimStagingRing(bool waitForOldestUpload);
+		// Submits the staged copies & then the compaction moves, over as 
+		//	many uploads as it takes to fit runs held on the host.
+		void submitStaging(VkQueue qMemoryTransfer, VkQueue qGraphics);
+		// Submits an empty batch to qGraphics that signals semaphore once 
+		//	every graphics submission before it is done.
+		// returns false without submitting anything if none of the frame 
+		//	fences are still pending, since there is nothing to wait for
+		bool signalFramesDone(VkQueue qGraphics, VkSemaphore semaphore);
+		// true while the draw range still has holes in it that compaction 
+		//	can fill
+		bool compactionRequired() const;
+		// Moves up to compactionMoveBudget quads from the end of the draw 
+		//	range into the lowest free slots.  Fills compactionCopyRegions,
+		//	unless the quad data is written in place.
+		void compactQuads();
+		// returns false if qid isn't a live quad
+		bool validateQuadId(QuadId qid) const;
+		// frees qid & its slot without touching the slot's data
+		void releaseQuad(QuadId qid);
+		// counting the pages of every chunk back to back
+		size_t getDirtyPageIndex(VkDeviceSize quadDataOffset) const;
+		// the indirect command that draws quadCount quads of a chunk (or a 
+		//	streaming chunk).  VERTEX_LIST & INSTANCED pools draw it as a 
+		//	VkDrawIndirectCommand, which has the same layout as the first 
+		//	part of it.
+		VkDrawIndexedIndirectCommand getDrawArgs(QuadId quadCount) const;
+		// true if any created chunk draws a different # of quads than its 
+		//	command in drawArgsBuffer
+		bool drawArgsOutdated() const;
+		// Brings the commands of every created chunk in drawArgsBuffer up 
+		//	to date by recording updates of them into cb, or by leaving them
+		//	for issueUpdateCommands when the quad data is written in place.
+		// returns false if every command was up to date already
+		bool updateDrawArgs(VkCommandBuffer cb);
+		// the vkCmdUpdateBuffers of drawArgs [firstChunk, endChunk)
+		void recordDrawArgsUpdates(VkCommandBuffer cb, size_t firstChunk,
+								   size_t endChunk) const;
+		// the pool has to be locked exclusively
+		void mergeProducer(Producer& producer);
+		// the indices of a chunk's slots, shared by every chunk.  Blocks
+		//	until the upload is done.
+		bool createIndexBuffer(GfxMemoryAllocator& allocator, 
+							   VkQueue qMemoryTransfer);
+		// Returns the index of an Upload whose resources are free to re-use,
+		//	creating a new one if every Upload is still in use.
+		// Returns uploads.size() on failure.
+		size_t acquireUpload();
+	private:
+		VkDevice device;
+		// what chunks created after fillPool need
+		GfxMemoryAllocator* allocator;
+		vector<uint32_t> sharingQueueFamilies;
+		// command pool for the transfer queue family
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		// chunk c holds slots [c*chunkQuadCount, (c+1)*chunkQuadCount)
+		vector<Chunk> chunks;
+		QuadId chunkQuadCount;
+		// the size of each chunk's data buffer
+		VkDeviceSize chunkDataSize;
+		// the last page of a chunk can be cut short
+		size_t chunkPageCount;
+		// the # of dirty bits set in every chunk
+		size_t dirtyPageCount;
+		// buffers of released chunks that may still be in use by the device
+		vector<RetiredChunk> retiredChunks;
+		// every frame fence passed to consumeUploadSemaphores
+		vector<VkFence> frameFences;
+		// Holds the indirect draw command of every chunk the pool can ever 
+		//	have, indexed by chunk.  Flushes keep it up to date with the # 
+		//	of quads each chunk draws, so recorded draws never go stale when
+		//	quads get added or removed.  It gets updated by the uploads, or
+		//	by issueUpdateCommands when the quad data is written in place.
+		GfxBuffer drawArgsBuffer;
+		// the draw commands of every chunk as of the last flush, which is
+		//	what drawArgsBuffer gets updated out of
+		vector<VkDrawIndexedIndirectCommand> drawArgs;
+		// VK_NULL_HANDLE until createCullPipeline
+		VkPipeline cullPipeline = VK_NULL_HANDLE;
+		VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout cullDescriptorSetLayout = VK_NULL_HANDLE;
+		// each one holds CULL_DESCRIPTOR_POOL_SET_COUNT chunks' sets
+		vector<VkDescriptorPool> cullDescriptorPools;
+		bool gpuCulling = false;
+		// set when chunk buffers are host visible device local memory, so
+		//	we can skip staging entirely
+		bool writeQuadDataInPlace = false;
+		// a frame that might still be drawing the quad data
+		struct InPlaceReader
+		{
+			VkFence fence;
+			// the # of quads at the start of each chunk the frame draws
+			vector<QuadId> chunkDrawQuadCounts;
+		};
+		// Producers write while only holding the pool's lock shared, so 
+		//	the readers have a lock of their own
+		vector<InPlaceReader> inPlaceReaders;
+		std::atomic<bool> inPlaceReadersPending;
+		std::mutex inPlaceReaderMutex;
+		// the chunks whose commands issueUpdateCommands still has to write
+		size_t drawArgsUpdateBegin = 0;
+		size_t drawArgsUpdateEnd = 0;
+		// Head & tail only ever grow, & are wrapped by stagingRingSize.  
+		//	Not created when writeQuadDataInPlace is set.
+		GfxBuffer stagingRing;
+		VkDeviceSize stagingRingSize;
+		VkDeviceSize stagingRingHead;
+		VkDeviceSize stagingRingTail;
+		// indices of the uploads still holding part of the ring, in the 
+		//	order they were submitted
+		vector<size_t> stagingRingUploads;
+		// the staging memory of the pool's own writes
+		StagingArena stagingArena;
+		// blocks handed out while the ring was full
+		vector<vector<Uint8>> stagingOverflowBlocks;
+		// guards the ring & stagingOverflowBlocks outside of flushes
+		std::mutex stagingBlockMutex;
+		std::atomic<Uint64> nextStagedRunSequence;
+		// what the last collectStagedRuns left for the uploads to copy
+		vector<StagedRun> stagedRuns;
+		// only used when drawMode is INDEXED
+		GfxBuffer quadIndexBuffer;
+		DrawMode drawMode;
+		VertexFormat vertexFormat;
+		// the # of vertices each quad takes up in the quad data buffer.
+		//	Not used by INSTANCED pools.
+		Uint8 storedVerticesPerQuad;
+		vector<QuadDataStream> quadDataStreams;
+		vector<VkVertexInputBindingDescription> vertexBindingDescriptions;
+		vector<VkVertexInputAttributeDescription> vertexAttributeDescriptions;
+		// the most slots quadSlots can ever grow to
+		size_t maxQuadCount;
+		// maxQuadId is used to determine how many quads in the buffer should 
+		//	be drawn by the chunks' draw commands.  Removed quads will 
+		//	still attempt to be drawn until compaction fills their slot, but
+		//	we can assume they are degenerate geometry.  This is to prevent
+		//	the need for having to initialize the entire quad data buffer to
+		//	degenerate geometry when the pool gets filled, which would 
+		//	probably take a long time if our pool size is large!
+		QuadId largestQuadCount;
+		// QuadIds are handles which map to the slot where the quad's data
+		//	lives, so that compaction can move the data around without the
+		//	caller noticing.  Both are always allocated lowest first, so a
+		//	pool that never removes anything has QuadIds equal to slots.
+		SlotAllocator quadIds;
+		vector<QuadSlot> quadIdSlots;
+		vector<QuadId> slotQuadIds;
+		SlotAllocator quadSlots;
+		// only the dst offset & size are filled in
+		vector<VkBufferCopy> dirtyRegions;
+		// the staging copies of a single upload.  Both of these are kept 
+		//	around between flushes so we don't have to re-allocate them.
+		vector<VkBufferCopy> bufferCopyRegions;
+		FlushStats lastFlushStats = {};
+		QuadId compactionMoveBudget = DEFAULT_COMPACTION_MOVE_BUDGET;
+		// the quad data buffer to quad data buffer copies of the moves made
+		//	by the last compactQuads, kept around for the same reason
+		vector<VkBufferCopy> compactionCopyRegions;
+		vector<Upload> uploads;
+		// Producers hold this shared while they write quad data
+		mutable std::shared_timed_mutex mutex;
+		// every Producer that exists, so flushes can merge them
+		vector<Producer*> producers;
+		// set by Producers when they leave something for the next flush
+		std::atomic<bool> producerChangesPending;
+		// Holds the streaming region of every frame, which starts with the
+		//	indirect draw command of each of its chunks, followed by the 
+		//	data of each chunk laid out the same as a Chunk's dataBuffer.
+		//	Streaming slots index the chunks of a region the same way quad 
+		//	slots index the pool's chunks.  Not created until 
+		//	createStreamingFrames.
+		GfxBuffer streamingBuffer;
+		uint32_t streamingFrameCount = 0;
+		size_t streamingChunkCount = 0;
+		// the offset of the first chunk within a region, and the distance 
+		//	between chunks & regions.  All of these are aligned so each 
+		//	chunk's data can be flushed on its own.
+		VkDeviceSize streamingChunksOffset = 0;
+		VkDeviceSize streamingChunkStride = 0;
+		VkDeviceSize streamingFrameSize = 0;
+		uint32_t streamingFrame = 0;
+		size_t streamingQuadCount = 0;
+		// the fence that has to be waited on before the current streaming 
+		//	frame's region gets written, or VK_NULL_HANDLE if it already was
+		VkFence streamingFrameFence = VK_NULL_HANDLE;
+	};
+	// Adds, updates & removes quads from a worker thread in parallel with 
+	//	other Producers, & leaves its changes for the next flush to merge.
+	//	A Producer & each quad must only be used by one thread at a time.
+	class QuadPool::Producer
+	{
+	public:
+		static const QuadId DEFAULT_RESERVATION_QUAD_COUNT;
+	public:
+		// pool has to outlive the Producer, which reserves quads from it
+		//	reservationQuadCount at a time
+		explicit Producer(QuadPool& pool, QuadId reservationQuadCount = 
+							DEFAULT_RESERVATION_QUAD_COUNT);
+		// hands the reserved quads that were never handed out back to the
+		//	pool
+		~Producer();
+		Producer(Producer const&) = delete;
+		Producer& operator=(Producer const&) = delete;
+		// These work the same as the QuadPool functions of the same name.
+		bool addQuads(size_t quadCount, QuadFiller const& fillQuad,
+					  vector<QuadId>* outQuadIds = nullptr);
+		bool addQuadInstances(size_t quadCount, 
+							  QuadInstanceFiller const& fillQuad,
+							  vector<QuadId>* outQuadIds = nullptr);
+		void updateQuadPositions(QuadId qid, glm::vec2 const* cornerPositions);
+		void updateQuadColors(QuadId qid, glm::vec4 const* cornerColors);
+		void updateQuadInstance(QuadId qid, QuadInstance const& instance);
+		// the QuadId & slot are only released by the next flush
+		void removeQuad(QuadId qid);
+	private:
+		// returns false if the pool doesn't have enough room left
+		bool reserveQuads(size_t quadCount);
+		// same as QuadPool::validateQuadId, except quads this Producer has
+		//	already removed are rejected too
+		bool validateQuadId(QuadId qid) const;
+		// same as QuadPool::stageQuadData for a single quad, except the 
+		//	pages get marked as dirty in dirtyPages
+		StagingWindow stageQuadData(QuadSlot slot, Uint8 dataBits);
+	private:
+		friend class QuadPool;
+		QuadPool& pool;
+		QuadId reservationQuadCount;
+		// handed out in order, starting at nextReservedQuad
+		vector<QuadId> reservedQuadIds;
+		size_t nextReservedQuad = 0;
+		// a bit for every page written since the last flush, indexed by 
+		//	QuadPool::getDirtyPageIndex
+		vector<Uint64> dirtyPages;
+		// unused when the quad data is written in place
+		StagingArena stagingArena;
+		// quads removed since the last flush
+		std::unordered_set<QuadId> removedQuadIds;
+	};
+}
@@ -0,0 +1,281 @@
+#include "RangeAllocator.h"
+const k10::RangeAllocator::RangeId k10::RangeAllocator::INVALID_RANGE =
+	numeric_limits<k10::RangeAllocator::RangeId>::max();
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+void k10::RangeAllocator::reset(VkDeviceSize sz)
+{
+	ranges.clear();
+	unusedRanges = INVALID_RANGE;
+	firstLevelBitmap = 0;
+	for (Uint8 fl = 0; fl < FIRST_LEVEL_COUNT; fl++)
+	{
+		secondLevelBitmaps[fl] = 0;
+		for (Uint8 sl = 0; sl < SECOND_LEVEL_COUNT; sl++)
+		{
+			freeLists[fl][sl] = INVALID_RANGE;
+		}
+	}
+	size = sz;
+	allocatedSize = 0;
+	allocatedRangeCount = 0;
+	freeRangeCount = 0;
+	if (size > 0)
+	{
+		const RangeId rid = newRange();
+		ranges[rid].offset = 0;
+		ranges[rid].size = size;
+		insertFree(rid);
+	}
+}
+k10::RangeAllocator::RangeId k10::RangeAllocator::allocate(
+	VkDeviceSize sz, VkDeviceSize alignment)
+{
+	SDL_assert(sz > 0);
+	SDL_assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+	const VkDeviceSize searchSize = sz + alignment - 1;
+	auto fits = [&](RangeId rid)->bool
+	{
+		Range const& r = ranges[rid];
+		return alignUp(r.offset, alignment) + sz <= r.offset + r.size;
+	};
+	// any range in a bin that starts past the worst case alignment padding
+	//	fits, so that's the fast path.  Otherwise the bin that sz itself
+	//	maps to might still have a range that happens to fit, which matters
+	//	when the request is about as big as the biggest free range //
+	RangeId rid = findFreeRange(findBinAtLeast(searchSize));
+	if (rid == INVALID_RANGE)
+	{
+		const BinIndex bi = findBin(sz);
+		for (rid = freeLists[bi.firstLevel][bi.secondLevel];
+			 rid != INVALID_RANGE && !fits(rid);
+			 rid = ranges[rid].nextFree);
+		if (rid == INVALID_RANGE)
+		{
+			return INVALID_RANGE;
+		}
+	}
+	SDL_assert(fits(rid));
+	removeFree(rid);
+	// give the alignment padding at the front & whatever is left at the end
+	//	back to the free lists.  Neither can be merged with anything since
+	//	free ranges never sit next to each other //
+	const VkDeviceSize padding =
+		alignUp(ranges[rid].offset, alignment) - ranges[rid].offset;
+	if (padding > 0)
+	{
+		const RangeId alignedRid = splitTail(rid, padding);
+		insertFree(rid);
+		rid = alignedRid;
+	}
+	if (ranges[rid].size > sz)
+	{
+		insertFree(splitTail(rid, sz));
+	}
+	ranges[rid].free = false;
+	allocatedSize += sz;
+	allocatedRangeCount++;
+	return rid;
+}
+void k10::RangeAllocator::release(RangeId rid)
+{
+	SDL_assert(rid < ranges.size() && !ranges[rid].free);
+	ranges[rid].free = true;
+	allocatedSize -= ranges[rid].size;
+	allocatedRangeCount--;
+	const RangeId next = ranges[rid].nextPhysical;
+	if (next != INVALID_RANGE && ranges[next].free)
+	{
+		removeFree(next);
+		mergeIntoPrev(next);
+	}
+	const RangeId prev = ranges[rid].prevPhysical;
+	if (prev != INVALID_RANGE && ranges[prev].free)
+	{
+		removeFree(prev);
+		rid = mergeIntoPrev(rid);
+	}
+	insertFree(rid);
+}
+VkDeviceSize k10::RangeAllocator::getOffset(RangeId rid) const
+{
+	SDL_assert(rid < ranges.size() && !ranges[rid].free);
+	return ranges[rid].offset;
+}
+VkDeviceSize k10::RangeAllocator::getSize() const
+{
+	return size;
+}
+VkDeviceSize k10::RangeAllocator::getAllocatedSize() const
+{
+	return allocatedSize;
+}
+size_t k10::RangeAllocator::getAllocatedRangeCount() const
+{
+	return allocatedRangeCount;
+}
+size_t k10::RangeAllocator::getFreeRangeCount() const
+{
+	return freeRangeCount;
+}
+VkDeviceSize k10::RangeAllocator::getLargestFreeRangeSize() const
+{
+	if (firstLevelBitmap == 0)
+	{
+		return 0;
+	}
+	const Uint8 fl = highestSetBit(firstLevelBitmap);
+	const Uint8 sl = highestSetBit(secondLevelBitmaps[fl]);
+	VkDeviceSize retVal = 0;
+	for (RangeId rid = freeLists[fl][sl]; rid != INVALID_RANGE;
+		 rid = ranges[rid].nextFree)
+	{
+		retVal = std::max(retVal, ranges[rid].size);
+	}
+	return retVal;
+}
+k10::RangeAllocator::BinIndex k10::RangeAllocator::findBin(VkDeviceSize sz)
+{
+	// sizes smaller than the second level count all share first level 0,
+	//	with one bin per size //
+	if (sz < SECOND_LEVEL_COUNT)
+	{
+		return { 0, static_cast<Uint8>(sz) };
+	}
+	const Uint8 msb = highestSetBit(sz);
+	return { static_cast<Uint8>(msb - SECOND_LEVEL_BITS + 1),
+			 static_cast<Uint8>((sz >> (msb - SECOND_LEVEL_BITS)) -
+								SECOND_LEVEL_COUNT) };
+}
+k10::RangeAllocator::BinIndex k10::RangeAllocator::findBinAtLeast(
+	VkDeviceSize sz)
+{
+	// round sz up to the start of the next bin, unless it's already there
+	if (sz >= SECOND_LEVEL_COUNT)
+	{
+		const VkDeviceSize binSize =
+			VkDeviceSize(1) << (highestSetBit(sz) - SECOND_LEVEL_BITS);
+		sz = sz + binSize - 1 >= sz ?
+			sz + binSize - 1 : numeric_limits<VkDeviceSize>::max();
+	}
+	return findBin(sz);
+}
+k10::RangeAllocator::RangeId k10::RangeAllocator::findFreeRange(
+	BinIndex bi) const
+{
+	const Uint32 secondLevelMap = secondLevelBitmaps[bi.firstLevel] &
+		(numeric_limits<Uint32>::max() << bi.secondLevel);
+	if (secondLevelMap != 0)
+	{
+		return freeLists[bi.firstLevel][lowestSetBit(secondLevelMap)];
+	}
+	const Uint64 firstLevelMap = firstLevelBitmap &
+		(numeric_limits<Uint64>::max() << (bi.firstLevel + 1));
+	if (firstLevelMap == 0)
+	{
+		return INVALID_RANGE;
+	}
+	const Uint8 fl = lowestSetBit(firstLevelMap);
+	return freeLists[fl][lowestSetBit(secondLevelBitmaps[fl])];
+}
+k10::RangeAllocator::RangeId k10::RangeAllocator::newRange()
+{
+	RangeId rid = unusedRanges;
+	if (rid == INVALID_RANGE)
+	{
+		rid = static_cast<RangeId>(ranges.size());
+		ranges.push_back({});
+	}
+	else
+	{
+		unusedRanges = ranges[rid].nextFree;
+	}
+	ranges[rid] = { 0, 0, INVALID_RANGE, INVALID_RANGE,
+					INVALID_RANGE, INVALID_RANGE, true };
+	return rid;
+}
+void k10::RangeAllocator::deleteRange(RangeId rid)
+{
+	ranges[rid].nextFree = unusedRanges;
+	unusedRanges = rid;
+}
+void k10::RangeAllocator::insertFree(RangeId rid)
+{
+	Range& r = ranges[rid];
+	SDL_assert(r.free);
+	const BinIndex bi = findBin(r.size);
+	RangeId& head = freeLists[bi.firstLevel][bi.secondLevel];
+	r.prevFree = INVALID_RANGE;
+	r.nextFree = head;
+	if (head != INVALID_RANGE)
+	{
+		ranges[head].prevFree = rid;
+	}
+	head = rid;
+	secondLevelBitmaps[bi.firstLevel] |= Uint32(1) << bi.secondLevel;
+	firstLevelBitmap |= Uint64(1) << bi.firstLevel;
+	freeRangeCount++;
+}
+void k10::RangeAllocator::removeFree(RangeId rid)
+{
+	Range& r = ranges[rid];
+	SDL_assert(r.free);
+	const BinIndex bi = findBin(r.size);
+	if (r.prevFree != INVALID_RANGE)
+	{
+		ranges[r.prevFree].nextFree = r.nextFree;
+	}
+	else
+	{
+		freeLists[bi.firstLevel][bi.secondLevel] = r.nextFree;
+	}
+	if (r.nextFree != INVALID_RANGE)
+	{
+		ranges[r.nextFree].prevFree = r.prevFree;
+	}
+	if (freeLists[bi.firstLevel][bi.secondLevel] == INVALID_RANGE)
+	{
+		secondLevelBitmaps[bi.firstLevel] &= ~(Uint32(1) << bi.secondLevel);
+		if (secondLevelBitmaps[bi.firstLevel] == 0)
+		{
+			firstLevelBitmap &= ~(Uint64(1) << bi.firstLevel);
+		}
+	}
+	freeRangeCount--;
+}
+k10::RangeAllocator::RangeId k10::RangeAllocator::splitTail(
+	RangeId rid, VkDeviceSize sz)
+{
+	SDL_assert(sz < ranges[rid].size);
+	// newRange can grow the ranges vector, so grab it before any refs //
+	const RangeId tail = newRange();
+	Range& r = ranges[rid];
+	Range& t = ranges[tail];
+	t.offset = r.offset + sz;
+	t.size = r.size - sz;
+	t.prevPhysical = rid;
+	t.nextPhysical = r.nextPhysical;
+	if (r.nextPhysical != INVALID_RANGE)
+	{
+		ranges[r.nextPhysical].prevPhysical = tail;
+	}
+	r.nextPhysical = tail;
+	r.size = sz;
+	return tail;
+}
+k10::RangeAllocator::RangeId k10::RangeAllocator::mergeIntoPrev(RangeId rid)
+{
+	Range& r = ranges[rid];
+	const RangeId prev = r.prevPhysical;
+	SDL_assert(prev != INVALID_RANGE);
+	ranges[prev].size += r.size;
+	ranges[prev].nextPhysical = r.nextPhysical;
+	if (r.nextPhysical != INVALID_RANGE)
+	{
+		ranges[r.nextPhysical].prevPhysical = prev;
+	}
+	deleteRange(rid);
+	return prev;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+namespace k10
+{
+	// Hands out aligned sub-ranges of a fixed-size address range using a
+	//	two-level segregated fit (TLSF) scheme.  Free ranges are binned by
+	//	size into a power of 2 first level, which is split linearly into
+	//	SECOND_LEVEL_COUNT second level bins.  A bitmap per level tracks
+	//	which bins have free ranges, so both allocate & release are O(1).
+	// Released ranges are merged with any free neighbors right away.
+	// Nothing here touches the address range itself, so it can manage
+	//	anything addressed by offset (device memory blocks for example).
+	class RangeAllocator
+	{
+	public:
+		using RangeId = uint32_t;
+		static const RangeId INVALID_RANGE;
+	public:
+		void reset(VkDeviceSize size);
+		// alignment must be a power of 2.
+		// Returns INVALID_RANGE if there is no free range big enough.
+		RangeId allocate(VkDeviceSize size, VkDeviceSize alignment);
+		void release(RangeId rid);
+		VkDeviceSize getOffset(RangeId rid) const;
+		VkDeviceSize getSize() const;
+		VkDeviceSize getAllocatedSize() const;
+		size_t getAllocatedRangeCount() const;
+		size_t getFreeRangeCount() const;
+		// O(# of free ranges in the largest non-empty bin)
+		VkDeviceSize getLargestFreeRangeSize() const;
+	private:
+		static const Uint8 SECOND_LEVEL_BITS = 4;
+		static const Uint8 SECOND_LEVEL_COUNT = 1 << SECOND_LEVEL_BITS;
+		static const Uint8 FIRST_LEVEL_COUNT = 64 - SECOND_LEVEL_BITS + 1;
+		struct Range
+		{
+			VkDeviceSize offset;
+			VkDeviceSize size;
+			// neighbors in the address range, or INVALID_RANGE at the ends
+			RangeId prevPhysical;
+			RangeId nextPhysical;
+			// neighbors in the bin's free list if this range is free,
+			//	otherwise nextFree links unused Range records together
+			RangeId prevFree;
+			RangeId nextFree;
+			bool free;
+		};
+		struct BinIndex
+		{
+			Uint8 firstLevel;
+			Uint8 secondLevel;
+		};
+	private:
+		// checks the bins directly
+		friend bool testRangeAllocator();
+		// the bin that a free range of exactly size bytes belongs in
+		static BinIndex findBin(VkDeviceSize size);
+		// the first bin where every free range is at least size bytes
+		static BinIndex findBinAtLeast(VkDeviceSize size);
+		// Returns INVALID_RANGE if every bin at or past bi is empty.
+		RangeId findFreeRange(BinIndex bi) const;
+		RangeId newRange();
+		void deleteRange(RangeId rid);
+		void insertFree(RangeId rid);
+		void removeFree(RangeId rid);
+		// shrinks rid to size bytes & returns the left over tail as a new
+		//	range, which isn't in any free list yet
+		RangeId splitTail(RangeId rid, VkDeviceSize size);
+		// merges rid into the range right before it in the address range &
+		//	returns the range they were merged into
+		RangeId mergeIntoPrev(RangeId rid);
+	private:
+		vector<Range> ranges;
+		// head of the list of Range records that can be re-used
+		RangeId unusedRanges = INVALID_RANGE;
+		Uint64 firstLevelBitmap = 0;
+		Uint32 secondLevelBitmaps[FIRST_LEVEL_COUNT] = {};
+		RangeId freeLists[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];
+		VkDeviceSize size = 0;
+		VkDeviceSize allocatedSize = 0;
+		size_t allocatedRangeCount = 0;
+		size_t freeRangeCount = 0;
+	};
+}
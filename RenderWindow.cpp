@@ -1,1246 +1,2121 @@
-#include "RenderWindow.h"
-const int k10::RenderWindow::MAX_FRAMES_IN_FLIGHT = 2;
-bool k10::RenderWindow::QueueFamilyIndices::isSuitable() const
-{
-	return graphicsFamily != std::numeric_limits<uint64_t>::max() &&
-		   presentFamily  != std::numeric_limits<uint64_t>::max();
-}
-k10::RenderWindow* k10::RenderWindow::createRenderWindow(
-	char const* title, int initialWidth, int initialHeight)
-{
-	RenderWindow* retVal = new RenderWindow;
-	// Create the SDL Window //
-	retVal->window = SDL_CreateWindow(title,
-									  SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-									  initialWidth, initialHeight,
-									  SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
-	if (!retVal->window)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to create window! error='%s'\n", SDL_GetError());
-		delete retVal;
-		return nullptr;
-	}
-	// Get list of required Vulkan extensions we need Vulkan instance for the SDL window //
-	vector<char const*> requiredExtensionNames;
-	{
-		uint32_t extensionCount;
-		if (!SDL_Vulkan_GetInstanceExtensions(retVal->window, &extensionCount, nullptr))
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to get required Vulkan extension count! error='%s'\n", SDL_GetError());
-			delete retVal;
-			return nullptr;
-		}
-		requiredExtensionNames.resize(extensionCount);
-		if(!SDL_Vulkan_GetInstanceExtensions(
-			retVal->window, &extensionCount, requiredExtensionNames.data()))
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to get required Vulkan extension names! error='%s'\n", SDL_GetError());
-			delete retVal;
-			return nullptr;
-		}
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-		requiredExtensionNames.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-#endif
-		SDL_Log("We require %i Vulkan extensions to run!\n", 
-			requiredExtensionNames.size());
-		for (size_t e = 0; e < requiredExtensionNames.size(); e++)
-		{
-			char const* name = requiredExtensionNames[e];
-			SDL_Log("\t'%s'\n", name);
-		}
-	}
-	// get a list of supported Vulkan extensions //
-	vector<VkExtensionProperties> extensionProperties;
-	{
-		uint32_t extensionCount;
-		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
-		extensionProperties.resize(extensionCount);
-		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensionProperties.data());
-		SDL_Log("Available Vulkan instance extensions:\n");
-		for (auto const& ep : extensionProperties)
-		{
-			SDL_Log("\t'%s' (version %i)\n", ep.extensionName, ep.specVersion);
-		}
-		for (char const* const ren : requiredExtensionNames)
-		{
-			bool requirementSatisfied = false;
-			for (auto const& ep : extensionProperties)
-			{
-				if (strcmp(ep.extensionName, ren) == 0)
-				{
-					requirementSatisfied = true;
-					break;
-				}
-			}
-			if (!requirementSatisfied)
-			{
-				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-					"Could not satisfy vulkan extension requirement! extension='%s'\n", ren);
-				delete retVal;
-				return nullptr;
-			}
-		}
-	}
-	const vector<char const*> requiredLayers = {
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-		"VK_LAYER_KHRONOS_validation"
-#endif
-	};
-	if (requiredLayers.empty())
-	{
-		SDL_Log("No Vulkan instance layers required!\n");
-	}
-	else
-	{
-		SDL_Log("Required Vulkan instance layers:\n");
-		for (char const* const rl : requiredLayers)
-		{
-			SDL_Log("\t'%s'\n", rl);
-		}
-	}
-	// Get a list of all available layers //
-	vector<VkLayerProperties> layerProperties;
-	{
-		uint32_t layerCount;
-		vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
-		layerProperties.resize(layerCount);
-		vkEnumerateInstanceLayerProperties(&layerCount, layerProperties.data());
-		SDL_Log("Available Vulkan instance layers:\n");
-		for (auto const& lp : layerProperties)
-		{
-			SDL_Log("\t'%s' (version %i)\n", lp.layerName, lp.implementationVersion);
-		}
-		for (char const* const rl : requiredLayers)
-		{
-			bool requirementSatisfied = false;
-			for (auto const& lp : layerProperties)
-			{
-				if (strcmp(lp.layerName, rl) == 0)
-				{
-					requirementSatisfied = true;
-					break;
-				}
-			}
-			if (!requirementSatisfied)
-			{
-				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-					"Could not satisfy vulkan layer requirement! layer='%s'\n", rl);
-				delete retVal;
-				return nullptr;
-			}
-		}
-	}
-	// create Vulkan instance //
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-	const VkDebugUtilsMessengerCreateInfoEXT debugUtilsMessengerCreateInfo = {
-		VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
-		nullptr,// pNext
-		0,// flags
-		VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT,
-		VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
-		vulkanDebugMessengerCallback,
-		nullptr // userData
-	};
-#endif
-	{
-		VkApplicationInfo appInfo = {
-			VK_STRUCTURE_TYPE_APPLICATION_INFO,
-			nullptr,// pNext
-			title,
-			VK_MAKE_VERSION(1,0,0),
-			"K10",
-			VK_MAKE_VERSION(1,0,0),
-			VK_API_VERSION_1_0
-		};
-		VkInstanceCreateInfo createInfo = {
-			VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-			(VkDebugUtilsMessengerCreateInfoEXT*)& debugUtilsMessengerCreateInfo,
-#else
-			nullptr,// pNext
-#endif
-			0,// flags
-			&appInfo,
-			static_cast<uint32_t>(requiredLayers.size()),
-			requiredLayers.data(),
-			static_cast<uint32_t>(requiredExtensionNames.size()),
-			requiredExtensionNames.data()
-		};
-		const VkResult result = 
-			vkCreateInstance(&createInfo, nullptr, &retVal->instance);
-		if (result != VK_SUCCESS)
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to create Vulkan instance!\n");
-			delete retVal;
-			return nullptr;
-		}
-	}
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-	// Setup a handler for debug messages from the validation layer 
-	//	so we can choose which get displayed //
-	{
-		PFN_vkCreateDebugUtilsMessengerEXT createDebugUtilsMessengerEXT;
-		createDebugUtilsMessengerEXT = (PFN_vkCreateDebugUtilsMessengerEXT)
-			vkGetInstanceProcAddr(retVal->instance, "vkCreateDebugUtilsMessengerEXT");
-		if (createDebugUtilsMessengerEXT)
-		{
-			if (createDebugUtilsMessengerEXT(
-					retVal->instance, &debugUtilsMessengerCreateInfo, 
-					nullptr, &retVal->debugMessenger) != VK_SUCCESS)
-			{
-				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-					"Failed to create Vulkan Debug Utils Messanger!\n");
-				delete retVal;
-				return nullptr;
-			}
-		}
-		else
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to find vkCreateDebugUtilsMessengerEXT!\n");
-			delete retVal;
-			return nullptr;
-		}
-	}
-#endif
-	if (!SDL_Vulkan_CreateSurface(retVal->window, 
-								  retVal->instance, 
-								  &retVal->surface))
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to create Vulkan window surface!\n");
-		delete retVal;
-		return nullptr;
-	}
-	// Choose physical device to Vulkan on //
-	const vector<const char*> requiredPhysicalDeviceExtensions = {
-		VK_KHR_SWAPCHAIN_EXTENSION_NAME
-	};
-	{
-		auto isPhysicalDeviceSuitable = 
-			[retVal, &requiredPhysicalDeviceExtensions](VkPhysicalDevice pd)->bool
-		{
-			//VkPhysicalDeviceProperties deviceProperties;
-			//VkPhysicalDeviceFeatures   deviceFeatures;
-			//vkGetPhysicalDeviceProperties(pd, &deviceProperties);
-			//vkGetPhysicalDeviceFeatures  (pd, &deviceFeatures);
-			//return deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
-			QueueFamilyIndices qfi = retVal->findQueueFamilies(pd);
-			if (!qfi.isSuitable())
-			{
-				return false;
-			}
-			const bool extensionsSupported =
-				checkPhysicalDeviceExtensionSupport(
-					pd, requiredPhysicalDeviceExtensions);
-			if (!extensionsSupported)
-			{
-				return false;
-			}
-			SwapChainSupportDetails swapChainSupport =
-				retVal->querySwapChainSupport(pd);
-			if (swapChainSupport.formats.empty() ||
-				swapChainSupport.presentModes.empty())
-			{
-				return false;
-			}
-			return true;
-		};
-		uint32_t deviceCount;
-		vkEnumeratePhysicalDevices(retVal->instance, &deviceCount, nullptr);
-		if (deviceCount <= 0)
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to find physical device with Vulkan support!\n");
-			delete retVal;
-			return nullptr;
-		}
-		vector<VkPhysicalDevice> physicalDevices(deviceCount);
-		vkEnumeratePhysicalDevices(retVal->instance, &deviceCount, physicalDevices.data());
-		SDL_Log("System has %i physical devices with Vulkan support:\n", physicalDevices.size());
-		for (VkPhysicalDevice const& pd : physicalDevices)
-		{
-			VkPhysicalDeviceProperties deviceProperties;
-			vkGetPhysicalDeviceProperties(pd, &deviceProperties);
-			SDL_Log("\t'%s'\n", deviceProperties.deviceName);
-		}
-		for (VkPhysicalDevice const& pd : physicalDevices)
-		{
-			if (isPhysicalDeviceSuitable(pd))
-			{
-				retVal->physicalDevice = pd;
-				break;
-			}
-		}
-		if (retVal->physicalDevice == VK_NULL_HANDLE)
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to find a suitable physical device!\n");
-			delete retVal;
-			return nullptr;
-		}
-	}
-	// Create a logical device to Vulkan on //
-	{
-		const QueueFamilyIndices qfi = 
-			retVal->findQueueFamilies(retVal->physicalDevice);
-		float queuePriority = 1.f;
-		const vector<uint32_t> qfiValues = qfi.toVkVector();
-		vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-		for (size_t i = 0; i < qfiValues.size(); i++)
-		{
-			bool infoExists = false;
-			for (size_t j = 0; j < i; j++)
-			{
-				// check if we've visited this raw value yet...
-				if (qfiValues[j] == qfiValues[i])
-				{
-					infoExists = true;
-					break;
-				}
-			}
-			if (infoExists)
-			{
-				continue;
-			}
-			VkDeviceQueueCreateInfo queueCreateInfo = {
-				VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-				nullptr,// pNext
-				0,// flags
-				qfiValues[i],
-				1,
-				&queuePriority
-			};
-			queueCreateInfos.push_back(queueCreateInfo);
-		}
-		VkPhysicalDeviceFeatures deviceFeatures = {
-		};
-		VkDeviceCreateInfo createInfo = {
-			VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-			nullptr,// pNext
-			0,// flags
-			static_cast<uint32_t>(queueCreateInfos.size()),
-			queueCreateInfos.data(),
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-			static_cast<uint32_t>(requiredLayers.size()),
-			requiredLayers.data(),
-#else
-			0,
-			nullptr,
-#endif
-			static_cast<uint32_t>(requiredPhysicalDeviceExtensions.size()),
-			requiredPhysicalDeviceExtensions.data(),
-			&deviceFeatures
-		};
-		if (vkCreateDevice(retVal->physicalDevice, &createInfo, 
-						   nullptr, &retVal->device) != VK_SUCCESS)
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to create Vulkan logical device!\n");
-			delete retVal;
-			return nullptr;
-		}
-		vkGetDeviceQueue(retVal->device, 
-						 static_cast<uint32_t>(qfi.graphicsFamily),
-						 0, &retVal->graphicsQueue);
-		vkGetDeviceQueue(retVal->device, 
-						 static_cast<uint32_t>(qfi.presentFamily), 
-						 0, &retVal->presentQueue);
-	}
-	if (!retVal->createSwapChain())
-	{
-		delete retVal;
-		return nullptr;
-	}
-	if(!retVal->createImageViews())
-	{
-		delete retVal;
-		return nullptr;
-	}
-	if(!retVal->createRenderPass())
-	{
-		delete retVal;
-		return nullptr;
-	}
-	if(!retVal->createFramebuffers())
-	{
-		delete retVal;
-		return nullptr;
-	}
-	// Create Vulkan command pool //
-	{
-		QueueFamilyIndices queueFamilyIndices = 
-			retVal->findQueueFamilies(retVal->physicalDevice);
-		VkCommandPoolCreateInfo poolCreateInfo = {
-			VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-			nullptr,// pNext
-			///TODO: give memory allocation hint via flags for how often the
-			///	command buffers need to be re-recorded
-			0,// flags
-			static_cast<uint32_t>(queueFamilyIndices.graphicsFamily)
-		};
-		if (vkCreateCommandPool(retVal->device,
-								&poolCreateInfo,
-								nullptr,
-								&retVal->commandPool) != VK_SUCCESS)
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to create Vulkan command pool!\n");
-			delete retVal;
-			return nullptr;
-		}
-	}
-	if(!retVal->createCommandBuffers())
-	{
-		delete retVal;
-		return nullptr;
-	}
-	// create drawing synchronization tools //
-	{
-		const VkSemaphoreCreateInfo semaphoreCreateInfo = {
-			VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-			nullptr,// pNext
-			0 // flags
-		};
-		const VkFenceCreateInfo fenceCreateInfo = {
-			VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-			nullptr,// pNext
-			VK_FENCE_CREATE_SIGNALED_BIT // flags
-		};
-		retVal->imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		retVal->renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		retVal->frameFences.resize(MAX_FRAMES_IN_FLIGHT);
-		for (size_t f = 0; f < MAX_FRAMES_IN_FLIGHT; f++)
-		{
-			if (vkCreateSemaphore(retVal->device,
-								  &semaphoreCreateInfo,
-								  nullptr,
-								  &retVal->imageAvailableSemaphores[f]) != VK_SUCCESS)
-			{
-				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-					"Failed to allocate Vulkan semaphore!\n");
-				delete retVal;
-				return nullptr;
-			}
-			if (vkCreateSemaphore(retVal->device,
-								  &semaphoreCreateInfo,
-								  nullptr,
-								  &retVal->renderFinishedSemaphores[f]) != VK_SUCCESS)
-			{
-				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-					"Failed to allocate Vulkan semaphore!\n");
-				delete retVal;
-				return nullptr;
-			}
-			if (vkCreateFence(retVal->device,
-							  &fenceCreateInfo,
-							  nullptr,
-							  &retVal->frameFences[f]) != VK_SUCCESS)
-			{
-				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-					"Failed to allocate Vulkan frame fence!\n");
-				delete retVal;
-				return nullptr;
-			}
-		}
-	}
-	// Create Vertex Buffer //
-	{
-		const vector<k10::Vertex> vertices = {
-			{{-0.5f,  0.5f}, {1.f, 1.f, 0.f, 1.f}},
-			{{-0.5f, -0.5f}, {1.f, 0.f, 0.f, 1.f}},
-			{{ 0.5f,  0.5f}, {0.f, 0.f, 1.f, 1.f}},
-			{{ 0.5f, -0.5f}, {0.f, 1.f, 0.f, 1.f}}
-		};
-		retVal->vertexBufferCount = static_cast<uint32_t>(vertices.size());
-		const VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-		if (!retVal->vertexBuffer.createBuffer(retVal->device, 
-											   retVal->physicalDevice,
-											   bufferSize,
-											   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-											   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | 
-													VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to create vertexBuffer!\n");
-			delete retVal;
-			return nullptr;
-		}
-		void* data = nullptr;
-		retVal->vertexBuffer.mapMemory(&data, 0, bufferSize);
-		memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-		retVal->vertexBuffer.unmapMemory();
-	}
-	if (!retVal->quadPool.fillPool(retVal->device, retVal->physicalDevice,
-								   retVal->commandPool,
-								   static_cast<size_t>(1e6)))
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to fill quad pool!\n");
-		delete retVal;
-		return nullptr;
-	}
-	return retVal;
-}
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-VKAPI_ATTR VkBool32 VKAPI_CALL k10::RenderWindow::vulkanDebugMessengerCallback(
-	VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-	VkDebugUtilsMessageTypeFlagsEXT messageType,
-	const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
-	void* pUserData)
-{
-	if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO, "validation layer ERROR='%s'\n",
-			pCallbackData->pMessage);
-		SDL_assert(false);
-	}
-	else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
-	{
-		SDL_LogWarn(SDL_LOG_CATEGORY_VIDEO, "validation layer WARNING='%s'\n",
-			pCallbackData->pMessage);
-		SDL_assert(false);
-	}
-#ifdef K10_VULKAN_DEBUG_VERBOSE
-	else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT)
-	{
-		SDL_LogInfo(SDL_LOG_CATEGORY_VIDEO,
-			"validation layer INFO='%s'\n", pCallbackData->pMessage);
-	}
-	else //if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT)
-	{
-		SDL_LogVerbose(SDL_LOG_CATEGORY_VIDEO,
-			"validation layer VERBOSE='%s'\n", pCallbackData->pMessage);
-	}
-#endif
-	return VK_FALSE;
-}
-#endif
-bool k10::RenderWindow::checkPhysicalDeviceExtensionSupport(
-	VkPhysicalDevice pd, vector<char const*>const& requiredExtensionNames)
-{
-	uint32_t extensionCount;
-	vkEnumerateDeviceExtensionProperties(pd, nullptr, &extensionCount, nullptr);
-	vector<VkExtensionProperties> availableExtensions(extensionCount);
-	vkEnumerateDeviceExtensionProperties(pd, nullptr, &extensionCount, availableExtensions.data());
-	SDL_Log("physical device available extensions:\n");
-	for (VkExtensionProperties const& ep : availableExtensions)
-	{
-		SDL_Log("\t'%s' (version %i)\n", ep.extensionName, ep.specVersion);
-	}
-	for (char const* const ren : requiredExtensionNames)
-	{
-		bool isAvailable = false;
-		for (VkExtensionProperties const& ep : availableExtensions)
-		{
-			if (strcmp(ep.extensionName, ren) == 0)
-			{
-				isAvailable = true;
-				break;
-			}
-		}
-		if (!isAvailable)
-		{
-			return false;
-		}
-	}
-	return true;
-}
-///void k10::RenderWindow::destroyRenderWindow(RenderWindow* rw)
-///{
-///	delete rw;
-///}
-k10::RenderWindow::~RenderWindow()
-{
-	quadPool.drainPool();
-	vertexBuffer.destroyBuffer();
-	cleanupSwapChain();
-	for (size_t f = 0; f < MAX_FRAMES_IN_FLIGHT; f++)
-	{
-		vkDestroySemaphore(device, renderFinishedSemaphores[f], nullptr);
-		vkDestroySemaphore(device, imageAvailableSemaphores[f], nullptr);
-		vkDestroyFence(device, frameFences[f], nullptr);
-	}
-	vkDestroyCommandPool(device, commandPool, nullptr);
-	vkDestroyDevice(device, nullptr);
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-	PFN_vkDestroyDebugUtilsMessengerEXT destroyDebugUtilsMessengerEXT;
-	destroyDebugUtilsMessengerEXT = (PFN_vkDestroyDebugUtilsMessengerEXT)
-		vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
-	if (destroyDebugUtilsMessengerEXT)
-	{
-		destroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
-	}
-	else
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO, 
-			"Failed to obtain vkDestroyDebugUtilsMessengerEXT!\n");
-		SDL_assert(false);
-	}
-#endif
-	vkDestroySurfaceKHR(instance, surface, nullptr);
-	vkDestroyInstance(instance, nullptr);
-	SDL_DestroyWindow(window);
-}
-bool k10::RenderWindow::recordCommandBuffers(GfxPipelineIndex gpi)
-{
-	if (quadPool.flushRequired())
-	{
-		quadPool.flushVertexStaging(graphicsQueue);
-	}
-	gpiRecordedCommandBuffer = gpi;
-	GfxPipeline const*const pipeline = findGfxPipeline(gpi);
-	SDL_assert(pipeline);
-	for (size_t c = 0; c < commandBuffers.size(); c++)
-	{
-		VkCommandBufferBeginInfo beginInfo = {
-			VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-			nullptr,// pNext
-			///TODO: use flags for re-recorded command buffers
-			0,// flags
-			nullptr // inheritanceInfo
-		};
-		if (vkBeginCommandBuffer(commandBuffers[c], 
-								 &beginInfo) != VK_SUCCESS)
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to begin recording Vulkan command buffer!\n");
-			return false;
-		}
-		// render pass definition //
-		{
-			VkClearValue renderPassClearValue = { 0.f, 0.f, 0.f, 1.f };
-			VkRenderPassBeginInfo renderPassInfo = {
-				VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-				nullptr,// pNext
-				renderPass,
-				swapChainFramebuffers[c],
-				VkRect2D{ {0, 0}, swapChainExtent},
-				1,// clear value count
-				&renderPassClearValue
-			};
-			vkCmdBeginRenderPass(commandBuffers[c], 
-								 &renderPassInfo, 
-								 VK_SUBPASS_CONTENTS_INLINE);
-			vkCmdBindPipeline(commandBuffers[c],
-				VK_PIPELINE_BIND_POINT_GRAPHICS,
-				pipeline->getPipeline());
-			quadPool.issueCommands(commandBuffers[c]);
-///			VkBuffer vertexBuffers[] = { vertexBuffer.getBuffer() };
-///			VkDeviceSize vbOffsets[] = { 0 };
-///			vkCmdBindVertexBuffers(commandBuffers[c], 0, 1, vertexBuffers, vbOffsets);
-///			vkCmdDraw(commandBuffers[c], vertexBufferCount, 1, 0, 0);
-			vkCmdEndRenderPass(commandBuffers[c]);
-		}
-		if (vkEndCommandBuffer(commandBuffers[c]) != VK_SUCCESS)
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed Vulkan command buffer recording failure!\n");
-			return false;
-		}
-	}
-	return true;
-}
-bool k10::RenderWindow::drawFrame()
-{
-	if (windowMinimized)
-	{
-		return true;
-	}
-	vkWaitForFences(device, 1, &frameFences[currentFrame], VK_TRUE, UINT64_MAX);
-	if (quadPool.flushRequired())
-	{
-		vkFreeCommandBuffers(device, commandPool,
-			static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
-		if (!createCommandBuffers())
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to re-create render pass command buffer!\n");
-			return false;
-		}
-		if (!recordCommandBuffers(gpiRecordedCommandBuffer))
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to re-record render pass command buffer!\n");
-			return false;
-		}
-	}
-	// aquire the next image in the swapchain //
-	uint32_t imageIndex;
-	const VkResult resultAcquireNextImage =
-		vkAcquireNextImageKHR(device, 
-							  swapChain, 
-							  UINT64_MAX, 
-							  imageAvailableSemaphores[currentFrame],
-							  VK_NULL_HANDLE, 
-							  &imageIndex);
-	if (resultAcquireNextImage == VK_ERROR_OUT_OF_DATE_KHR)
-	{
-		return rebuildSwapChain();
-	}
-	else if (resultAcquireNextImage != VK_SUCCESS && 
-			 resultAcquireNextImage != VK_SUBOPTIMAL_KHR)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed acquire next image!\n");
-		return false;
-	}
-	// submit command buffers to operate on this image //
-	VkSemaphore waitSemaphores[]   = { imageAvailableSemaphores[currentFrame] };
-	VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
-	VkPipelineStageFlags waitStages[] = { 
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	VkSubmitInfo submitInfo = {
-		VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		nullptr,// pNext
-		1,// wait semaphore count
-		waitSemaphores,
-		waitStages,
-		1,// command buffer count
-		&commandBuffers[imageIndex],
-		1,// signal semaphore count
-		signalSemaphores
-	};
-	vkResetFences(device, 1, &frameFences[currentFrame]);
-	const VkResult resultGfxSubmitQ =
-		vkQueueSubmit(graphicsQueue, 1, &submitInfo, frameFences[currentFrame]);
-	if (resultGfxSubmitQ != VK_SUCCESS)
-	{
-		switch (resultGfxSubmitQ)
-		{
-		case VK_ERROR_DEVICE_LOST:
-			///TODO: figure out why this randomly procs w/ large quad pool populations? ????
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to submit draw command buffer! (device lost)\n");
-			break;
-		case VK_ERROR_OUT_OF_DEVICE_MEMORY:
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to submit draw command buffer! (out of device memory)\n");
-			break;
-		case VK_ERROR_OUT_OF_HOST_MEMORY:
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to submit draw command buffer! (out of host memory)\n");
-			break;
-		default:
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to submit draw command buffer!\n");
-			break;
-		}
-		return false;
-	}
-	// present the next image in the swap chain //
-	VkPresentInfoKHR presentInfo = {
-		VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-		nullptr,// pNext
-		1,// wait semaphore count
-		signalSemaphores,
-		1,// swap chain count
-		&swapChain,
-		&imageIndex,
-		nullptr // array of VkResults
-	};
-	const VkResult resultQueuePresent =
-		vkQueuePresentKHR(presentQueue, &presentInfo);
-	if (resultQueuePresent == VK_ERROR_OUT_OF_DATE_KHR || 
-		resultQueuePresent == VK_SUBOPTIMAL_KHR ||
-		windowResized)
-	{
-		if (!rebuildSwapChain())
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to rebuild swap chain!\n");
-			return false;
-		}
-	}
-	else if(resultQueuePresent != VK_SUCCESS)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to present swap chain image!\n");
-		return false;
-	}
-	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
-	return true;
-}
-void k10::RenderWindow::waitForOperationsToFinish()
-{
-	vkDeviceWaitIdle(device);
-}
-void k10::RenderWindow::onWindowEvent(SDL_WindowEvent const& we)
-{
-	switch (we.event)
-	{
-	case SDL_WINDOWEVENT_SHOWN:
-///		SDL_Log("window shown!\n");
-		break;
-	case SDL_WINDOWEVENT_HIDDEN:
-///		SDL_Log("window hidden!\n");
-		break;
-	case SDL_WINDOWEVENT_EXPOSED:
-///		SDL_Log("window exposed!\n");
-		break;
-	case SDL_WINDOWEVENT_MAXIMIZED:
-///		SDL_Log("window maximized!\n");
-		break;
-	case SDL_WINDOWEVENT_RESTORED:
-		windowMinimized = false;
-		break;
-	case SDL_WINDOWEVENT_RESIZED:
-		windowResized = true;
-		break;
-	case SDL_WINDOWEVENT_MINIMIZED:
-		windowMinimized = true;
-		break;
-	}
-}
-k10::QuadPool& k10::RenderWindow::getQuadPool()
-{
-	return quadPool;
-}
-k10::GfxPipelineIndex k10::RenderWindow::createGfxPipeline(
-	GfxProgram const* vertProgram, GfxProgram const* fragProgram)
-{
-	if (gfxPipelines.size() >= MAX_PIPELINES)
-	{
-		return MAX_PIPELINES;
-	}
-	GfxPipeline newPipeline;
-	vector<VkPipelineShaderStageCreateInfo> shaderStages = {
-		vertProgram->getPipelineShaderStageCreateInfo(),
-		fragProgram->getPipelineShaderStageCreateInfo() };
-	if (!newPipeline.createPipeline(
-			nextGpi, device, swapChainExtent, shaderStages, renderPass))
-	{
-		return MAX_PIPELINES;
-	}
-	do
-	{
-		nextGpi = (nextGpi + 1) % MAX_PIPELINES;
-	} while (findGfxPipeline(nextGpi) != nullptr && 
-			 gfxPipelines.size() < MAX_PIPELINES);
-	gfxPipelines.push_back(newPipeline);
-	return newPipeline.getGpi();
-}
-k10::GfxProgram* k10::RenderWindow::createGfxProgram(GfxProgram::ShaderType st)
-{
-	return new GfxProgram(device, st);
-}
-///VkDevice k10::RenderWindow::getDevice() const
-///{
-///	return device;
-///}
-void k10::RenderWindow::cleanupSwapChain()
-{
-	for (VkFramebuffer fb : swapChainFramebuffers)
-	{
-		vkDestroyFramebuffer(device, fb, nullptr);
-	}
-	for (GfxPipeline p : gfxPipelines)
-	{
-		p.destroy(device);
-	}
-	vkFreeCommandBuffers(device, commandPool,
-		static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
-	vkDestroyRenderPass(device, renderPass, nullptr);
-	for (VkImageView iv : swapChainImageViews)
-	{
-		vkDestroyImageView(device, iv, nullptr);
-	}
-	vkDestroySwapchainKHR(device, swapChain, nullptr);
-}
-bool k10::RenderWindow::rebuildSwapChain()
-{
-	windowResized = false;
-	vkDeviceWaitIdle(device);
-	cleanupSwapChain();
-	if (!createSwapChain())
-	{
-		return false;
-	}
-	if (!createImageViews())
-	{
-		return false;
-	}
-	if (!createRenderPass())
-	{
-		return false;
-	}
-	if (!createFramebuffers())
-	{
-		return false;
-	}
-	if (!createCommandBuffers())
-	{
-		return false;
-	}
-	// rebuild gfx pipelines //
-	{
-		for (GfxPipeline& p : gfxPipelines)
-		{
-			if (!p.buildPipelineFromCache(device, swapChainExtent, renderPass))
-			{
-				return false;
-			}
-		}
-	}
-	// re-record command buffers //
-	{
-		if (!recordCommandBuffers(gpiRecordedCommandBuffer))
-		{
-			return false;
-		}
-	}
-	return true;
-}
-bool k10::RenderWindow::createSwapChain()
-{
-	SwapChainSupportDetails swapChainSupport = 
-		querySwapChainSupport(physicalDevice);
-	VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-	VkPresentModeKHR presentMode     = chooseSwapPresentMode(swapChainSupport.presentModes);
-	VkExtent2D extent                = chooseSwapExtent(swapChainSupport.capabilities);
-	uint32_t imageCountMin = swapChainSupport.capabilities.minImageCount + 1;
-	if (swapChainSupport.capabilities.maxImageCount > 0 &&
-		imageCountMin > swapChainSupport.capabilities.maxImageCount)
-	{
-		imageCountMin = swapChainSupport.capabilities.maxImageCount;
-	}
-	QueueFamilyIndices queueFamilyIndices = 
-		findQueueFamilies(physicalDevice);
-	vector<uint32_t> qfiVec = queueFamilyIndices.toVkVector();
-	VkSharingMode imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	uint32_t queueFamilyIndexCount = 0;
-	uint32_t const* pQueueFamilyIndices = nullptr;
-	if (queueFamilyIndices.graphicsFamily != queueFamilyIndices.presentFamily)
-	{
-		imageSharingMode = VK_SHARING_MODE_CONCURRENT;
-		queueFamilyIndexCount = 2;
-		pQueueFamilyIndices = qfiVec.data();
-	}
-	VkSwapchainCreateInfoKHR createInfo{
-		VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-		nullptr,// pNext
-		0,// flags
-		surface,
-		imageCountMin,
-		surfaceFormat.format,
-		surfaceFormat.colorSpace,
-		extent,
-		1,// imageArrayLayers, always 1 unless we're doing stereoscopic 3D
-		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-		imageSharingMode,
-		queueFamilyIndexCount,
-		pQueueFamilyIndices,
-		swapChainSupport.capabilities.currentTransform,
-		VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-		presentMode,
-		VK_TRUE,// clipped means we don't care about the window's obscured pixels
-		VK_NULL_HANDLE // old swap chain (only used when resizing window etc...)
-	};
-	if (vkCreateSwapchainKHR(device, &createInfo, 
-							 nullptr, &swapChain) != VK_SUCCESS)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to create Vulkan swapchain!\n");
-		return false;
-	}
-	uint32_t swapChainImgCount;
-	vkGetSwapchainImagesKHR(device, swapChain, 
-							&swapChainImgCount, nullptr);
-	swapChainImages.resize(swapChainImgCount);
-	vkGetSwapchainImagesKHR(device, swapChain, 
-							&swapChainImgCount, swapChainImages.data());
-	swapChainFormat = surfaceFormat.format;
-	swapChainExtent = extent;
-	return true;
-}
-bool k10::RenderWindow::createImageViews()
-{
-	swapChainImageViews.resize(swapChainImages.size());
-	for (size_t i = 0; i < swapChainImageViews.size(); i++)
-	{
-		VkComponentMapping componentMapping = {
-			VK_COMPONENT_SWIZZLE_IDENTITY,// r
-			VK_COMPONENT_SWIZZLE_IDENTITY,// g
-			VK_COMPONENT_SWIZZLE_IDENTITY,// b
-			VK_COMPONENT_SWIZZLE_IDENTITY // a
-		};
-		VkImageSubresourceRange subresourceRange = {
-			VK_IMAGE_ASPECT_COLOR_BIT,
-			0,// baseMipLevel
-			1,// levelCount
-			0,// baseArrayLayer
-			1 // layerCount
-		};
-		VkImageViewCreateInfo createInfo = {
-			VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-			nullptr,// pNext
-			0,// flags
-			swapChainImages[i],
-			VK_IMAGE_VIEW_TYPE_2D,
-			swapChainFormat,
-			componentMapping,
-			subresourceRange
-		};
-		if (vkCreateImageView(device, &createInfo, nullptr,
-							  &swapChainImageViews[i]) != VK_SUCCESS)
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to create Vulkan swapchain image view!\n");
-			return false;
-		}
-	}
-	return true;
-}
-bool k10::RenderWindow::createRenderPass()
-{
-	VkAttachmentDescription colorAttachment = {
-		0,// flags
-		swapChainFormat,
-		VK_SAMPLE_COUNT_1_BIT,
-		VK_ATTACHMENT_LOAD_OP_CLEAR,
-		VK_ATTACHMENT_STORE_OP_STORE,
-		VK_ATTACHMENT_LOAD_OP_DONT_CARE,// stencil
-		VK_ATTACHMENT_STORE_OP_DONT_CARE,// stencil
-		VK_IMAGE_LAYOUT_UNDEFINED,// initial layout
-		VK_IMAGE_LAYOUT_PRESENT_SRC_KHR // final layout
-	};
-	VkAttachmentReference colorAttachmentRef = {
-		0,// attachment
-		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-	};
-	VkSubpassDescription subpass = {
-		0,// flags
-		VK_PIPELINE_BIND_POINT_GRAPHICS,
-		0,// inputAttachmentCount
-		nullptr, // input attachments
-		1,// color attachment count
-		&colorAttachmentRef,
-		nullptr,// resolve attachments
-		nullptr,// depth stencil attachment
-		0,// preserve attachment count
-		nullptr // preserve attachments
-	};
-	VkSubpassDependency dependency = {
-		VK_SUBPASS_EXTERNAL,// src subpass
-		0,// dst subpass
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,// src stage mask
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,// dst stage mask
-		0,// src access mask
-		VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
-			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,// dst access mask
-		0 // flags
-	};
-	VkRenderPassCreateInfo renderPassCreateInfo = {
-		VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-		nullptr,// pNext
-		0,// flags
-		1,// attachment count
-		&colorAttachment,
-		1,// subpass count
-		&subpass,
-		1,// dependency count
-		&dependency // dependencies
-	};
-	if(vkCreateRenderPass(device, 
-						  &renderPassCreateInfo, 
-						  nullptr,
-						  &renderPass) != VK_SUCCESS)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to create Vulkan render pass!\n");
-		return false;
-	}
-	return true;
-}
-bool k10::RenderWindow::createFramebuffers()
-{
-	swapChainFramebuffers.resize(swapChainImageViews.size());
-	for (size_t f = 0; f < swapChainImageViews.size(); f++)
-	{
-		VkFramebufferCreateInfo createInfo = {
-			VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-			nullptr,// pNext
-			0,// flags
-			renderPass,
-			1,// attachment count
-			&swapChainImageViews[f],
-			swapChainExtent.width,
-			swapChainExtent.height,
-			1 // layers
-		};
-		if (vkCreateFramebuffer(device,
-								&createInfo,
-								nullptr,
-								&swapChainFramebuffers[f]) != VK_SUCCESS)
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-				"Failed to create Vulkan framebuffer!\n");
-			return false;
-		}
-	}
-	return true;
-}
-bool k10::RenderWindow::createCommandBuffers()
-{
-	commandBuffers.resize(swapChainFramebuffers.size());
-	VkCommandBufferAllocateInfo allocateInfo = {
-		VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-		nullptr,// pNext
-		commandPool,
-		VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-		static_cast<uint32_t>(commandBuffers.size())
-	};
-	if (vkAllocateCommandBuffers(device,
-								 &allocateInfo,
-								 commandBuffers.data()) != VK_SUCCESS)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
-			"Failed to allocate Vulkan command buffers!\n");
-		return false;
-	}
-	return true;
-}
-k10::RenderWindow::QueueFamilyIndices k10::RenderWindow::findQueueFamilies(VkPhysicalDevice pd) const
-{
-	QueueFamilyIndices retVal;
-	uint32_t queueFamilyCount = 0;
-	vkGetPhysicalDeviceQueueFamilyProperties(pd, &queueFamilyCount, nullptr);
-	vector<VkQueueFamilyProperties> queueFamilyProps(queueFamilyCount);
-	vkGetPhysicalDeviceQueueFamilyProperties(pd, &queueFamilyCount, queueFamilyProps.data());
-	for (uint64_t qfIndex = 0; static_cast<size_t>(qfIndex) < queueFamilyProps.size(); qfIndex++)
-	{
-		VkQueueFamilyProperties const& qfp = queueFamilyProps[qfIndex];
-		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(pd,
-			static_cast<uint32_t>(qfIndex), surface, &presentSupport);
-		if (qfp.queueCount > 0 && presentSupport)
-		{
-			retVal.presentFamily = qfIndex;
-		}
-		if (qfp.queueCount > 0 && qfp.queueFlags & VK_QUEUE_GRAPHICS_BIT)
-		{
-			retVal.graphicsFamily = qfIndex;
-		}
-		// TODO: change this somehow so that we prefer drawing & presentation to be on the same queue
-		if (retVal.isSuitable())
-		{
-			break;
-		}
-	}
-	return retVal;
-}
-k10::RenderWindow::SwapChainSupportDetails k10::RenderWindow::querySwapChainSupport(
-	VkPhysicalDevice pd) const
-{
-	SwapChainSupportDetails retVal;
-	// query capabilities //
-	{
-		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(pd, surface, &retVal.capabilities);
-	}
-	// query formats //
-	{
-		uint32_t formatCount;
-		vkGetPhysicalDeviceSurfaceFormatsKHR(pd, surface, &formatCount, nullptr);
-		if (formatCount > 0)
-		{
-			retVal.formats.resize(formatCount);
-			vkGetPhysicalDeviceSurfaceFormatsKHR(pd, 
-				surface, &formatCount, retVal.formats.data());
-		}
-	}
-	// query present modes //
-	{
-		uint32_t presentModeCount;
-		vkGetPhysicalDeviceSurfacePresentModesKHR(pd, surface, &presentModeCount, nullptr);
-		if (presentModeCount > 0)
-		{
-			retVal.presentModes.resize(presentModeCount);
-			vkGetPhysicalDeviceSurfacePresentModesKHR(pd, 
-				surface, &presentModeCount, retVal.presentModes.data());
-		}
-	}
-	return retVal;
-}
-VkExtent2D k10::RenderWindow::chooseSwapExtent(
-	VkSurfaceCapabilitiesKHR const& c) const
-{
-	if (c.currentExtent.width != 
-			numeric_limits<decltype(c.currentExtent.width)>::max())
-	{
-///		if (c.currentExtent.width == 0)
-///		{
-///			SDL_Log("uh oh...\n");
-///		}
-		return c.currentExtent;
-	}
-	int w, h;
-	SDL_Vulkan_GetDrawableSize(window, &w, &h);
-	return VkExtent2D{ 
-		clamp(static_cast<uint32_t>(w), 
-			  c.minImageExtent.width, c.maxImageExtent.width),
-		clamp(static_cast<uint32_t>(h),
-			  c.minImageExtent.height, c.maxImageExtent.height) };
-}
-VkPresentModeKHR k10::RenderWindow::chooseSwapPresentMode(
-	vector<VkPresentModeKHR>const& presentModes) const
-{
-	for (VkPresentModeKHR const& pm : presentModes)
-	{
-		// Check for triple buffering support if available //
-		if (pm == VK_PRESENT_MODE_MAILBOX_KHR)
-		{
-			return pm;
-		}
-	}
-	// otherwise just use double buffering v-sync, because it is guaranteed //
-	return VK_PRESENT_MODE_FIFO_KHR;
-}
-VkSurfaceFormatKHR k10::RenderWindow::chooseSwapSurfaceFormat(
-	vector<VkSurfaceFormatKHR>const& formats) const
-{
-	SDL_assert(!formats.empty());
-	for (VkSurfaceFormatKHR const& f : formats)
-	{
-		if (f.format == VK_FORMAT_R8G8B8A8_UNORM &&
-			f.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
-		{
-			return f;
-		}
-	}
-	return formats[0];
-}
-k10::GfxPipeline* k10::RenderWindow::findGfxPipeline(GfxPipelineIndex gpi)
-{
-	for (GfxPipeline& gp : gfxPipelines)
-	{
-		if (gp.getGpi() == gpi)
-		{
-			return &gp;
-		}
-	}
-	return nullptr;
-}
-uint64_t k10::RenderWindow::findMemoryType(
-	uint32_t typeFilter, VkMemoryPropertyFlags properties) const
-{
-	VkPhysicalDeviceMemoryProperties physicalMemProps;
-	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &physicalMemProps);
-	for (uint32_t t = 0; t < physicalMemProps.memoryTypeCount; t++)
-	{
-		if ((typeFilter & (1 << t)) &&
-			(physicalMemProps.memoryTypes[t].propertyFlags & properties) == properties)
-		{
-			return t;
-		}
-	}
-	return numeric_limits<uint64_t>::max();
+#include "RenderWindow.h"
+const uint32_t k10::RenderWindow::MAX_FRAMES_IN_FLIGHT = 3;
+const uint32_t k10::RenderWindow::DEFAULT_FRAMES_IN_FLIGHT = 2;
+static double millisecondsSince(
+	std::chrono::time_point<std::chrono::high_resolution_clock> start)
+{
+	return std::chrono::duration_cast<std::chrono::duration<double,
+		std::milli>>(std::chrono::high_resolution_clock::now() - 
+					 start).count();
+}
+bool k10::RenderWindow::QueueFamilyIndices::isSuitable() const
+{
+	return graphicsFamily != std::numeric_limits<uint64_t>::max() &&
+		   presentFamily  != std::numeric_limits<uint64_t>::max();
+}
+k10::RenderWindow* k10::RenderWindow::createRenderWindow(
+	char const* title, int initialWidth, int initialHeight,
+	QuadPool::DrawMode quadPoolDrawMode, 
+	QuadPool::VertexFormat quadPoolVertexFormat,
+	size_t streamingQuadsPerFrame, uint32_t framesInFlight,
+	uint32_t swapChainImageCount, PresentModePolicy presentModePolicy)
+{
+	RenderWindow* retVal = new RenderWindow;
+	SDL_assert(framesInFlight > 0 && framesInFlight <= MAX_FRAMES_IN_FLIGHT);
+	retVal->framesInFlight = 
+		clamp(framesInFlight, uint32_t(1), MAX_FRAMES_IN_FLIGHT);
+	retVal->requestedSwapChainImageCount = swapChainImageCount;
+	retVal->presentModePolicy = presentModePolicy;
+	// Create the SDL Window //
+	retVal->window = SDL_CreateWindow(title,
+									  SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+									  initialWidth, initialHeight,
+									  SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
+	if (!retVal->window)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create window! error='%s'\n", SDL_GetError());
+		delete retVal;
+		return nullptr;
+	}
+	// Get list of required Vulkan extensions we need Vulkan instance for the SDL window //
+	vector<char const*> requiredExtensionNames;
+	{
+		uint32_t extensionCount;
+		if (!SDL_Vulkan_GetInstanceExtensions(retVal->window, &extensionCount, nullptr))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to get required Vulkan extension count! error='%s'\n", SDL_GetError());
+			delete retVal;
+			return nullptr;
+		}
+		requiredExtensionNames.resize(extensionCount);
+		if(!SDL_Vulkan_GetInstanceExtensions(
+			retVal->window, &extensionCount, requiredExtensionNames.data()))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to get required Vulkan extension names! error='%s'\n", SDL_GetError());
+			delete retVal;
+			return nullptr;
+		}
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+		requiredExtensionNames.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+#endif
+		SDL_Log("We require %i Vulkan extensions to run!\n", 
+			requiredExtensionNames.size());
+		for (size_t e = 0; e < requiredExtensionNames.size(); e++)
+		{
+			char const* name = requiredExtensionNames[e];
+			SDL_Log("\t'%s'\n", name);
+		}
+	}
+	// get a list of supported Vulkan extensions //
+	vector<VkExtensionProperties> extensionProperties;
+	{
+		uint32_t extensionCount;
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+		extensionProperties.resize(extensionCount);
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensionProperties.data());
+		SDL_Log("Available Vulkan instance extensions:\n");
+		for (auto const& ep : extensionProperties)
+		{
+			SDL_Log("\t'%s' (version %i)\n", ep.extensionName, ep.specVersion);
+		}
+		for (char const* const ren : requiredExtensionNames)
+		{
+			bool requirementSatisfied = false;
+			for (auto const& ep : extensionProperties)
+			{
+				if (strcmp(ep.extensionName, ren) == 0)
+				{
+					requirementSatisfied = true;
+					break;
+				}
+			}
+			if (!requirementSatisfied)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+					"Could not satisfy vulkan extension requirement! extension='%s'\n", ren);
+				delete retVal;
+				return nullptr;
+			}
+		}
+	}
+	// VK_EXT_memory_budget is queried through the properties2 instance 
+	//	extension, so enable it when we can.  Nothing breaks without it, we
+	//	just have to estimate the heap budgets ourselves //
+	const bool physicalDeviceProperties2Supported = 
+		std::find_if(extensionProperties.begin(), extensionProperties.end(),
+			[](VkExtensionProperties const& ep)->bool
+			{
+				return strcmp(ep.extensionName, 
+					VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0;
+			}) != extensionProperties.end();
+	if (physicalDeviceProperties2Supported)
+	{
+		requiredExtensionNames.push_back(
+			VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+	}
+	const vector<char const*> requiredLayers = {
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+		"VK_LAYER_KHRONOS_validation"
+#endif
+	};
+	if (requiredLayers.empty())
+	{
+		SDL_Log("No Vulkan instance layers required!\n");
+	}
+	else
+	{
+		SDL_Log("Required Vulkan instance layers:\n");
+		for (char const* const rl : requiredLayers)
+		{
+			SDL_Log("\t'%s'\n", rl);
+		}
+	}
+	// Get a list of all available layers //
+	vector<VkLayerProperties> layerProperties;
+	{
+		uint32_t layerCount;
+		vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+		layerProperties.resize(layerCount);
+		vkEnumerateInstanceLayerProperties(&layerCount, layerProperties.data());
+		SDL_Log("Available Vulkan instance layers:\n");
+		for (auto const& lp : layerProperties)
+		{
+			SDL_Log("\t'%s' (version %i)\n", lp.layerName, lp.implementationVersion);
+		}
+		for (char const* const rl : requiredLayers)
+		{
+			bool requirementSatisfied = false;
+			for (auto const& lp : layerProperties)
+			{
+				if (strcmp(lp.layerName, rl) == 0)
+				{
+					requirementSatisfied = true;
+					break;
+				}
+			}
+			if (!requirementSatisfied)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+					"Could not satisfy vulkan layer requirement! layer='%s'\n", rl);
+				delete retVal;
+				return nullptr;
+			}
+		}
+	}
+	// create Vulkan instance //
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+	const VkDebugUtilsMessengerCreateInfoEXT debugUtilsMessengerCreateInfo = {
+		VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
+		nullptr,// pNext
+		0,// flags
+		VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT,
+		VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
+		vulkanDebugMessengerCallback,
+		nullptr // userData
+	};
+#endif
+	{
+		VkApplicationInfo appInfo = {
+			VK_STRUCTURE_TYPE_APPLICATION_INFO,
+			nullptr,// pNext
+			title,
+			VK_MAKE_VERSION(1,0,0),
+			"K10",
+			VK_MAKE_VERSION(1,0,0),
+			VK_API_VERSION_1_0
+		};
+		VkInstanceCreateInfo createInfo = {
+			VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+			(VkDebugUtilsMessengerCreateInfoEXT*)& debugUtilsMessengerCreateInfo,
+#else
+			nullptr,// pNext
+#endif
+			0,// flags
+			&appInfo,
+			static_cast<uint32_t>(requiredLayers.size()),
+			requiredLayers.data(),
+			static_cast<uint32_t>(requiredExtensionNames.size()),
+			requiredExtensionNames.data()
+		};
+		const VkResult result = 
+			vkCreateInstance(&createInfo, nullptr, &retVal->instance);
+		if (result != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to create Vulkan instance!\n");
+			delete retVal;
+			return nullptr;
+		}
+	}
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+	// Setup a handler for debug messages from the validation layer 
+	//	so we can choose which get displayed //
+	{
+		PFN_vkCreateDebugUtilsMessengerEXT createDebugUtilsMessengerEXT;
+		createDebugUtilsMessengerEXT = (PFN_vkCreateDebugUtilsMessengerEXT)
+			vkGetInstanceProcAddr(retVal->instance, "vkCreateDebugUtilsMessengerEXT");
+		if (createDebugUtilsMessengerEXT)
+		{
+			if (createDebugUtilsMessengerEXT(
+					retVal->instance, &debugUtilsMessengerCreateInfo, 
+					nullptr, &retVal->debugMessenger) != VK_SUCCESS)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+					"Failed to create Vulkan Debug Utils Messanger!\n");
+				delete retVal;
+				return nullptr;
+			}
+		}
+		else
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to find vkCreateDebugUtilsMessengerEXT!\n");
+			delete retVal;
+			return nullptr;
+		}
+	}
+#endif
+	if (!SDL_Vulkan_CreateSurface(retVal->window, 
+								  retVal->instance, 
+								  &retVal->surface))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create Vulkan window surface!\n");
+		delete retVal;
+		return nullptr;
+	}
+	// Choose physical device to Vulkan on //
+	const vector<const char*> requiredPhysicalDeviceExtensions = {
+		VK_KHR_SWAPCHAIN_EXTENSION_NAME
+	};
+	{
+		auto isPhysicalDeviceSuitable = 
+			[retVal, &requiredPhysicalDeviceExtensions](VkPhysicalDevice pd)->bool
+		{
+			//VkPhysicalDeviceProperties deviceProperties;
+			//VkPhysicalDeviceFeatures   deviceFeatures;
+			//vkGetPhysicalDeviceProperties(pd, &deviceProperties);
+			//vkGetPhysicalDeviceFeatures  (pd, &deviceFeatures);
+			//return deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+			QueueFamilyIndices qfi = retVal->findQueueFamilies(pd);
+			if (!qfi.isSuitable())
+			{
+				return false;
+			}
+			const bool extensionsSupported =
+				checkPhysicalDeviceExtensionSupport(
+					pd, requiredPhysicalDeviceExtensions);
+			if (!extensionsSupported)
+			{
+				return false;
+			}
+			SwapChainSupportDetails swapChainSupport =
+				retVal->querySwapChainSupport(pd);
+			if (swapChainSupport.formats.empty() ||
+				swapChainSupport.presentModes.empty())
+			{
+				return false;
+			}
+			return true;
+		};
+		uint32_t deviceCount;
+		vkEnumeratePhysicalDevices(retVal->instance, &deviceCount, nullptr);
+		if (deviceCount <= 0)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to find physical device with Vulkan support!\n");
+			delete retVal;
+			return nullptr;
+		}
+		vector<VkPhysicalDevice> physicalDevices(deviceCount);
+		vkEnumeratePhysicalDevices(retVal->instance, &deviceCount, physicalDevices.data());
+		SDL_Log("System has %i physical devices with Vulkan support:\n", physicalDevices.size());
+		for (VkPhysicalDevice const& pd : physicalDevices)
+		{
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(pd, &deviceProperties);
+			SDL_Log("\t'%s'\n", deviceProperties.deviceName);
+		}
+		for (VkPhysicalDevice const& pd : physicalDevices)
+		{
+			if (isPhysicalDeviceSuitable(pd))
+			{
+				retVal->physicalDevice = pd;
+				break;
+			}
+		}
+		if (retVal->physicalDevice == VK_NULL_HANDLE)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to find a suitable physical device!\n");
+			delete retVal;
+			return nullptr;
+		}
+	}
+	// Create a logical device to Vulkan on //
+	{
+		vector<const char*> deviceExtensions = requiredPhysicalDeviceExtensions;
+		const bool memoryBudgetSupported = physicalDeviceProperties2Supported &&
+			checkPhysicalDeviceExtensionSupport(retVal->physicalDevice,
+				{ VK_EXT_MEMORY_BUDGET_EXTENSION_NAME });
+		if (memoryBudgetSupported)
+		{
+			deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		}
+		const QueueFamilyIndices qfi = 
+			retVal->findQueueFamilies(retVal->physicalDevice);
+		float queuePriority = 1.f;
+		const vector<uint32_t> qfiValues = qfi.toVkVector();
+		vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+		for (size_t i = 0; i < qfiValues.size(); i++)
+		{
+			bool infoExists = false;
+			for (size_t j = 0; j < i; j++)
+			{
+				// check if we've visited this raw value yet...
+				if (qfiValues[j] == qfiValues[i])
+				{
+					infoExists = true;
+					break;
+				}
+			}
+			if (infoExists)
+			{
+				continue;
+			}
+			VkDeviceQueueCreateInfo queueCreateInfo = {
+				VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+				nullptr,// pNext
+				0,// flags
+				qfiValues[i],
+				1,
+				&queuePriority
+			};
+			queueCreateInfos.push_back(queueCreateInfo);
+		}
+		VkPhysicalDeviceFeatures deviceFeatures = {
+		};
+		VkDeviceCreateInfo createInfo = {
+			VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+			nullptr,// pNext
+			0,// flags
+			static_cast<uint32_t>(queueCreateInfos.size()),
+			queueCreateInfos.data(),
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+			static_cast<uint32_t>(requiredLayers.size()),
+			requiredLayers.data(),
+#else
+			0,
+			nullptr,
+#endif
+			static_cast<uint32_t>(deviceExtensions.size()),
+			deviceExtensions.data(),
+			&deviceFeatures
+		};
+		if (vkCreateDevice(retVal->physicalDevice, &createInfo, 
+						   nullptr, &retVal->device) != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to create Vulkan logical device!\n");
+			delete retVal;
+			return nullptr;
+		}
+		vkGetDeviceQueue(retVal->device, 
+						 static_cast<uint32_t>(qfi.graphicsFamily),
+						 0, &retVal->graphicsQueue);
+		vkGetDeviceQueue(retVal->device, 
+						 static_cast<uint32_t>(qfi.presentFamily), 
+						 0, &retVal->presentQueue);
+		vkGetDeviceQueue(retVal->device, 
+						 static_cast<uint32_t>(qfi.transferFamily), 
+						 0, &retVal->transferQueue);
+		const PFN_vkGetPhysicalDeviceMemoryProperties2KHR 
+			getMemoryProperties2 = memoryBudgetSupported ?
+				(PFN_vkGetPhysicalDeviceMemoryProperties2KHR)
+					vkGetInstanceProcAddr(retVal->instance,
+						"vkGetPhysicalDeviceMemoryProperties2KHR") :
+				nullptr;
+		if (!retVal->gfxMemoryAllocator.initialize(retVal->device,
+												   retVal->physicalDevice,
+												   GfxMemoryAllocator::
+														DEFAULT_BLOCK_SIZE,
+												   getMemoryProperties2))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to initialize gfx memory allocator!\n");
+			delete retVal;
+			return nullptr;
+		}
+	}
+	if (!retVal->createSwapChain())
+	{
+		delete retVal;
+		return nullptr;
+	}
+	if(!retVal->createImageViews())
+	{
+		delete retVal;
+		return nullptr;
+	}
+	if(!retVal->createRenderPass(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 
+								 retVal->renderPass))
+	{
+		delete retVal;
+		return nullptr;
+	}
+	if(!retVal->createFramebuffers())
+	{
+		delete retVal;
+		return nullptr;
+	}
+	// GPU timestamps for frame timing //
+	{
+		const QueueFamilyIndices qfi = 
+			retVal->findQueueFamilies(retVal->physicalDevice);
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(retVal->physicalDevice, 
+									  &deviceProperties);
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(retVal->physicalDevice, 
+												 &queueFamilyCount, nullptr);
+		vector<VkQueueFamilyProperties> queueFamilyProps(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(retVal->physicalDevice, 
+												 &queueFamilyCount, 
+												 queueFamilyProps.data());
+		const uint32_t timestampValidBits = 
+			queueFamilyProps[qfi.graphicsFamily].timestampValidBits;
+		if (timestampValidBits > 0)
+		{
+			retVal->timestampPeriod = deviceProperties.limits.timestampPeriod;
+			retVal->timestampMask = timestampValidBits >= 64 ?
+				numeric_limits<Uint64>::max() :
+				(Uint64(1) << timestampValidBits) - 1;
+		}
+	}
+	if (!retVal->createFrameResources())
+	{
+		delete retVal;
+		return nullptr;
+	}
+	// Create Vertex Buffer //
+	{
+		const vector<k10::Vertex> vertices = {
+			{{-0.5f,  0.5f}, {1.f, 1.f, 0.f, 1.f}},
+			{{-0.5f, -0.5f}, {1.f, 0.f, 0.f, 1.f}},
+			{{ 0.5f,  0.5f}, {0.f, 0.f, 1.f, 1.f}},
+			{{ 0.5f, -0.5f}, {0.f, 1.f, 0.f, 1.f}}
+		};
+		retVal->vertexBufferCount = static_cast<uint32_t>(vertices.size());
+		const VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
+		if (!retVal->vertexBuffer.createBuffer(retVal->gfxMemoryAllocator,
+											   bufferSize,
+											   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+											   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | 
+													VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to create vertexBuffer!\n");
+			delete retVal;
+			return nullptr;
+		}
+		void* data = nullptr;
+		retVal->vertexBuffer.mapMemory(&data, 0, bufferSize);
+		memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
+		retVal->vertexBuffer.unmapMemory();
+	}
+	const QueueFamilyIndices qfi = 
+		retVal->findQueueFamilies(retVal->physicalDevice);
+	if (!retVal->quadPool.fillPool(retVal->gfxMemoryAllocator,
+								   static_cast<uint32_t>(qfi.transferFamily),
+								   static_cast<uint32_t>(qfi.graphicsFamily),
+								   retVal->transferQueue,
+								   QuadPool::MAX_QUAD_COUNT,
+								   quadPoolDrawMode,
+								   quadPoolVertexFormat))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to fill quad pool!\n");
+		delete retVal;
+		return nullptr;
+	}
+	// every frame in flight gets its own streaming region, and there are 
+	//	enough of them for setFramesInFlight to go up to the max //
+	if (streamingQuadsPerFrame > 0 &&
+		!retVal->quadPool.createStreamingFrames(MAX_FRAMES_IN_FLIGHT, 
+												streamingQuadsPerFrame))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create quad pool streaming frames!\n");
+		delete retVal;
+		return nullptr;
+	}
+#ifdef K10_VULKAN_DEBUG_VERBOSE
+	retVal->logGfxMemoryStats();
+#endif
+	return retVal;
+}
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+VKAPI_ATTR VkBool32 VKAPI_CALL k10::RenderWindow::vulkanDebugMessengerCallback(
+	VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+	VkDebugUtilsMessageTypeFlagsEXT messageType,
+	const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+	void* pUserData)
+{
+	if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO, "validation layer ERROR='%s'\n",
+			pCallbackData->pMessage);
+		SDL_assert(false);
+	}
+	else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_VIDEO, "validation layer WARNING='%s'\n",
+			pCallbackData->pMessage);
+		SDL_assert(false);
+	}
+#ifdef K10_VULKAN_DEBUG_VERBOSE
+	else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT)
+	{
+		SDL_LogInfo(SDL_LOG_CATEGORY_VIDEO,
+			"validation layer INFO='%s'\n", pCallbackData->pMessage);
+	}
+	else //if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT)
+	{
+		SDL_LogVerbose(SDL_LOG_CATEGORY_VIDEO,
+			"validation layer VERBOSE='%s'\n", pCallbackData->pMessage);
+	}
+#endif
+	return VK_FALSE;
+}
+#endif
+bool k10::RenderWindow::checkPhysicalDeviceExtensionSupport(
+	VkPhysicalDevice pd, vector<char const*>const& requiredExtensionNames)
+{
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(pd, nullptr, &extensionCount, nullptr);
+	vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(pd, nullptr, &extensionCount, availableExtensions.data());
+	SDL_Log("physical device available extensions:\n");
+	for (VkExtensionProperties const& ep : availableExtensions)
+	{
+		SDL_Log("\t'%s' (version %i)\n", ep.extensionName, ep.specVersion);
+	}
+	for (char const* const ren : requiredExtensionNames)
+	{
+		bool isAvailable = false;
+		for (VkExtensionProperties const& ep : availableExtensions)
+		{
+			if (strcmp(ep.extensionName, ren) == 0)
+			{
+				isAvailable = true;
+				break;
+			}
+		}
+		if (!isAvailable)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+///void k10::RenderWindow::destroyRenderWindow(RenderWindow* rw)
+///{
+///	delete rw;
+///}
+k10::RenderWindow::~RenderWindow()
+{
+	quadPool.drainPool();
+	vertexBuffer.destroyBuffer();
+	destroyReadbackTarget();
+	gfxMemoryAllocator.destroy();
+	cleanupSwapChain();
+	stopRecordThreads();
+	destroyFrameResources();
+	vkDestroyDevice(device, nullptr);
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+	PFN_vkDestroyDebugUtilsMessengerEXT destroyDebugUtilsMessengerEXT;
+	destroyDebugUtilsMessengerEXT = (PFN_vkDestroyDebugUtilsMessengerEXT)
+		vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
+	if (destroyDebugUtilsMessengerEXT)
+	{
+		destroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
+	}
+	else
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO, 
+			"Failed to obtain vkDestroyDebugUtilsMessengerEXT!\n");
+		SDL_assert(false);
+	}
+#endif
+	vkDestroySurfaceKHR(instance, surface, nullptr);
+	vkDestroyInstance(instance, nullptr);
+	SDL_DestroyWindow(window);
+}
+bool k10::RenderWindow::setDrawPipeline(GfxPipelineIndex gpi)
+{
+	if (!findGfxPipeline(gpi))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to find gfx pipeline %i!\n", static_cast<int>(gpi));
+		SDL_assert(false);
+		return false;
+	}
+	drawGpi = gpi;
+	return true;
+}
+bool k10::RenderWindow::setRecordThreadCount(uint32_t threadCount)
+{
+	if (threadCount == recordThreads.size())
+	{
+		return true;
+	}
+	vkDeviceWaitIdle(device);
+	stopRecordThreads();
+	if (threadCount == 0)
+	{
+		return true;
+	}
+	// every thread needs its own pools, since a command pool can only be
+	//	used by one thread at a time //
+	QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+	VkCommandPoolCreateInfo poolCreateInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		nullptr,// pNext
+		VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,// flags
+		static_cast<uint32_t>(queueFamilyIndices.graphicsFamily)
+	};
+	recordThreads.resize(threadCount);
+	for (RecordThread& rt : recordThreads)
+	{
+		rt.frameCommandPools.resize(framesInFlight, VK_NULL_HANDLE);
+		rt.frameCommandBuffers.resize(framesInFlight);
+		rt.usedCommandBufferCount = 0;
+		for (size_t f = 0; f < framesInFlight; f++)
+		{
+			if (vkCreateCommandPool(device,
+									&poolCreateInfo,
+									nullptr,
+									&rt.frameCommandPools[f]) != VK_SUCCESS)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+					"Failed to create Vulkan command pool!\n");
+				stopRecordThreads();
+				return false;
+			}
+		}
+	}
+	// the threads have to start out at the current generation, otherwise
+	//	they would record whatever jobs were left over from before //
+	for (size_t t = 0; t < recordThreads.size(); t++)
+	{
+		recordThreads[t].thread = std::thread(
+			&RenderWindow::runRecordThread, this, t, recordGeneration);
+	}
+	return true;
+}
+uint32_t k10::RenderWindow::getRecordThreadCount() const
+{
+	return static_cast<uint32_t>(recordThreads.size());
+}
+double k10::RenderWindow::getLastRecordMilliseconds() const
+{
+	return lastRecordMilliseconds;
+}
+bool k10::RenderWindow::setFramesInFlight(uint32_t fif)
+{
+	SDL_assert(fif > 0 && fif <= MAX_FRAMES_IN_FLIGHT);
+	fif = clamp(fif, uint32_t(1), MAX_FRAMES_IN_FLIGHT);
+	if (fif == framesInFlight)
+	{
+		return true;
+	}
+	// nothing can be using the old frames' resources once the device is 
+	//	idle, as long as the quad pool stops holding on to their fences //
+	vkDeviceWaitIdle(device);
+	quadPool.forgetFrameFences();
+	const uint32_t recordThreadCount = getRecordThreadCount();
+	stopRecordThreads();
+	destroyFrameResources();
+	framesInFlight = fif;
+	currentFrame = 0;
+	if (!createFrameResources())
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to re-create frame resources!\n");
+		return false;
+	}
+	if (!setRecordThreadCount(recordThreadCount))
+	{
+		return false;
+	}
+	quadPool.beginStreamingFrame(static_cast<uint32_t>(currentFrame),
+								 frameFences[currentFrame]);
+	return true;
+}
+uint32_t k10::RenderWindow::getFramesInFlight() const
+{
+	return framesInFlight;
+}
+bool k10::RenderWindow::setSwapChainImageCount(uint32_t imageCount)
+{
+	requestedSwapChainImageCount = imageCount;
+	return rebuildSwapChain();
+}
+uint32_t k10::RenderWindow::getSwapChainImageCount() const
+{
+	return static_cast<uint32_t>(swapChainImages.size());
+}
+bool k10::RenderWindow::setPresentModePolicy(PresentModePolicy pmp)
+{
+	presentModePolicy = pmp;
+	return rebuildSwapChain();
+}
+k10::RenderWindow::PresentModePolicy 
+	k10::RenderWindow::getPresentModePolicy() const
+{
+	return presentModePolicy;
+}
+VkPresentModeKHR k10::RenderWindow::getPresentMode() const
+{
+	return swapChainPresentMode;
+}
+void k10::RenderWindow::beginFrameTiming()
+{
+	// timestamps of frames recorded before now don't count //
+	frameTimestampsWritten.assign(framesInFlight, false);
+	frameTimingActive = true;
+	frameTimingStart = std::chrono::high_resolution_clock::now();
+	timedFrameCount = 0;
+	timedCpuBlockedMs = 0;
+	timedGpuFrameCount = 0;
+	timedGpuBusyMs = 0;
+}
+k10::RenderWindow::FrameTimingStats k10::RenderWindow::endFrameTiming()
+{
+	SDL_assert(frameTimingActive);
+	frameTimingActive = false;
+	const double elapsedMs = millisecondsSince(frameTimingStart);
+	FrameTimingStats retVal = {
+		framesInFlight,
+		getSwapChainImageCount(),
+		timedFrameCount,
+		0,// frame ms
+		0,// cpu blocked ms
+		0,// cpu busy ms
+		0,// gpu busy ms
+		0 // overlap
+	};
+	if (timedFrameCount == 0)
+	{
+		return retVal;
+	}
+	retVal.frameMs = elapsedMs / timedFrameCount;
+	retVal.cpuBlockedMs = timedCpuBlockedMs / timedFrameCount;
+	retVal.cpuBusyMs = std::max(retVal.frameMs - retVal.cpuBlockedMs, 0.0);
+	if (timedGpuFrameCount > 0)
+	{
+		retVal.gpuBusyMs = timedGpuBusyMs / timedGpuFrameCount;
+	}
+	const double shorterBusyMs = std::min(retVal.cpuBusyMs, retVal.gpuBusyMs);
+	if (shorterBusyMs > 0)
+	{
+		retVal.overlap = clamp((retVal.cpuBusyMs + retVal.gpuBusyMs - 
+								retVal.frameMs) / shorterBusyMs, 0.0, 1.0);
+	}
+	return retVal;
+}
+bool k10::RenderWindow::drawFrame()
+{
+	if (windowMinimized)
+	{
+		// nothing gets drawn, so the streamed quads are thrown away //
+		quadPool.beginStreamingFrame(static_cast<uint32_t>(currentFrame),
+									 frameFences[currentFrame]);
+		return true;
+	}
+	std::chrono::time_point<std::chrono::high_resolution_clock> 
+		blockStart = std::chrono::high_resolution_clock::now();
+	vkWaitForFences(device, 1, &frameFences[currentFrame], VK_TRUE, UINT64_MAX);
+	double cpuBlockedMs = millisecondsSince(blockStart);
+	if (frameTimingActive && frameTimestampsWritten[currentFrame])
+	{
+		// the fence is signaled, so the results are already available //
+		Uint64 timestamps[2];
+		if (vkGetQueryPoolResults(device, frameQueryPool, 
+								  static_cast<uint32_t>(2*currentFrame), 2,
+								  sizeof(timestamps), timestamps, 
+								  sizeof(Uint64), 
+								  VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+		{
+			timedGpuBusyMs += ((timestamps[1] - timestamps[0]) & 
+				timestampMask) * timestampPeriod / 1000000.0;
+			timedGpuFrameCount++;
+		}
+		frameTimestampsWritten[currentFrame] = false;
+	}
+	// the device is done with everything recorded out of the frame's pool,
+	//	so all of it can be recycled at once //
+	vkResetCommandPool(device, frameCommandPools[currentFrame], 0);
+	for (RecordThread& rt : recordThreads)
+	{
+		vkResetCommandPool(device, rt.frameCommandPools[currentFrame], 0);
+		rt.usedCommandBufferCount = 0;
+	}
+	gfxMemoryAllocator.updateBudget();
+	if (quadPool.flushRequired())
+	{
+		quadPool.flushVertexStaging(transferQueue, graphicsQueue);
+	}
+	// aquire the next image in the swapchain //
+	uint32_t imageIndex;
+	blockStart = std::chrono::high_resolution_clock::now();
+	const VkResult resultAcquireNextImage =
+		vkAcquireNextImageKHR(device, 
+							  swapChain, 
+							  UINT64_MAX, 
+							  imageAvailableSemaphores[currentFrame],
+							  VK_NULL_HANDLE, 
+							  &imageIndex);
+	cpuBlockedMs += millisecondsSince(blockStart);
+	if (resultAcquireNextImage == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		// the frame never gets drawn, so its quads have to be streamed 
+		//	again //
+		quadPool.beginStreamingFrame(static_cast<uint32_t>(currentFrame),
+									 frameFences[currentFrame]);
+		return rebuildSwapChain();
+	}
+	else if (resultAcquireNextImage != VK_SUCCESS && 
+			 resultAcquireNextImage != VK_SUBOPTIMAL_KHR)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed acquire next image!\n");
+		return false;
+	}
+	if (!recordCommandBuffer(swapChainFramebuffers[imageIndex], false))
+	{
+		return false;
+	}
+	// submit command buffers to operate on this image //
+	// Also wait on any quad pool uploads that are still on their way to the
+	//	GPU before we start reading vertices.
+	vector<VkSemaphore> waitSemaphores = { 
+		imageAvailableSemaphores[currentFrame] };
+	vector<VkPipelineStageFlags> waitStages = { 
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+	// The streaming frame waits on this fence, and writes into the quad 
+	//	pool made after its uploads are consumed wait on it as well, so it
+	//	has to be reset between the two.
+	quadPool.endStreamingFrame();
+	vkResetFences(device, 1, &frameFences[currentFrame]);
+	quadPool.consumeUploadSemaphores(frameFences[currentFrame],
+									 waitSemaphores, waitStages);
+	VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
+	VkSubmitInfo submitInfo = {
+		VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		nullptr,// pNext
+		static_cast<uint32_t>(waitSemaphores.size()),
+		waitSemaphores.data(),
+		waitStages.data(),
+		1,// command buffer count
+		&frameCommandBuffers[currentFrame],
+		1,// signal semaphore count
+		signalSemaphores
+	};
+	const VkResult resultGfxSubmitQ =
+		vkQueueSubmit(graphicsQueue, 1, &submitInfo, frameFences[currentFrame]);
+	if (resultGfxSubmitQ != VK_SUCCESS)
+	{
+		switch (resultGfxSubmitQ)
+		{
+		case VK_ERROR_DEVICE_LOST:
+			///TODO: figure out why this randomly procs w/ large quad pool populations? ????
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to submit draw command buffer! (device lost)\n");
+			logGfxMemoryStats();
+			break;
+		case VK_ERROR_OUT_OF_DEVICE_MEMORY:
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to submit draw command buffer! (out of device memory)\n");
+			logGfxMemoryStats();
+			break;
+		case VK_ERROR_OUT_OF_HOST_MEMORY:
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to submit draw command buffer! (out of host memory)\n");
+			break;
+		default:
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to submit draw command buffer!\n");
+			break;
+		}
+		return false;
+	}
+	// present the next image in the swap chain //
+	VkPresentInfoKHR presentInfo = {
+		VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+		nullptr,// pNext
+		1,// wait semaphore count
+		signalSemaphores,
+		1,// swap chain count
+		&swapChain,
+		&imageIndex,
+		nullptr // array of VkResults
+	};
+	blockStart = std::chrono::high_resolution_clock::now();
+	const VkResult resultQueuePresent =
+		vkQueuePresentKHR(presentQueue, &presentInfo);
+	cpuBlockedMs += millisecondsSince(blockStart);
+	if (frameTimingActive)
+	{
+		timedFrameCount++;
+		timedCpuBlockedMs += cpuBlockedMs;
+	}
+	if (resultQueuePresent == VK_ERROR_OUT_OF_DATE_KHR || 
+		resultQueuePresent == VK_SUBOPTIMAL_KHR ||
+		windowResized)
+	{
+		if (!rebuildSwapChain())
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to rebuild swap chain!\n");
+			return false;
+		}
+	}
+	else if(resultQueuePresent != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to present swap chain image!\n");
+		return false;
+	}
+	currentFrame = (currentFrame + 1) % framesInFlight;
+	quadPool.beginStreamingFrame(static_cast<uint32_t>(currentFrame),
+								 frameFences[currentFrame]);
+	return true;
+}
+bool k10::RenderWindow::readbackFrame(vector<Uint32>& outPixels)
+{
+	// Nothing else can be in flight, so the current frame's command pools
+	//	& the readback target are free to use. //
+	vkDeviceWaitIdle(device);
+	// whatever got created before a failure gets cleaned up right away, so
+	//	the next call starts over //
+	if (readbackFramebuffer == VK_NULL_HANDLE && !createReadbackTarget())
+	{
+		destroyReadbackTarget();
+		return false;
+	}
+	vkResetCommandPool(device, frameCommandPools[currentFrame], 0);
+	for (RecordThread& rt : recordThreads)
+	{
+		vkResetCommandPool(device, rt.frameCommandPools[currentFrame], 0);
+		rt.usedCommandBufferCount = 0;
+	}
+	if (quadPool.flushRequired())
+	{
+		quadPool.flushVertexStaging(transferQueue, graphicsQueue);
+	}
+	if (!recordCommandBuffer(readbackFramebuffer, true))
+	{
+		return false;
+	}
+	// same as drawFrame, minus the swap chain image //
+	vector<VkSemaphore> waitSemaphores;
+	vector<VkPipelineStageFlags> waitStages;
+	quadPool.endStreamingFrame();
+	vkResetFences(device, 1, &frameFences[currentFrame]);
+	quadPool.consumeUploadSemaphores(frameFences[currentFrame],
+									 waitSemaphores, waitStages);
+	const VkSubmitInfo submitInfo = {
+		VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		nullptr,// pNext
+		static_cast<uint32_t>(waitSemaphores.size()),
+		waitSemaphores.data(),
+		waitStages.data(),
+		1,// command buffer count
+		&frameCommandBuffers[currentFrame],
+		0,// signal semaphore count
+		nullptr // signal semaphores
+	};
+	if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, 
+					  frameFences[currentFrame]) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to submit readback command buffer!\n");
+		return false;
+	}
+	vkWaitForFences(device, 1, &frameFences[currentFrame], VK_TRUE, UINT64_MAX);
+	const size_t pixelCount = 
+		static_cast<size_t>(swapChainExtent.width)*swapChainExtent.height;
+	readbackBuffer.invalidateMappedRange(0, pixelCount*sizeof(Uint32));
+	Uint32 const*const pixels = 
+		readbackBuffer.getMappedWindow<Uint32>(0, pixelCount);
+	outPixels.assign(pixels, pixels + pixelCount);
+	currentFrame = (currentFrame + 1) % framesInFlight;
+	quadPool.beginStreamingFrame(static_cast<uint32_t>(currentFrame),
+								 frameFences[currentFrame]);
+	return true;
+}
+VkExtent2D k10::RenderWindow::getSwapChainExtent() const
+{
+	return swapChainExtent;
+}
+void k10::RenderWindow::waitForOperationsToFinish()
+{
+	vkDeviceWaitIdle(device);
+}
+void k10::RenderWindow::onWindowEvent(SDL_WindowEvent const& we)
+{
+	switch (we.event)
+	{
+	case SDL_WINDOWEVENT_SHOWN:
+///		SDL_Log("window shown!\n");
+		break;
+	case SDL_WINDOWEVENT_HIDDEN:
+///		SDL_Log("window hidden!\n");
+		break;
+	case SDL_WINDOWEVENT_EXPOSED:
+///		SDL_Log("window exposed!\n");
+		break;
+	case SDL_WINDOWEVENT_MAXIMIZED:
+///		SDL_Log("window maximized!\n");
+		break;
+	case SDL_WINDOWEVENT_RESTORED:
+		windowMinimized = false;
+		break;
+	case SDL_WINDOWEVENT_RESIZED:
+		windowResized = true;
+		break;
+	case SDL_WINDOWEVENT_MINIMIZED:
+		windowMinimized = true;
+		break;
+	}
+}
+k10::QuadPool& k10::RenderWindow::getQuadPool()
+{
+	return quadPool;
+}
+void k10::RenderWindow::logGfxMemoryStats() const
+{
+	SDL_Log("Gfx memory: quad pool=%llu bytes, vertex buffer=%llu bytes\n",
+		static_cast<unsigned long long>(quadPool.getGfxMemorySize()),
+		static_cast<unsigned long long>(vertexBuffer.getMemorySize()));
+	gfxMemoryAllocator.logStats();
+}
+k10::RenderWindow::GfxMemoryStats k10::RenderWindow::getGfxMemoryStats() const
+{
+	GfxMemoryStats retVal;
+	retVal.memoryBudgetSupported = 
+		gfxMemoryAllocator.isMemoryBudgetSupported();
+	for (uint32_t h = 0; h < gfxMemoryAllocator.getHeapCount(); h++)
+	{
+		retVal.heaps.push_back(gfxMemoryAllocator.getHeapStats(h));
+	}
+	retVal.quadPoolBytes = quadPool.getGfxMemorySize();
+	retVal.vertexBufferBytes = vertexBuffer.getMemorySize();
+	return retVal;
+}
+void k10::RenderWindow::setGfxMemoryBudgetWarningThreshold(float f)
+{
+	gfxMemoryAllocator.setBudgetWarningThreshold(f);
+}
+k10::GfxPipelineIndex k10::RenderWindow::createGfxPipeline(
+	GfxProgram const* vertProgram, GfxProgram const* fragProgram)
+{
+	if (gfxPipelines.size() >= MAX_PIPELINES)
+	{
+		return MAX_PIPELINES;
+	}
+	GfxPipeline newPipeline;
+	vector<VkPipelineShaderStageCreateInfo> shaderStages = {
+		vertProgram->getPipelineShaderStageCreateInfo(),
+		fragProgram->getPipelineShaderStageCreateInfo() };
+	if (!newPipeline.createPipeline(
+			nextGpi, device, swapChainExtent, shaderStages, 
+			quadPool.getVertexBindingDescriptions(),
+			quadPool.getVertexAttributeDescriptions(),
+			renderPass))
+	{
+		return MAX_PIPELINES;
+	}
+	do
+	{
+		nextGpi = (nextGpi + 1) % MAX_PIPELINES;
+	} while (findGfxPipeline(nextGpi) != nullptr && 
+			 gfxPipelines.size() < MAX_PIPELINES);
+	gfxPipelines.push_back(newPipeline);
+	return newPipeline.getGpi();
+}
+k10::GfxProgram* k10::RenderWindow::createGfxProgram(GfxProgram::ShaderType st)
+{
+	return new GfxProgram(device, st);
+}
+///VkDevice k10::RenderWindow::getDevice() const
+///{
+///	return device;
+///}
+void k10::RenderWindow::cleanupSwapChain()
+{
+	// the readback target is the size of the swap chain //
+	destroyReadbackTarget();
+	for (VkFramebuffer fb : swapChainFramebuffers)
+	{
+		vkDestroyFramebuffer(device, fb, nullptr);
+	}
+	for (GfxPipeline p : gfxPipelines)
+	{
+		p.destroy(device);
+	}
+	vkDestroyRenderPass(device, renderPass, nullptr);
+	for (VkImageView iv : swapChainImageViews)
+	{
+		vkDestroyImageView(device, iv, nullptr);
+	}
+	vkDestroySwapchainKHR(device, swapChain, nullptr);
+}
+bool k10::RenderWindow::rebuildSwapChain()
+{
+	windowResized = false;
+	vkDeviceWaitIdle(device);
+	cleanupSwapChain();
+	if (!createSwapChain())
+	{
+		return false;
+	}
+	if (!createImageViews())
+	{
+		return false;
+	}
+	if (!createRenderPass(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, renderPass))
+	{
+		return false;
+	}
+	if (!createFramebuffers())
+	{
+		return false;
+	}
+	// rebuild gfx pipelines //
+	{
+		for (GfxPipeline& p : gfxPipelines)
+		{
+			if (!p.buildPipelineFromCache(device, swapChainExtent, renderPass))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+bool k10::RenderWindow::createSwapChain()
+{
+	SwapChainSupportDetails swapChainSupport = 
+		querySwapChainSupport(physicalDevice);
+	VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
+	VkPresentModeKHR presentMode     = chooseSwapPresentMode(swapChainSupport.presentModes);
+	swapChainPresentMode = presentMode;
+	VkExtent2D extent                = chooseSwapExtent(swapChainSupport.capabilities);
+	uint32_t imageCountMin = requestedSwapChainImageCount > 0 ?
+		std::max(requestedSwapChainImageCount, 
+				 swapChainSupport.capabilities.minImageCount) :
+		swapChainSupport.capabilities.minImageCount + 1;
+	if (swapChainSupport.capabilities.maxImageCount > 0 &&
+		imageCountMin > swapChainSupport.capabilities.maxImageCount)
+	{
+		imageCountMin = swapChainSupport.capabilities.maxImageCount;
+	}
+	QueueFamilyIndices queueFamilyIndices = 
+		findQueueFamilies(physicalDevice);
+	vector<uint32_t> qfiVec = queueFamilyIndices.toVkVector();
+	VkSharingMode imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	uint32_t queueFamilyIndexCount = 0;
+	uint32_t const* pQueueFamilyIndices = nullptr;
+	if (queueFamilyIndices.graphicsFamily != queueFamilyIndices.presentFamily)
+	{
+		imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+		queueFamilyIndexCount = 2;
+		pQueueFamilyIndices = qfiVec.data();
+	}
+	VkSwapchainCreateInfoKHR createInfo{
+		VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+		nullptr,// pNext
+		0,// flags
+		surface,
+		imageCountMin,
+		surfaceFormat.format,
+		surfaceFormat.colorSpace,
+		extent,
+		1,// imageArrayLayers, always 1 unless we're doing stereoscopic 3D
+		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+		imageSharingMode,
+		queueFamilyIndexCount,
+		pQueueFamilyIndices,
+		swapChainSupport.capabilities.currentTransform,
+		VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+		presentMode,
+		VK_TRUE,// clipped means we don't care about the window's obscured pixels
+		VK_NULL_HANDLE // old swap chain (only used when resizing window etc...)
+	};
+	if (vkCreateSwapchainKHR(device, &createInfo, 
+							 nullptr, &swapChain) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create Vulkan swapchain!\n");
+		return false;
+	}
+	uint32_t swapChainImgCount;
+	vkGetSwapchainImagesKHR(device, swapChain, 
+							&swapChainImgCount, nullptr);
+	swapChainImages.resize(swapChainImgCount);
+	vkGetSwapchainImagesKHR(device, swapChain, 
+							&swapChainImgCount, swapChainImages.data());
+	swapChainFormat = surfaceFormat.format;
+	swapChainExtent = extent;
+	return true;
+}
+bool k10::RenderWindow::createImageViews()
+{
+	swapChainImageViews.resize(swapChainImages.size());
+	for (size_t i = 0; i < swapChainImageViews.size(); i++)
+	{
+		VkComponentMapping componentMapping = {
+			VK_COMPONENT_SWIZZLE_IDENTITY,// r
+			VK_COMPONENT_SWIZZLE_IDENTITY,// g
+			VK_COMPONENT_SWIZZLE_IDENTITY,// b
+			VK_COMPONENT_SWIZZLE_IDENTITY // a
+		};
+		VkImageSubresourceRange subresourceRange = {
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			0,// baseMipLevel
+			1,// levelCount
+			0,// baseArrayLayer
+			1 // layerCount
+		};
+		VkImageViewCreateInfo createInfo = {
+			VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			nullptr,// pNext
+			0,// flags
+			swapChainImages[i],
+			VK_IMAGE_VIEW_TYPE_2D,
+			swapChainFormat,
+			componentMapping,
+			subresourceRange
+		};
+		if (vkCreateImageView(device, &createInfo, nullptr,
+							  &swapChainImageViews[i]) != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to create Vulkan swapchain image view!\n");
+			return false;
+		}
+	}
+	return true;
+}
+bool k10::RenderWindow::createRenderPass(VkImageLayout finalLayout,
+										 VkRenderPass& outRenderPass) const
+{
+	VkAttachmentDescription colorAttachment = {
+		0,// flags
+		swapChainFormat,
+		VK_SAMPLE_COUNT_1_BIT,
+		VK_ATTACHMENT_LOAD_OP_CLEAR,
+		VK_ATTACHMENT_STORE_OP_STORE,
+		VK_ATTACHMENT_LOAD_OP_DONT_CARE,// stencil
+		VK_ATTACHMENT_STORE_OP_DONT_CARE,// stencil
+		VK_IMAGE_LAYOUT_UNDEFINED,// initial layout
+		finalLayout
+	};
+	VkAttachmentReference colorAttachmentRef = {
+		0,// attachment
+		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+	};
+	VkSubpassDescription subpass = {
+		0,// flags
+		VK_PIPELINE_BIND_POINT_GRAPHICS,
+		0,// inputAttachmentCount
+		nullptr, // input attachments
+		1,// color attachment count
+		&colorAttachmentRef,
+		nullptr,// resolve attachments
+		nullptr,// depth stencil attachment
+		0,// preserve attachment count
+		nullptr // preserve attachments
+	};
+	// the second dependency only applies to images that get copied out of
+	//	once the render pass is done //
+	const VkSubpassDependency dependencies[] = {
+		{VK_SUBPASS_EXTERNAL,// src subpass
+			0,// dst subpass
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,// src stage mask
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,// dst stage mask
+			0,// src access mask
+			VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+				VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,// dst access mask
+			0},// flags
+		{0,// src subpass
+			VK_SUBPASS_EXTERNAL,// dst subpass
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,// src stage mask
+			VK_PIPELINE_STAGE_TRANSFER_BIT,// dst stage mask
+			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,// src access mask
+			VK_ACCESS_TRANSFER_READ_BIT,// dst access mask
+			0} };// flags
+	VkRenderPassCreateInfo renderPassCreateInfo = {
+		VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+		nullptr,// pNext
+		0,// flags
+		1,// attachment count
+		&colorAttachment,
+		1,// subpass count
+		&subpass,
+		finalLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL ? 
+			2u : 1u,// dependency count
+		dependencies
+	};
+	if(vkCreateRenderPass(device, 
+						  &renderPassCreateInfo, 
+						  nullptr,
+						  &outRenderPass) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create Vulkan render pass!\n");
+		return false;
+	}
+	return true;
+}
+bool k10::RenderWindow::createFramebuffers()
+{
+	swapChainFramebuffers.resize(swapChainImageViews.size());
+	for (size_t f = 0; f < swapChainImageViews.size(); f++)
+	{
+		VkFramebufferCreateInfo createInfo = {
+			VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+			nullptr,// pNext
+			0,// flags
+			renderPass,
+			1,// attachment count
+			&swapChainImageViews[f],
+			swapChainExtent.width,
+			swapChainExtent.height,
+			1 // layers
+		};
+		if (vkCreateFramebuffer(device,
+								&createInfo,
+								nullptr,
+								&swapChainFramebuffers[f]) != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to create Vulkan framebuffer!\n");
+			return false;
+		}
+	}
+	return true;
+}
+bool k10::RenderWindow::createReadbackTarget()
+{
+	switch (swapChainFormat)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_SRGB:
+		break;
+	default:
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Can't read back swap chain format %i!\n", 
+			static_cast<int>(swapChainFormat));
+		return false;
+	}
+	if (!createRenderPass(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 
+						  readbackRenderPass))
+	{
+		readbackRenderPass = VK_NULL_HANDLE;
+		return false;
+	}
+	const VkImageCreateInfo imageCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		nullptr,// pNext
+		0,// flags
+		VK_IMAGE_TYPE_2D,
+		swapChainFormat,
+		{swapChainExtent.width, swapChainExtent.height, 1},
+		1,// mip levels
+		1,// array layers
+		VK_SAMPLE_COUNT_1_BIT,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | 
+			VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		VK_SHARING_MODE_EXCLUSIVE,
+		0,// queue family index count
+		nullptr,// queue family indices
+		VK_IMAGE_LAYOUT_UNDEFINED // initial layout
+	};
+	if (vkCreateImage(device, &imageCreateInfo, nullptr, 
+					  &readbackImage) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create readback image!\n");
+		readbackImage = VK_NULL_HANDLE;
+		return false;
+	}
+	// gfxMemoryAllocator only sub-allocates buffers, so the image gets its
+	//	own allocation //
+	VkMemoryRequirements memRequirements;
+	vkGetImageMemoryRequirements(device, readbackImage, &memRequirements);
+	const uint64_t memoryTypeIndex = gfxMemoryAllocator.findMemoryType(
+		memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if (memoryTypeIndex == numeric_limits<uint64_t>::max())
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to find a memory type for the readback image!\n");
+		return false;
+	}
+	const VkMemoryAllocateInfo allocateInfo = {
+		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		nullptr,// pNext
+		memRequirements.size,
+		static_cast<uint32_t>(memoryTypeIndex)
+	};
+	if (vkAllocateMemory(device, &allocateInfo, nullptr, 
+						 &readbackImageMemory) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to allocate readback image memory!\n");
+		readbackImageMemory = VK_NULL_HANDLE;
+		return false;
+	}
+	vkBindImageMemory(device, readbackImage, readbackImageMemory, 0);
+	const VkImageViewCreateInfo viewCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		nullptr,// pNext
+		0,// flags
+		readbackImage,
+		VK_IMAGE_VIEW_TYPE_2D,
+		swapChainFormat,
+		{VK_COMPONENT_SWIZZLE_IDENTITY,// r
+			VK_COMPONENT_SWIZZLE_IDENTITY,// g
+			VK_COMPONENT_SWIZZLE_IDENTITY,// b
+			VK_COMPONENT_SWIZZLE_IDENTITY},// a
+		{VK_IMAGE_ASPECT_COLOR_BIT,
+			0,// baseMipLevel
+			1,// levelCount
+			0,// baseArrayLayer
+			1} };// layerCount
+	if (vkCreateImageView(device, &viewCreateInfo, nullptr,
+						  &readbackImageView) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create readback image view!\n");
+		readbackImageView = VK_NULL_HANDLE;
+		return false;
+	}
+	const VkFramebufferCreateInfo framebufferCreateInfo = {
+		VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+		nullptr,// pNext
+		0,// flags
+		readbackRenderPass,
+		1,// attachment count
+		&readbackImageView,
+		swapChainExtent.width,
+		swapChainExtent.height,
+		1 // layers
+	};
+	if (vkCreateFramebuffer(device, &framebufferCreateInfo, nullptr,
+							&readbackFramebuffer) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create readback framebuffer!\n");
+		readbackFramebuffer = VK_NULL_HANDLE;
+		return false;
+	}
+	if (!readbackBuffer.createBuffer(gfxMemoryAllocator,
+			sizeof(Uint32)*swapChainExtent.width*swapChainExtent.height,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			true))// persistently mapped
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to create readback buffer!\n");
+		return false;
+	}
+	return true;
+}
+void k10::RenderWindow::destroyReadbackTarget()
+{
+	if (readbackBuffer.getMemorySize() > 0)
+	{
+		readbackBuffer.destroyBuffer();
+	}
+	vkDestroyFramebuffer(device, readbackFramebuffer, nullptr);
+	readbackFramebuffer = VK_NULL_HANDLE;
+	vkDestroyImageView(device, readbackImageView, nullptr);
+	readbackImageView = VK_NULL_HANDLE;
+	vkDestroyImage(device, readbackImage, nullptr);
+	readbackImage = VK_NULL_HANDLE;
+	vkFreeMemory(device, readbackImageMemory, nullptr);
+	readbackImageMemory = VK_NULL_HANDLE;
+	vkDestroyRenderPass(device, readbackRenderPass, nullptr);
+	readbackRenderPass = VK_NULL_HANDLE;
+}
+bool k10::RenderWindow::createFrameResources()
+{
+	// Every frame in flight gets its own command pool, which gets reset 
+	//	wholesale once the frame's fence signals, since its command buffer
+	//	gets re-recorded every frame anyway.
+	{
+		QueueFamilyIndices queueFamilyIndices = 
+			findQueueFamilies(physicalDevice);
+		VkCommandPoolCreateInfo poolCreateInfo = {
+			VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			nullptr,// pNext
+			VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,// flags
+			static_cast<uint32_t>(queueFamilyIndices.graphicsFamily)
+		};
+		frameCommandPools.resize(framesInFlight, VK_NULL_HANDLE);
+		for (size_t f = 0; f < framesInFlight; f++)
+		{
+			if (vkCreateCommandPool(device,
+									&poolCreateInfo,
+									nullptr,
+									&frameCommandPools[f]) != VK_SUCCESS)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+					"Failed to create Vulkan command pool!\n");
+				return false;
+			}
+		}
+	}
+	if(!createCommandBuffers())
+	{
+		return false;
+	}
+	// create drawing synchronization tools //
+	{
+		const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+			VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			nullptr,// pNext
+			0 // flags
+		};
+		const VkFenceCreateInfo fenceCreateInfo = {
+			VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+			nullptr,// pNext
+			VK_FENCE_CREATE_SIGNALED_BIT // flags
+		};
+		imageAvailableSemaphores.resize(framesInFlight, VK_NULL_HANDLE);
+		renderFinishedSemaphores.resize(framesInFlight, VK_NULL_HANDLE);
+		frameFences.resize(framesInFlight, VK_NULL_HANDLE);
+		for (size_t f = 0; f < framesInFlight; f++)
+		{
+			if (vkCreateSemaphore(device,
+								  &semaphoreCreateInfo,
+								  nullptr,
+								  &imageAvailableSemaphores[f]) != VK_SUCCESS)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+					"Failed to allocate Vulkan semaphore!\n");
+				return false;
+			}
+			if (vkCreateSemaphore(device,
+								  &semaphoreCreateInfo,
+								  nullptr,
+								  &renderFinishedSemaphores[f]) != VK_SUCCESS)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+					"Failed to allocate Vulkan semaphore!\n");
+				return false;
+			}
+			if (vkCreateFence(device,
+							  &fenceCreateInfo,
+							  nullptr,
+							  &frameFences[f]) != VK_SUCCESS)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+					"Failed to allocate Vulkan frame fence!\n");
+				return false;
+			}
+		}
+	}
+	// timestamp queries //
+	frameTimestampsWritten.assign(framesInFlight, false);
+	if (timestampPeriod > 0)
+	{
+		const VkQueryPoolCreateInfo queryPoolCreateInfo = {
+			VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			nullptr,// pNext
+			0,// flags
+			VK_QUERY_TYPE_TIMESTAMP,
+			2*framesInFlight,// query count
+			0 // pipeline statistics
+		};
+		if (vkCreateQueryPool(device, 
+							  &queryPoolCreateInfo, 
+							  nullptr, 
+							  &frameQueryPool) != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to create Vulkan timestamp query pool!\n");
+			return false;
+		}
+	}
+	return true;
+}
+void k10::RenderWindow::destroyFrameResources()
+{
+	for (VkSemaphore semaphore : renderFinishedSemaphores)
+	{
+		vkDestroySemaphore(device, semaphore, nullptr);
+	}
+	for (VkSemaphore semaphore : imageAvailableSemaphores)
+	{
+		vkDestroySemaphore(device, semaphore, nullptr);
+	}
+	for (VkFence fence : frameFences)
+	{
+		vkDestroyFence(device, fence, nullptr);
+	}
+	// destroying the pools frees the frame command buffers too //
+	for (VkCommandPool framePool : frameCommandPools)
+	{
+		vkDestroyCommandPool(device, framePool, nullptr);
+	}
+	vkDestroyQueryPool(device, frameQueryPool, nullptr);
+	renderFinishedSemaphores.clear();
+	imageAvailableSemaphores.clear();
+	frameFences.clear();
+	frameCommandPools.clear();
+	frameCommandBuffers.clear();
+	frameQueryPool = VK_NULL_HANDLE;
+}
+bool k10::RenderWindow::createCommandBuffers()
+{
+	// the command buffers live as long as their pools, which recycle them
+	//	every frame //
+	frameCommandBuffers.resize(framesInFlight);
+	for (size_t f = 0; f < framesInFlight; f++)
+	{
+		VkCommandBufferAllocateInfo allocateInfo = {
+			VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			nullptr,// pNext
+			frameCommandPools[f],
+			VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			1 // command buffer count
+		};
+		if (vkAllocateCommandBuffers(device,
+									 &allocateInfo,
+									 &frameCommandBuffers[f]) != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to allocate Vulkan command buffers!\n");
+			return false;
+		}
+	}
+	return true;
+}
+bool k10::RenderWindow::recordCommandBuffer(VkFramebuffer framebuffer, 
+											bool readback)
+{
+	const std::chrono::time_point<std::chrono::high_resolution_clock> 
+		start = std::chrono::high_resolution_clock::now();
+	// nothing gets drawn until there is a pipeline to draw with //
+	GfxPipeline const*const pipeline = findGfxPipeline(drawGpi);
+	const bool secondaryDraws = pipeline && !recordThreads.empty();
+	if (secondaryDraws &&
+		!recordSecondaryCommandBuffers(pipeline->getPipeline(), framebuffer))
+	{
+		return false;
+	}
+	VkCommandBuffer const cb = frameCommandBuffers[currentFrame];
+	const VkCommandBufferBeginInfo beginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		nullptr,// pNext
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,// flags
+		nullptr // inheritanceInfo
+	};
+	if (vkBeginCommandBuffer(cb, &beginInfo) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to begin recording Vulkan command buffer!\n");
+		return false;
+	}
+	const bool writeTimestamps = 
+		frameTimingActive && frameQueryPool != VK_NULL_HANDLE;
+	const uint32_t firstQuery = static_cast<uint32_t>(2*currentFrame);
+	if (writeTimestamps)
+	{
+		vkCmdResetQueryPool(cb, frameQueryPool, firstQuery, 2);
+		vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
+							frameQueryPool, firstQuery);
+	}
+	// draw command updates & culling have to be done before the render 
+	//	pass starts //
+	quadPool.issueUpdateCommands(cb);
+	quadPool.issueCullCommands(cb);
+	// render pass definition //
+	{
+		VkClearValue renderPassClearValue = { 0.f, 0.f, 0.f, 1.f };
+		VkRenderPassBeginInfo renderPassInfo = {
+			VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+			nullptr,// pNext
+			readback ? readbackRenderPass : renderPass,
+			framebuffer,
+			VkRect2D{ {0, 0}, swapChainExtent},
+			1,// clear value count
+			&renderPassClearValue
+		};
+		vkCmdBeginRenderPass(cb, &renderPassInfo, secondaryDraws ?
+			VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS :
+			VK_SUBPASS_CONTENTS_INLINE);
+		if (secondaryDraws)
+		{
+			// executed in job order, so the draw order doesn't depend on 
+			//	which thread recorded what //
+			vector<VkCommandBuffer> secondaryCommandBuffers;
+			secondaryCommandBuffers.reserve(recordJobs.size());
+			for (RecordJob const& job : recordJobs)
+			{
+				secondaryCommandBuffers.push_back(job.commandBuffer);
+			}
+			vkCmdExecuteCommands(cb, 
+				static_cast<uint32_t>(secondaryCommandBuffers.size()),
+				secondaryCommandBuffers.data());
+		}
+		else if (pipeline)
+		{
+			vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
+							  pipeline->getPipeline());
+			quadPool.issueCommands(cb);
+			quadPool.issueStreamingCommands(cb, 
+				static_cast<uint32_t>(currentFrame));
+		}
+///		VkBuffer vertexBuffers[] = { vertexBuffer.getBuffer() };
+///		VkDeviceSize vbOffsets[] = { 0 };
+///		vkCmdBindVertexBuffers(cb, 0, 1, vertexBuffers, vbOffsets);
+///		vkCmdDraw(cb, vertexBufferCount, 1, 0, 0);
+		vkCmdEndRenderPass(cb);
+	}
+	// the readback render pass leaves the image ready to be copied //
+	if (readback)
+	{
+		const VkBufferImageCopy region = {
+			0,// buffer offset
+			0,// buffer row length (tightly packed)
+			0,// buffer image height (tightly packed)
+			{VK_IMAGE_ASPECT_COLOR_BIT,
+				0,// mip level
+				0,// base array layer
+				1},// layer count
+			{0, 0, 0},// image offset
+			{swapChainExtent.width, swapChainExtent.height, 1} };
+		vkCmdCopyImageToBuffer(cb, readbackImage, 
+							   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+							   readbackBuffer.getBuffer(), 1, &region);
+		const VkMemoryBarrier hostReadBarrier = {
+			VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			nullptr,// pNext
+			VK_ACCESS_TRANSFER_WRITE_BIT,// src access mask
+			VK_ACCESS_HOST_READ_BIT // dst access mask
+		};
+		vkCmdPipelineBarrier(cb,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 VK_PIPELINE_STAGE_HOST_BIT,
+							 0,// dependency flags
+							 1, &hostReadBarrier,
+							 0, nullptr,
+							 0, nullptr);
+	}
+	if (writeTimestamps)
+	{
+		vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 
+							frameQueryPool, firstQuery + 1);
+	}
+	if (vkEndCommandBuffer(cb) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed Vulkan command buffer recording failure!\n");
+		return false;
+	}
+	frameTimestampsWritten[currentFrame] = writeTimestamps;
+	lastRecordMilliseconds = millisecondsSince(start);
+	return true;
+}
+bool k10::RenderWindow::recordSecondaryCommandBuffers(
+	VkPipeline pipeline, VkFramebuffer framebuffer)
+{
+	// one job per chunk slot, and the streamed quads go last just like 
+	//	they do when drawing inline //
+	const size_t chunkSlotCount = quadPool.getChunkSlotCount();
+	recordJobs.resize(chunkSlotCount + 1);
+	for (size_t c = 0; c < chunkSlotCount; c++)
+	{
+		recordJobs[c] = { c, 1, VK_NULL_HANDLE };
+	}
+	recordJobs[chunkSlotCount] = { 0, 0, VK_NULL_HANDLE };
+	recordPipeline = pipeline;
+	recordFramebuffer = framebuffer;
+	nextRecordJob = 0;
+	recordJobFailed = false;
+	{
+		std::lock_guard<std::mutex> lock(recordMutex);
+		recordGeneration++;
+		busyRecordThreadCount = recordThreads.size();
+	}
+	recordCondition.notify_all();
+	{
+		std::unique_lock<std::mutex> lock(recordMutex);
+		recordDoneCondition.wait(lock, 
+			[&]()->bool { return busyRecordThreadCount == 0; });
+	}
+	if (recordJobFailed)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to record secondary command buffers!\n");
+		return false;
+	}
+	return true;
+}
+void k10::RenderWindow::runRecordThread(size_t threadIndex, 
+										uint64_t generation)
+{
+	RecordThread& rt = recordThreads[threadIndex];
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(recordMutex);
+			recordCondition.wait(lock, [&]()->bool { 
+				return quitRecordThreads || recordGeneration != generation; });
+			if (quitRecordThreads)
+			{
+				return;
+			}
+			generation = recordGeneration;
+		}
+		for (size_t j = nextRecordJob++; j < recordJobs.size(); 
+			 j = nextRecordJob++)
+		{
+			if (!recordJob(rt, recordJobs[j]))
+			{
+				recordJobFailed = true;
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock(recordMutex);
+			busyRecordThreadCount--;
+			if (busyRecordThreadCount == 0)
+			{
+				recordDoneCondition.notify_one();
+			}
+		}
+	}
+}
+bool k10::RenderWindow::recordJob(RecordThread& rt, RecordJob& job)
+{
+	vector<VkCommandBuffer>& commandBuffers = 
+		rt.frameCommandBuffers[currentFrame];
+	if (rt.usedCommandBufferCount == commandBuffers.size())
+	{
+		VkCommandBufferAllocateInfo allocateInfo = {
+			VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			nullptr,// pNext
+			rt.frameCommandPools[currentFrame],
+			VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+			1 // command buffer count
+		};
+		VkCommandBuffer newCommandBuffer;
+		if (vkAllocateCommandBuffers(device,
+									 &allocateInfo,
+									 &newCommandBuffer) != VK_SUCCESS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+				"Failed to allocate Vulkan command buffers!\n");
+			return false;
+		}
+		commandBuffers.push_back(newCommandBuffer);
+	}
+	VkCommandBuffer const cb = commandBuffers[rt.usedCommandBufferCount++];
+	const VkCommandBufferInheritanceInfo inheritanceInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+		nullptr,// pNext
+		renderPass,
+		0,// subpass
+		recordFramebuffer,
+		VK_FALSE,// occlusion query enable
+		0,// query flags
+		0 // pipeline statistics
+	};
+	const VkCommandBufferBeginInfo beginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		nullptr,// pNext
+		VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,// flags
+		&inheritanceInfo
+	};
+	if (vkBeginCommandBuffer(cb, &beginInfo) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed to begin recording Vulkan command buffer!\n");
+		return false;
+	}
+	// secondary command buffers don't inherit any state //
+	vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, recordPipeline);
+	if (job.chunkCount > 0)
+	{
+		quadPool.issueChunkCommands(cb, job.firstChunk, job.chunkCount);
+	}
+	else
+	{
+		quadPool.issueStreamingCommands(cb, 
+			static_cast<uint32_t>(currentFrame));
+	}
+	if (vkEndCommandBuffer(cb) != VK_SUCCESS)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+			"Failed Vulkan command buffer recording failure!\n");
+		return false;
+	}
+	job.commandBuffer = cb;
+	return true;
+}
+void k10::RenderWindow::stopRecordThreads()
+{
+	{
+		std::lock_guard<std::mutex> lock(recordMutex);
+		quitRecordThreads = true;
+	}
+	recordCondition.notify_all();
+	for (RecordThread& rt : recordThreads)
+	{
+		if (rt.thread.joinable())
+		{
+			rt.thread.join();
+		}
+		// destroying the pools frees their command buffers too //
+		for (VkCommandPool framePool : rt.frameCommandPools)
+		{
+			if (framePool != VK_NULL_HANDLE)
+			{
+				vkDestroyCommandPool(device, framePool, nullptr);
+			}
+		}
+	}
+	recordThreads.clear();
+	quitRecordThreads = false;
+}
+k10::RenderWindow::QueueFamilyIndices k10::RenderWindow::findQueueFamilies(VkPhysicalDevice pd) const
+{
+	QueueFamilyIndices retVal;
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(pd, &queueFamilyCount, nullptr);
+	vector<VkQueueFamilyProperties> queueFamilyProps(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(pd, &queueFamilyCount, queueFamilyProps.data());
+	for (uint64_t qfIndex = 0; static_cast<size_t>(qfIndex) < queueFamilyProps.size(); qfIndex++)
+	{
+		VkQueueFamilyProperties const& qfp = queueFamilyProps[qfIndex];
+		VkBool32 presentSupport = false;
+		vkGetPhysicalDeviceSurfaceSupportKHR(pd,
+			static_cast<uint32_t>(qfIndex), surface, &presentSupport);
+		if (qfp.queueCount > 0 && presentSupport)
+		{
+			retVal.presentFamily = qfIndex;
+		}
+		if (qfp.queueCount > 0 && qfp.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+		{
+			retVal.graphicsFamily = qfIndex;
+		}
+		// TODO: change this somehow so that we prefer drawing & presentation to be on the same queue
+		if (retVal.isSuitable())
+		{
+			break;
+		}
+	}
+	// look for a queue family dedicated to transfers so that staging uploads
+	//	can run on the DMA engine alongside graphics work //
+	for (uint64_t qfIndex = 0; static_cast<size_t>(qfIndex) < queueFamilyProps.size(); qfIndex++)
+	{
+		VkQueueFamilyProperties const& qfp = queueFamilyProps[qfIndex];
+		if (qfp.queueCount > 0 && 
+			(qfp.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+			!(qfp.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+		{
+			retVal.transferFamily = qfIndex;
+			break;
+		}
+	}
+	if (retVal.transferFamily == std::numeric_limits<uint64_t>::max())
+	{
+		// graphics queues always support transfers implicitly //
+		retVal.transferFamily = retVal.graphicsFamily;
+	}
+	return retVal;
+}
+k10::RenderWindow::SwapChainSupportDetails k10::RenderWindow::querySwapChainSupport(
+	VkPhysicalDevice pd) const
+{
+	SwapChainSupportDetails retVal;
+	// query capabilities //
+	{
+		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(pd, surface, &retVal.capabilities);
+	}
+	// query formats //
+	{
+		uint32_t formatCount;
+		vkGetPhysicalDeviceSurfaceFormatsKHR(pd, surface, &formatCount, nullptr);
+		if (formatCount > 0)
+		{
+			retVal.formats.resize(formatCount);
+			vkGetPhysicalDeviceSurfaceFormatsKHR(pd, 
+				surface, &formatCount, retVal.formats.data());
+		}
+	}
+	// query present modes //
+	{
+		uint32_t presentModeCount;
+		vkGetPhysicalDeviceSurfacePresentModesKHR(pd, surface, &presentModeCount, nullptr);
+		if (presentModeCount > 0)
+		{
+			retVal.presentModes.resize(presentModeCount);
+			vkGetPhysicalDeviceSurfacePresentModesKHR(pd, 
+				surface, &presentModeCount, retVal.presentModes.data());
+		}
+	}
+	return retVal;
+}
+VkExtent2D k10::RenderWindow::chooseSwapExtent(
+	VkSurfaceCapabilitiesKHR const& c) const
+{
+	if (c.currentExtent.width != 
+			numeric_limits<decltype(c.currentExtent.width)>::max())
+	{
+///		if (c.currentExtent.width == 0)
+///		{
+///			SDL_Log("uh oh...\n");
+///		}
+		return c.currentExtent;
+	}
+	int w, h;
+	SDL_Vulkan_GetDrawableSize(window, &w, &h);
+	return VkExtent2D{ 
+		clamp(static_cast<uint32_t>(w), 
+			  c.minImageExtent.width, c.maxImageExtent.width),
+		clamp(static_cast<uint32_t>(h),
+			  c.minImageExtent.height, c.maxImageExtent.height) };
+}
+VkPresentModeKHR k10::RenderWindow::chooseSwapPresentMode(
+	vector<VkPresentModeKHR>const& presentModes) const
+{
+	VkPresentModeKHR wantedMode = VK_PRESENT_MODE_FIFO_KHR;
+	switch (presentModePolicy)
+	{
+	case PresentModePolicy::FIFO:
+		wantedMode = VK_PRESENT_MODE_FIFO_KHR;
+		break;
+	case PresentModePolicy::FIFO_RELAXED:
+		wantedMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+		break;
+	case PresentModePolicy::MAILBOX:
+		wantedMode = VK_PRESENT_MODE_MAILBOX_KHR;
+		break;
+	case PresentModePolicy::IMMEDIATE:
+		wantedMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		break;
+	}
+	if (std::find(presentModes.begin(), presentModes.end(), wantedMode) !=
+		presentModes.end())
+	{
+		return wantedMode;
+	}
+	// otherwise just use double buffering v-sync, because it is guaranteed //
+	SDL_Log("Present mode %i isn't supported, falling back to FIFO\n",
+		static_cast<int>(wantedMode));
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+VkSurfaceFormatKHR k10::RenderWindow::chooseSwapSurfaceFormat(
+	vector<VkSurfaceFormatKHR>const& formats) const
+{
+	SDL_assert(!formats.empty());
+	for (VkSurfaceFormatKHR const& f : formats)
+	{
+		if (f.format == VK_FORMAT_R8G8B8A8_UNORM &&
+			f.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+		{
+			return f;
+		}
+	}
+	return formats[0];
+}
+k10::GfxPipeline* k10::RenderWindow::findGfxPipeline(GfxPipelineIndex gpi)
+{
+	for (GfxPipeline& gp : gfxPipelines)
+	{
+		if (gp.getGpi() == gpi)
+		{
+			return &gp;
+		}
+	}
+	return nullptr;
 }
\ No newline at end of file
@@ -1,121 +1,335 @@
-#pragma once
-#ifndef NDEBUG
-#define K10_ENABLE_VULKAN_VALIDATION_LAYERS
-#define K10_VULKAN_DEBUG_VERBOSE
-#endif
-#include "GfxProgram.h"
-#include "GfxPipeline.h"
-#include "QuadPool.h"
-namespace k10
-{
-	class RenderWindow
-	{
-	public:
-		static const GfxPipelineIndex MAX_PIPELINES = 50;
-		static RenderWindow* createRenderWindow(char const* title, 
-			int initialWidth, int initialHeight);
-	private:
-		static const int MAX_FRAMES_IN_FLIGHT;
-		struct SwapChainSupportDetails
-		{
-			VkSurfaceCapabilitiesKHR capabilities;
-			vector<VkSurfaceFormatKHR> formats;
-			vector<VkPresentModeKHR> presentModes;
-		};
-		struct QueueFamilyIndices
-		{
-			uint64_t graphicsFamily = std::numeric_limits<uint64_t>::max();
-			uint64_t presentFamily  = std::numeric_limits<uint64_t>::max();
-			bool isSuitable() const;
-			vector<uint64_t> toRawVector() const
-			{
-				return { graphicsFamily,
-						 presentFamily };
-			}
-			vector<uint32_t> toVkVector() const
-			{
-				return { static_cast<uint32_t>(graphicsFamily),
-						 static_cast<uint32_t>(presentFamily) };
-			}
-		};
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-		static VKAPI_ATTR VkBool32 VKAPI_CALL vulkanDebugMessengerCallback(
-			VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-			VkDebugUtilsMessageTypeFlagsEXT messageType,
-			const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
-			void* pUserData);
-#endif
-		static bool checkPhysicalDeviceExtensionSupport(
-			VkPhysicalDevice pd, vector<char const*>const& requiredExtensionNames);
-	public:
-		~RenderWindow();
-		bool recordCommandBuffers(GfxPipelineIndex gpi);
-		bool drawFrame();
-		void waitForOperationsToFinish();
-		void onWindowEvent(SDL_WindowEvent const& we);
-		// Draw pooled gfx interface //
-		QuadPool& getQuadPool();
-		// ///////////////////////////////// end draw pooled gfx interface //
-		// GfxPipeline interface //
-		GfxPipelineIndex createGfxPipeline(GfxProgram const* vertProgram,
-										   GfxProgram const* fragProgram);
-		// //////////////////////////////// end GfxPipeline interface //
-		// GfxProgram interface //
-		GfxProgram* createGfxProgram(GfxProgram::ShaderType st);
-///		VkDevice getDevice() const;
-		// /////////////////////////////// end GfxProgram interface //
-	private:
-		void cleanupSwapChain();
-		bool rebuildSwapChain();
-		bool createSwapChain();
-		bool createImageViews();
-		bool createRenderPass();
-		bool createFramebuffers();
-		bool createCommandBuffers();
-		QueueFamilyIndices findQueueFamilies(VkPhysicalDevice pd) const;
-		SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice pd) const;
-		VkExtent2D chooseSwapExtent(
-			VkSurfaceCapabilitiesKHR const& c) const;
-		VkPresentModeKHR chooseSwapPresentMode(
-			vector<VkPresentModeKHR>const& presentModes) const;
-		VkSurfaceFormatKHR chooseSwapSurfaceFormat(
-			vector<VkSurfaceFormatKHR>const& formats) const;
-		GfxPipeline* findGfxPipeline(GfxPipelineIndex gpi);
-		// Returns a uint32_t that represents the index of the physicalDevice's
-		//	memory types that satisfies the params.
-		// Returns 'numeric_limits<uint64_t>::max()' on failure.
-		uint64_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
-	private:
-		SDL_Window* window = nullptr;
-		bool windowResized = false;
-		bool windowMinimized = false;
-		VkInstance instance;
-		VkSurfaceKHR surface;
-		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-		VkDevice device;
-		VkQueue graphicsQueue;
-		VkQueue presentQueue;
-		VkSwapchainKHR swapChain;
-		vector<VkImage> swapChainImages;
-		VkFormat swapChainFormat;
-		VkExtent2D swapChainExtent;
-		vector<VkImageView> swapChainImageViews;
-		VkRenderPass renderPass;
-		vector<VkFramebuffer> swapChainFramebuffers;
-		VkCommandPool commandPool;
-		vector<VkCommandBuffer> commandBuffers;
-		uint32_t vertexBufferCount;
-		GfxBuffer vertexBuffer;
-		vector<VkSemaphore> imageAvailableSemaphores;
-		vector<VkSemaphore> renderFinishedSemaphores;
-		vector<VkFence> frameFences;
-		size_t currentFrame = 0;
-		GfxPipelineIndex nextGpi = 0;
-		vector<GfxPipeline> gfxPipelines;
-		GfxPipelineIndex gpiRecordedCommandBuffer;
-		QuadPool quadPool;
-#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
-		VkDebugUtilsMessengerEXT debugMessenger;
-#endif
-	};
-}
+#pragma once
+#ifndef NDEBUG
+#define K10_ENABLE_VULKAN_VALIDATION_LAYERS
+#define K10_VULKAN_DEBUG_VERBOSE
+#endif
+#include "GfxProgram.h"
+#include "GfxPipeline.h"
+#include "QuadPool.h"
+namespace k10
+{
+	class RenderWindow
+	{
+	public:
+		static const GfxPipelineIndex MAX_PIPELINES = 50;
+		static const uint32_t MAX_FRAMES_IN_FLIGHT;
+		static const uint32_t DEFAULT_FRAMES_IN_FLIGHT;
+		// The present mode the swap chain asks for.  FIFO gets used 
+		//	instead whenever the surface doesn't support it, since FIFO is
+		//	the only mode every surface has to support.
+		enum class PresentModePolicy : Uint8
+		{
+			// v-sync: frames queue up & the loop gets throttled to the 
+			//	refresh rate
+			FIFO,
+			// v-sync, except frames that miss a vblank get presented right
+			//	away, which can tear
+			FIFO_RELAXED,
+			// the newest frame gets presented at every vblank without 
+			//	tearing, but the GPU keeps rendering frames that get thrown
+			//	away unless the loop is paced
+			MAILBOX,
+			// no v-sync at all: the lowest latency, with tearing
+			IMMEDIATE
+		};
+		struct GfxMemoryStats
+		{
+			// false if the budgets are just estimates from the heap sizes
+			bool memoryBudgetSupported;
+			// indexed by memory heap
+			vector<GfxMemoryAllocator::HeapStats> heaps;
+			// device memory held by the quad pool & the vertex buffer
+			VkDeviceSize quadPoolBytes;
+			VkDeviceSize vertexBufferBytes;
+		};
+		// averages over the frames drawn between beginFrameTiming & 
+		//	endFrameTiming, in milliseconds
+		struct FrameTimingStats
+		{
+			uint32_t framesInFlight;
+			uint32_t swapChainImageCount;
+			size_t frameCount;
+			double frameMs;
+			// time drawFrame spent waiting on the frame fence, acquiring 
+			//	the next image & presenting it
+			double cpuBlockedMs;
+			// frameMs - cpuBlockedMs
+			double cpuBusyMs;
+			// between the first & last command of the frame on the GPU, or 
+			//	0 if the graphics queue doesn't support timestamps
+			double gpuBusyMs;
+			// How much of the shorter of cpuBusyMs & gpuBusyMs overlapped 
+			//	with the other, from 0 to 1.  It's a lower bound, since the 
+			//	two can only add up to more than frameMs by overlapping.
+			double overlap;
+		};
+		// If streamingQuadsPerFrame is 0, the quad pool doesn't get any 
+		//	streaming frames.  Otherwise the quads streamed into the pool 
+		//	between two drawFrame calls get drawn by the second one.
+		// framesInFlight is how many frames the CPU can record ahead of the
+		//	GPU: 1 for the lowest input latency, up to MAX_FRAMES_IN_FLIGHT
+		//	for the most throughput.  A swapChainImageCount of 0 asks for 
+		//	one more image than the surface needs, otherwise it gets 
+		//	clamped to what the surface supports.
+		static RenderWindow* createRenderWindow(char const* title, 
+			int initialWidth, int initialHeight,
+			QuadPool::DrawMode quadPoolDrawMode = QuadPool::DrawMode::INDEXED,
+			QuadPool::VertexFormat quadPoolVertexFormat = 
+				QuadPool::VertexFormat::FULL,
+			size_t streamingQuadsPerFrame = 0,
+			uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT,
+			uint32_t swapChainImageCount = 0,
+			PresentModePolicy presentModePolicy = PresentModePolicy::MAILBOX);
+	private:
+		struct SwapChainSupportDetails
+		{
+			VkSurfaceCapabilitiesKHR capabilities;
+			vector<VkSurfaceFormatKHR> formats;
+			vector<VkPresentModeKHR> presentModes;
+		};
+		struct QueueFamilyIndices
+		{
+			uint64_t graphicsFamily = std::numeric_limits<uint64_t>::max();
+			uint64_t presentFamily  = std::numeric_limits<uint64_t>::max();
+			// prefers a transfer-only family (dedicated DMA engine), and falls
+			//	back to the graphics family if the device doesn't have one
+			uint64_t transferFamily = std::numeric_limits<uint64_t>::max();
+			bool isSuitable() const;
+			vector<uint64_t> toRawVector() const
+			{
+				return { graphicsFamily,
+						 presentFamily,
+						 transferFamily };
+			}
+			vector<uint32_t> toVkVector() const
+			{
+				return { static_cast<uint32_t>(graphicsFamily),
+						 static_cast<uint32_t>(presentFamily),
+						 static_cast<uint32_t>(transferFamily) };
+			}
+		};
+		struct RecordThread
+		{
+			std::thread thread;
+			// one pool per frame in flight, and the secondary command 
+			//	buffers allocated from it so far, which get recycled every
+			//	time the pool gets reset
+			vector<VkCommandPool> frameCommandPools;
+			vector<vector<VkCommandBuffer>> frameCommandBuffers;
+			// # of the current frame's command buffers recorded so far
+			size_t usedCommandBufferCount;
+		};
+		struct RecordJob
+		{
+			// the quad pool chunks to draw, or the streamed quads if 
+			//	chunkCount is 0
+			size_t firstChunk;
+			size_t chunkCount;
+			// the secondary command buffer the job got recorded into
+			VkCommandBuffer commandBuffer;
+		};
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+		static VKAPI_ATTR VkBool32 VKAPI_CALL vulkanDebugMessengerCallback(
+			VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+			VkDebugUtilsMessageTypeFlagsEXT messageType,
+			const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+			void* pUserData);
+#endif
+		static bool checkPhysicalDeviceExtensionSupport(
+			VkPhysicalDevice pd, vector<char const*>const& requiredExtensionNames);
+	public:
+		~RenderWindow();
+		// The frame's commands get recorded at the start of every drawFrame,
+		//	so this takes effect with the next frame.  Nothing gets drawn
+		//	until a pipeline is set.
+		bool setDrawPipeline(GfxPipelineIndex gpi);
+		// With threadCount > 0, the frame's draws get recorded into 
+		//	secondary command buffers on threadCount worker threads (one per
+		//	quad pool chunk, plus one for the streamed quads), which the 
+		//	frame's command buffer then executes.  Every thread records out
+		//	of its own command pools.  0 records everything on the thread 
+		//	calling drawFrame.
+		// Waits for the device to go idle, since the old threads' command 
+		//	buffers might still be in use.
+		bool setRecordThreadCount(uint32_t threadCount);
+		uint32_t getRecordThreadCount() const;
+		// how long the last drawFrame took to record its command buffers
+		double getLastRecordMilliseconds() const;
+		// Waits for the device to go idle, and re-creates the command pools
+		//	& synchronization objects of every frame in flight.  The quads
+		//	streamed since the last drawFrame get thrown away.
+		bool setFramesInFlight(uint32_t framesInFlight);
+		uint32_t getFramesInFlight() const;
+		// Rebuilds the swap chain right away.  0 picks the default.
+		bool setSwapChainImageCount(uint32_t imageCount);
+		// the # of images the swap chain actually got
+		uint32_t getSwapChainImageCount() const;
+		// Rebuilds the swap chain right away.
+		bool setPresentModePolicy(PresentModePolicy pmp);
+		PresentModePolicy getPresentModePolicy() const;
+		// the present mode the swap chain actually got
+		VkPresentModeKHR getPresentMode() const;
+		// Frame timing //
+		// Starts measuring how long frames take on the CPU & GPU, and how 
+		//	much the two overlap.  GPU timestamps only get written while 
+		//	frames are being measured.
+		void beginFrameTiming();
+		FrameTimingStats endFrameTiming();
+		// ///////////////////////////////////////////// end frame timing //
+		bool drawFrame();
+		// Draws a frame the same way drawFrame does, except into an 
+		//	offscreen image the size of the swap chain, & copies its pixels
+		//	into outPixels row by row instead of presenting it.  Waits for 
+		//	the device to go idle first & for the frame to finish drawing.
+		//	Fails if the swap chain format isn't 8 bits per channel RGBA or
+		//	BGRA.
+		bool readbackFrame(vector<Uint32>& outPixels);
+		VkExtent2D getSwapChainExtent() const;
+		void waitForOperationsToFinish();
+		void onWindowEvent(SDL_WindowEvent const& we);
+		// Draw pooled gfx interface //
+		QuadPool& getQuadPool();
+		// ///////////////////////////////// end draw pooled gfx interface //
+		// logs the budget of every memory heap, and the usage & 
+		//	fragmentation of all gfx memory blocks
+		void logGfxMemoryStats() const;
+		// Heap budgets get refreshed at the start of every drawFrame.
+		GfxMemoryStats getGfxMemoryStats() const;
+		// A warning gets logged when a heap's usage reaches this fraction of
+		//	its budget, and HeapStats::nearBudget is set.
+		void setGfxMemoryBudgetWarningThreshold(float fractionOfBudget);
+		// GfxPipeline interface //
+		GfxPipelineIndex createGfxPipeline(GfxProgram const* vertProgram,
+										   GfxProgram const* fragProgram);
+		// //////////////////////////////// end GfxPipeline interface //
+		// GfxProgram interface //
+		GfxProgram* createGfxProgram(GfxProgram::ShaderType st);
+///		VkDevice getDevice() const;
+		// /////////////////////////////// end GfxProgram interface //
+	private:
+		void cleanupSwapChain();
+		bool rebuildSwapChain();
+		bool createSwapChain();
+		bool createImageViews();
+		bool createRenderPass(VkImageLayout finalLayout, 
+							  VkRenderPass& outRenderPass) const;
+		bool createFramebuffers();
+		// the command pools, command buffers, synchronization objects & 
+		//	timestamp queries of every frame in flight
+		bool createFrameResources();
+		void destroyFrameResources();
+		bool createCommandBuffers();
+		// Records the current frame's command buffer, which draws into 
+		//	framebuffer.  With readback, the frame is drawn with the 
+		//	readback render pass & then copied into readbackBuffer.
+		bool recordCommandBuffer(VkFramebuffer framebuffer, bool readback);
+		// the offscreen image & render pass readbackFrame draws with, 
+		//	which only get created once a frame is read back
+		bool createReadbackTarget();
+		void destroyReadbackTarget();
+		// Hands every RecordJob to the record threads & waits for all of 
+		//	them to be recorded.
+		bool recordSecondaryCommandBuffers(VkPipeline pipeline, 
+										   VkFramebuffer framebuffer);
+		void runRecordThread(size_t threadIndex, uint64_t generation);
+		bool recordJob(RecordThread& recordThread, RecordJob& job);
+		// joins the record threads & destroys their command pools
+		void stopRecordThreads();
+		QueueFamilyIndices findQueueFamilies(VkPhysicalDevice pd) const;
+		SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice pd) const;
+		VkExtent2D chooseSwapExtent(
+			VkSurfaceCapabilitiesKHR const& c) const;
+		VkPresentModeKHR chooseSwapPresentMode(
+			vector<VkPresentModeKHR>const& presentModes) const;
+		VkSurfaceFormatKHR chooseSwapSurfaceFormat(
+			vector<VkSurfaceFormatKHR>const& formats) const;
+		GfxPipeline* findGfxPipeline(GfxPipelineIndex gpi);
+	private:
+		SDL_Window* window = nullptr;
+		bool windowResized = false;
+		bool windowMinimized = false;
+		VkInstance instance;
+		VkSurfaceKHR surface;
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+		VkDevice device;
+		VkQueue graphicsQueue;
+		VkQueue presentQueue;
+		VkQueue transferQueue;
+		GfxMemoryAllocator gfxMemoryAllocator;
+		VkSwapchainKHR swapChain;
+		vector<VkImage> swapChainImages;
+		VkFormat swapChainFormat;
+		VkExtent2D swapChainExtent;
+		PresentModePolicy presentModePolicy;
+		VkPresentModeKHR swapChainPresentMode;
+		vector<VkImageView> swapChainImageViews;
+		VkRenderPass renderPass;
+		vector<VkFramebuffer> swapChainFramebuffers;
+		// one of each per frame in flight
+		vector<VkCommandPool> frameCommandPools;
+		vector<VkCommandBuffer> frameCommandBuffers;
+		uint32_t vertexBufferCount;
+		GfxBuffer vertexBuffer;
+		vector<VkSemaphore> imageAvailableSemaphores;
+		vector<VkSemaphore> renderFinishedSemaphores;
+		vector<VkFence> frameFences;
+		uint32_t framesInFlight;
+		size_t currentFrame = 0;
+		// 0 for the default
+		uint32_t requestedSwapChainImageCount;
+		GfxPipelineIndex nextGpi = 0;
+		vector<GfxPipeline> gfxPipelines;
+		GfxPipelineIndex drawGpi = MAX_PIPELINES;
+		QuadPool quadPool;
+		// Multithreaded recording //
+		// The record threads wait for recordGeneration to change, which 
+		//	means there are new recordJobs.  They pull jobs off of 
+		//	nextRecordJob until it runs out, and the last one to finish 
+		//	signals recordDoneCondition.
+		vector<RecordThread> recordThreads;
+		vector<RecordJob> recordJobs;
+		std::mutex recordMutex;
+		std::condition_variable recordCondition;
+		std::condition_variable recordDoneCondition;
+		uint64_t recordGeneration = 0;
+		size_t busyRecordThreadCount = 0;
+		bool quitRecordThreads = false;
+		std::atomic<size_t> nextRecordJob;
+		std::atomic<bool> recordJobFailed;
+		// what the secondary command buffers of the current frame draw with
+		VkPipeline recordPipeline = VK_NULL_HANDLE;
+		VkFramebuffer recordFramebuffer = VK_NULL_HANDLE;
+		// /////////////////////////////// end multithreaded recording //
+		double lastRecordMilliseconds = 0;
+		// Frame timing //
+		// two timestamps per frame in flight, bracketing its commands.  
+		//	Only created if the graphics queue supports timestamps.
+		VkQueryPool frameQueryPool = VK_NULL_HANDLE;
+		// nanoseconds per timestamp tick, or 0 without timestamp support
+		float timestampPeriod = 0.f;
+		Uint64 timestampMask = 0;
+		// set for the frames in flight whose timestamps haven't been read
+		vector<bool> frameTimestampsWritten;
+		bool frameTimingActive = false;
+		std::chrono::time_point<std::chrono::high_resolution_clock> 
+			frameTimingStart;
+		size_t timedFrameCount = 0;
+		double timedCpuBlockedMs = 0;
+		size_t timedGpuFrameCount = 0;
+		double timedGpuBusyMs = 0;
+		// ///////////////////////////////////////////// end frame timing //
+		// Readback //
+		// Same as renderPass, except it leaves the image ready to be copied.
+		//	The two are compatible, so the same pipelines draw in both.
+		VkRenderPass readbackRenderPass = VK_NULL_HANDLE;
+		VkImage readbackImage = VK_NULL_HANDLE;
+		VkDeviceMemory readbackImageMemory = VK_NULL_HANDLE;
+		VkImageView readbackImageView = VK_NULL_HANDLE;
+		VkFramebuffer readbackFramebuffer = VK_NULL_HANDLE;
+		GfxBuffer readbackBuffer;
+		// ///////////////////////////////////////////////// end readback //
+#ifdef K10_ENABLE_VULKAN_VALIDATION_LAYERS
+		VkDebugUtilsMessengerEXT debugMessenger;
+#endif
+	};
+}
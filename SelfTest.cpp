@@ -0,0 +1,632 @@
+#include "SelfTest.h"
+#include "RenderWindow.h"
+#include "RangeAllocator.h"
+#include "SlotAllocator.h"
+// logs description & clears passed if condition doesn't hold
+static void check(bool& passed, bool condition, char const* description)
+{
+	if (!condition)
+	{
+		SDL_Log("SELF TEST FAILED: %s\n", description);
+		passed = false;
+	}
+}
+// xorshift, so the random checks do the same thing on every run
+static Uint64 nextRandom(Uint64& state)
+{
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+bool k10::testRangeAllocator()
+{
+	using RangeId = RangeAllocator::RangeId;
+	using BinIndex = RangeAllocator::BinIndex;
+	const RangeId INVALID_RANGE = RangeAllocator::INVALID_RANGE;
+	bool passed = true;
+	RangeAllocator ra;
+	// the padding in front of an aligned range goes back to the free
+	//	lists, and gets merged with its neighbor once that is released //
+	ra.reset(4096);
+	const RangeId unaligned = ra.allocate(3, 1);
+	const RangeId aligned = ra.allocate(16, 256);
+	check(passed, unaligned != INVALID_RANGE && aligned != INVALID_RANGE &&
+		ra.getOffset(unaligned) == 0 && ra.getOffset(aligned) == 256,
+		"aligned ranges start at a multiple of their alignment");
+	check(passed, ra.getFreeRangeCount() == 2 && ra.getAllocatedSize() == 19,
+		"alignment padding is handed back as a free range");
+	ra.release(unaligned);
+	check(passed, ra.getFreeRangeCount() == 2,
+		"released ranges merge with the padding next to them");
+	const RangeId padding = ra.allocate(256, 1);
+	check(passed, padding != INVALID_RANGE && ra.getOffset(padding) == 0 &&
+		ra.getFreeRangeCount() == 1,
+		"merged padding gets handed out again");
+	// splitting & merging //
+	ra.reset(1000);
+	RangeId thirds[3];
+	for (RangeId& third : thirds)
+	{
+		third = ra.allocate(100, 1);
+	}
+	check(passed, ra.getOffset(thirds[2]) == 200 &&
+		ra.getFreeRangeCount() == 1 && ra.getAllocatedRangeCount() == 3,
+		"allocations get split off the front of the free range");
+	ra.release(thirds[1]);
+	check(passed, ra.getFreeRangeCount() == 2,
+		"a range between two allocated ones stays on its own");
+	ra.release(thirds[0]);
+	check(passed, ra.getFreeRangeCount() == 2 &&
+		ra.getLargestFreeRangeSize() == 700,
+		"a released range merges with the free range after it");
+	ra.release(thirds[2]);
+	check(passed, ra.getFreeRangeCount() == 1 &&
+		ra.getLargestFreeRangeSize() == 1000 &&
+		ra.getAllocatedSize() == 0 && ra.getAllocatedRangeCount() == 0,
+		"a released range merges with the free ranges on both sides");
+	// Requests about as big as the free range they fit in are only found
+	//	by scanning the bin of their exact size. //
+	const RangeId whole = ra.allocate(1000, 1);
+	check(passed, whole != INVALID_RANGE && ra.getOffset(whole) == 0 &&
+		ra.getFreeRangeCount() == 0,
+		"the exact bin scan finds a free range of exactly the right size");
+	ra.reset(1024);
+	ra.allocate(28, 1);
+	check(passed, ra.allocate(992, 64) == INVALID_RANGE &&
+		ra.getAllocatedRangeCount() == 1 && ra.getFreeRangeCount() == 1,
+		"the exact bin scan skips ranges that are too small once aligned");
+	const RangeId scanned = ra.allocate(992, 4);
+	check(passed, scanned != INVALID_RANGE && ra.getOffset(scanned) == 28,
+		"the exact bin scan finds a range that fits once aligned");
+	// findBinAtLeast has to land on the first bin whose smallest size is
+	//	at least the requested size, so every size up to
+	//	MAX_CHECKED_SIZE gets checked against the bin starts //
+	auto sameBin = [](BinIndex a, BinIndex b)->bool
+	{
+		return a.firstLevel == b.firstLevel &&
+			a.secondLevel == b.secondLevel;
+	};
+	const VkDeviceSize MAX_CHECKED_SIZE = 1 << 16;
+	vector<VkDeviceSize> nextBinStarts(MAX_CHECKED_SIZE + 1);
+	nextBinStarts[MAX_CHECKED_SIZE] = MAX_CHECKED_SIZE;
+	for (VkDeviceSize sz = MAX_CHECKED_SIZE - 1; sz > 0; sz--)
+	{
+		nextBinStarts[sz] =
+			sameBin(RangeAllocator::findBin(sz - 1),
+					RangeAllocator::findBin(sz)) ?
+			nextBinStarts[sz + 1] : sz;
+	}
+	bool roundedUp = true;
+	for (VkDeviceSize sz = 1; sz < MAX_CHECKED_SIZE && roundedUp; sz++)
+	{
+		roundedUp = sameBin(RangeAllocator::findBinAtLeast(sz),
+							RangeAllocator::findBin(nextBinStarts[sz]));
+	}
+	check(passed, roundedUp,
+		"findBinAtLeast rounds up to the next bin unless at a bin start");
+	check(passed, sameBin(RangeAllocator::findBinAtLeast(
+			numeric_limits<VkDeviceSize>::max()),
+		RangeAllocator::findBin(numeric_limits<VkDeviceSize>::max())),
+		"findBinAtLeast doesn't overflow on the biggest size");
+	// fragmentation stats //
+	ra.reset(1024);
+	RangeId eighths[8];
+	for (RangeId& eighth : eighths)
+	{
+		eighth = ra.allocate(128, 1);
+	}
+	ra.release(eighths[1]);
+	ra.release(eighths[3]);
+	ra.release(eighths[5]);
+	check(passed, ra.getFreeRangeCount() == 3 &&
+		ra.getLargestFreeRangeSize() == 128 &&
+		ra.getAllocatedSize() == 640 && ra.getAllocatedRangeCount() == 5,
+		"holes between allocations are counted as separate free ranges");
+	ra.release(eighths[2]);
+	check(passed, ra.getFreeRangeCount() == 2 &&
+		ra.getLargestFreeRangeSize() == 384 &&
+		ra.getSize() - ra.getAllocatedSize() == 512,
+		"filling in a hole merges the free ranges around it");
+	// random allocations must never overlap, & releasing all of them has
+	//	to leave a single free range again //
+	struct LiveRange
+	{
+		RangeId rid;
+		VkDeviceSize offset;
+		VkDeviceSize size;
+	};
+	vector<LiveRange> liveRanges;
+	Uint64 randomState = 0x9E3779B97F4A7C15;
+	bool inBounds = true;
+	ra.reset(1 << 20);
+	for (int i = 0; i < 10000; i++)
+	{
+		if (liveRanges.empty() || nextRandom(randomState) % 3 != 0)
+		{
+			const VkDeviceSize sz = 1 + nextRandom(randomState) % 4096;
+			const VkDeviceSize alignment =
+				VkDeviceSize(1) << (nextRandom(randomState) % 9);
+			const RangeId rid = ra.allocate(sz, alignment);
+			if (rid == INVALID_RANGE)
+			{
+				continue;
+			}
+			const VkDeviceSize offset = ra.getOffset(rid);
+			inBounds = inBounds && offset % alignment == 0 &&
+				offset + sz <= ra.getSize();
+			liveRanges.push_back({ rid, offset, sz });
+		}
+		else
+		{
+			const size_t r = static_cast<size_t>(
+				nextRandom(randomState) % liveRanges.size());
+			ra.release(liveRanges[r].rid);
+			liveRanges[r] = liveRanges.back();
+			liveRanges.pop_back();
+		}
+	}
+	check(passed, inBounds,
+		"random ranges are aligned & inside of the address range");
+	std::sort(liveRanges.begin(), liveRanges.end(),
+		[](LiveRange const& a, LiveRange const& b)
+		{
+			return a.offset < b.offset;
+		});
+	VkDeviceSize liveSize = 0;
+	bool overlapped = false;
+	for (size_t r = 0; r < liveRanges.size(); r++)
+	{
+		liveSize += liveRanges[r].size;
+		overlapped = overlapped || (r > 0 &&
+			liveRanges[r - 1].offset + liveRanges[r - 1].size >
+				liveRanges[r].offset);
+	}
+	check(passed, !overlapped, "random ranges never overlap");
+	check(passed, ra.getAllocatedSize() == liveSize &&
+		ra.getAllocatedRangeCount() == liveRanges.size(),
+		"allocated stats match the random ranges");
+	for (LiveRange const& liveRange : liveRanges)
+	{
+		ra.release(liveRange.rid);
+	}
+	check(passed, ra.getFreeRangeCount() == 1 &&
+		ra.getLargestFreeRangeSize() == ra.getSize() &&
+		ra.getAllocatedSize() == 0,
+		"releasing every random range leaves a single free range");
+	return passed;
+}
+bool k10::testPackedVertexFormat()
+{
+	bool passed = true;
+	// every packed value has to come back out as itself //
+	bool snormRoundTrips = true;
+	for (int v = -32767; v <= 32767 && snormRoundTrips; v++)
+	{
+		snormRoundTrips = 
+			packSnorm16(unpackSnorm16(static_cast<Sint16>(v))) == v;
+	}
+	check(passed, snormRoundTrips, "packed positions unpack to themselves");
+	bool unormRoundTrips = true;
+	for (Uint32 v = 0; v < 256 && unormRoundTrips; v++)
+	{
+		const Uint32 packedColor = v | (v << 8) | (v << 16) | (v << 24);
+		unormRoundTrips = 
+			packUnorm8Color(unpackUnorm8Color(packedColor)) == packedColor;
+	}
+	check(passed, unormRoundTrips, "packed colors unpack to themselves");
+	// packing rounds to the nearest step, so nothing inside of the range 
+	//	gets moved by more than half a step (give or take float error) //
+	const int SAMPLE_COUNT = 1 << 20;
+	const float MAX_POSITION_ERROR = 0.5f / 32767 + 1e-6f;
+	const float MAX_COLOR_ERROR = 0.5f / 255 + 1e-6f;
+	float positionError = 0;
+	float colorError = 0;
+	for (int i = 0; i <= SAMPLE_COUNT; i++)
+	{
+		const float position = -1.f + 2.f*i / SAMPLE_COUNT;
+		positionError = glm::max(positionError, 
+			glm::abs(unpackSnorm16(packSnorm16(position)) - position));
+		const glm::vec4 color(float(i) / SAMPLE_COUNT, 
+			1.f - float(i) / SAMPLE_COUNT, 0.5f*i / SAMPLE_COUNT, 1.f);
+		const glm::vec4 colorDelta = 
+			glm::abs(unpackUnorm8Color(packUnorm8Color(color)) - color);
+		colorError = glm::max(colorError, glm::max(
+			glm::max(colorDelta.r, colorDelta.g), 
+			glm::max(colorDelta.b, colorDelta.a)));
+	}
+	SDL_Log("packed vertex format: max position error=%e (1/%lf), "
+		"max color error=%e (1/%lf)\n", positionError, 1 / positionError,
+		colorError, 1 / colorError);
+	check(passed, positionError <= MAX_POSITION_ERROR,
+		"packed positions are off by at most half of 1/32767");
+	check(passed, colorError <= MAX_COLOR_ERROR,
+		"packed colors are off by at most half of 1/255");
+	// anything outside of the range gets clamped to it //
+	check(passed, packSnorm16(2.f) == 32767 && packSnorm16(-2.f) == -32767 &&
+		unpackSnorm16(-32768) == -1.f,
+		"packed positions are clamped to [-1,1]");
+	check(passed, packUnorm8Color(glm::vec4(2.f, -1.f, 1.f, 0.f)) == 
+		0x00FF00FF, "packed colors are clamped to [0,1]");
+	return passed;
+}
+bool k10::benchmarkSlotAllocator()
+{
+	using SlotIndex = SlotAllocator::SlotIndex;
+	const size_t SLOT_COUNT = 1000000;
+	const size_t PAIR_COUNT = 1000000;
+	const double OCCUPANCIES[] = { 0.1, 0.9, 0.999 };
+	bool passed = true;
+	SlotAllocator sa;
+	Uint64 randomState = 0x9E3779B97F4A7C15;
+	for (double occupancy : OCCUPANCIES)
+	{
+		// fill every slot, then release random ones until the pool is only
+		//	as full as the benchmark wants, so the free slots are scattered
+		//	the way they would be after a while of adding & removing quads //
+		sa.reset(SLOT_COUNT);
+		vector<SlotIndex> liveSlots(SLOT_COUNT);
+		for (SlotIndex& slot : liveSlots)
+		{
+			slot = sa.allocate();
+		}
+		for (size_t s = SLOT_COUNT - 1; s > 0; s--)
+		{
+			std::swap(liveSlots[s], liveSlots[
+				static_cast<size_t>(nextRandom(randomState) % (s + 1))]);
+		}
+		const size_t liveCount = static_cast<size_t>(SLOT_COUNT * occupancy);
+		for (size_t s = liveCount; s < SLOT_COUNT; s++)
+		{
+			sa.release(liveSlots[s]);
+		}
+		liveSlots.resize(liveCount);
+		// the random picks are made up front so they don't get timed //
+		vector<size_t> picks(PAIR_COUNT);
+		for (size_t& pick : picks)
+		{
+			pick = static_cast<size_t>(nextRandom(randomState) % liveCount);
+		}
+		// each pair removes a random live slot & adds one back, so the
+		//	occupancy stays the same for the whole run //
+		bool reusedReleasedSlot = true;
+		const std::chrono::time_point<std::chrono::high_resolution_clock> 
+			start = std::chrono::high_resolution_clock::now();
+		for (size_t pick : picks)
+		{
+			const SlotIndex released = liveSlots[pick];
+			sa.release(released);
+			const SlotIndex allocated = sa.allocate();
+			// the lowest free slot is at or below the one just released
+			reusedReleasedSlot = reusedReleasedSlot && allocated <= released;
+			liveSlots[pick] = allocated;
+		}
+		const double pairMs = 
+			std::chrono::duration_cast<std::chrono::duration<double,
+				std::milli>>(std::chrono::high_resolution_clock::now() - 
+							 start).count();
+		check(passed, reusedReleasedSlot,
+			"allocate hands out the lowest free slot");
+		check(passed, sa.getAllocatedCount() == liveCount,
+			"adding & removing slots keeps the allocated count");
+		SDL_Log("slots: occupancy=%lf%% slots=%i pairs=%i ms=%lf "
+			"ns/pair=%lf pairs/s=%lf\n", occupancy * 100, 
+			static_cast<int>(SLOT_COUNT), static_cast<int>(PAIR_COUNT), 
+			pairMs, pairMs * 1000000 / PAIR_COUNT, 
+			PAIR_COUNT / (pairMs / 1000));
+	}
+	return passed;
+}
+// A window that draws its quad pool with the simple-draw shaders, for the
+//	self tests that read back what got drawn.  The programs get deleted 
+//	before the window, same as main does it.
+struct TestWindow
+{
+	k10::RenderWindow* renderWindow = nullptr;
+	vector<k10::GfxProgram*> programs;
+	~TestWindow()
+	{
+		if (renderWindow)
+		{
+			renderWindow->waitForOperationsToFinish();
+		}
+		for (k10::GfxProgram* program : programs)
+		{
+			delete program;
+		}
+		delete renderWindow;
+	}
+};
+// with gpuCulling, the window's pool also gets the quad-cull pipeline, 
+//	which starts out turned on
+static bool createTestWindow(TestWindow& tw, 
+							 k10::QuadPool::DrawMode drawMode,
+							 k10::QuadPool::VertexFormat vertexFormat,
+							 bool gpuCulling)
+{
+	tw.renderWindow = k10::RenderWindow::createRenderWindow(
+		"SDL-Vulkan-Test self test", 640, 480, drawMode, vertexFormat);
+	if (!tw.renderWindow)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, 
+			"Failed to create self test RenderWindow!\n");
+		return false;
+	}
+	k10::GfxProgram*const vertProgram = tw.renderWindow->createGfxProgram(
+		k10::GfxProgram::ShaderType::VERTEX);
+	tw.programs.push_back(vertProgram);
+	k10::GfxProgram*const fragProgram = tw.renderWindow->createGfxProgram(
+		k10::GfxProgram::ShaderType::FRAGMENT);
+	tw.programs.push_back(fragProgram);
+	if (!vertProgram->loadFromFile(
+			drawMode == k10::QuadPool::DrawMode::INSTANCED ?
+				"shader-bin/simple-draw-instanced-vert.spv" :
+				"shader-bin/simple-draw-vert.spv") ||
+		!fragProgram->loadFromFile("shader-bin/simple-draw-frag.spv"))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+			"Failed to load the simple-draw shaders!\n");
+		return false;
+	}
+	if (gpuCulling)
+	{
+		k10::GfxProgram*const cullProgram = 
+			tw.renderWindow->createGfxProgram(
+				k10::GfxProgram::ShaderType::COMPUTE);
+		tw.programs.push_back(cullProgram);
+		if (!cullProgram->loadFromFile("shader-bin/quad-cull-comp.spv") ||
+			!tw.renderWindow->getQuadPool().createCullPipeline(cullProgram))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+				"Failed to create quad pool cull pipeline!\n");
+			return false;
+		}
+	}
+	const k10::GfxPipelineIndex gpi = 
+		tw.renderWindow->createGfxPipeline(vertProgram, fragProgram);
+	return gpi != k10::RenderWindow::MAX_PIPELINES &&
+		tw.renderWindow->setDrawPipeline(gpi);
+}
+// Adds the same random quads to the window's pool every time, on top of 
+//	each other, & then removes every REMOVED_QUAD_STRIDE-th one again.  
+//	Their corners are on pixel edges, which are half a pixel away from the
+//	nearest pixel center, so quantising PACKED positions never changes 
+//	which pixels a quad covers.  With offScreenQuads, some of them are 
+//	partly or entirely off screen.
+static bool addTestQuads(k10::RenderWindow& rw, bool offScreenQuads)
+{
+	const size_t TEST_QUAD_COUNT = 2000;
+	const size_t REMOVED_QUAD_STRIDE = 7;
+	struct TestQuad
+	{
+		// left, top, right, bottom
+		glm::vec4 rect;
+		glm::vec4 cornerColors[4];
+	};
+	const VkExtent2D extent = rw.getSwapChainExtent();
+	Uint64 randomState = 0x9E3779B97F4A7C15;
+	// a quad's edges in pixels, inside of [0, pixelCount] unless it's 
+	//	allowed to go off screen by up to a quarter of the screen //
+	auto randomEdges = [&](Sint64 pixelCount, Sint64& outMin, Sint64& outMax)
+	{
+		const Sint64 size = 1 + static_cast<Sint64>(
+			nextRandom(randomState) % static_cast<Uint64>(pixelCount/4));
+		outMin = offScreenQuads ?
+			static_cast<Sint64>(nextRandom(randomState) % 
+				static_cast<Uint64>(pixelCount*3/2)) - pixelCount/4 - size/2 :
+			static_cast<Sint64>(nextRandom(randomState) % 
+				static_cast<Uint64>(pixelCount - size + 1));
+		outMax = outMin + size;
+	};
+	vector<TestQuad> testQuads(TEST_QUAD_COUNT);
+	for (TestQuad& testQuad : testQuads)
+	{
+		Sint64 left, top, right, bottom;
+		randomEdges(extent.width, left, right);
+		randomEdges(extent.height, top, bottom);
+		testQuad.rect = { -1 + 2.f*left / extent.width, 
+						  -1 + 2.f*top / extent.height,
+						  -1 + 2.f*right / extent.width, 
+						  -1 + 2.f*bottom / extent.height };
+		// colors PACKED can store exactly //
+		for (glm::vec4& color : testQuad.cornerColors)
+		{
+			color = glm::vec4(nextRandom(randomState) % 256, 
+							  nextRandom(randomState) % 256,
+							  nextRandom(randomState) % 256, 255) / 255.f;
+		}
+	}
+	k10::QuadPool& quadPool = rw.getQuadPool();
+	vector<k10::QuadPool::QuadId> quadIds;
+	const bool added = 
+		quadPool.getDrawMode() == k10::QuadPool::DrawMode::INSTANCED ?
+		quadPool.addQuadInstances(testQuads.size(),
+			[&](size_t i, k10::QuadInstance& instance)->void
+			{
+				instance.rect = testQuads[i].rect;
+				instance.depth = 0.f;
+				for (int c = 0; c < 4; c++)
+				{
+					instance.cornerColors[c] = 
+						k10::packUnorm8Color(testQuads[i].cornerColors[c]);
+				}
+			}, &quadIds) :
+		quadPool.addQuads(testQuads.size(),
+			[&](size_t i, k10::Vertex* quadVertices)->void
+			{
+				const glm::vec4& rect = testQuads[i].rect;
+				glm::vec4 const*const colors = testQuads[i].cornerColors;
+				quadVertices[0] = {{rect.x, rect.w}, colors[0]};
+				quadVertices[1] = {{rect.x, rect.y}, colors[1]};
+				quadVertices[2] = {{rect.z, rect.y}, colors[2]};
+				quadVertices[3] = {{rect.z, rect.w}, colors[3]};
+			}, &quadIds);
+	if (!added)
+	{
+		return false;
+	}
+	for (size_t q = 0; q < quadIds.size(); q += REMOVED_QUAD_STRIDE)
+	{
+		quadPool.removeQuad(quadIds[q]);
+	}
+	return true;
+}
+// the # of pixels that have a channel which is off by more than 
+//	maxChannelDifference between a & b
+static size_t countDifferentPixels(vector<Uint32> const& a, 
+								   vector<Uint32> const& b, 
+								   int maxChannelDifference)
+{
+	SDL_assert(a.size() == b.size());
+	size_t differentPixelCount = 0;
+	for (size_t p = 0; p < a.size(); p++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			const int channelA = (a[p] >> 8*c) & 0xFF;
+			const int channelB = (b[p] >> 8*c) & 0xFF;
+			if (std::abs(channelA - channelB) > maxChannelDifference)
+			{
+				differentPixelCount++;
+				break;
+			}
+		}
+	}
+	return differentPixelCount;
+}
+// the # of pixels that aren't the clear color, so that a frame with nothing
+//	drawn into it doesn't pass a comparison by accident
+static size_t countDrawnPixels(vector<Uint32> const& pixels)
+{
+	// opaque black is the same in RGBA & BGRA //
+	const Uint32 CLEAR_PIXEL = 0xFF000000;
+	return pixels.size() - 
+		std::count(pixels.begin(), pixels.end(), CLEAR_PIXEL);
+}
+bool k10::testPackedVertexFormatRendering()
+{
+	using DrawMode = QuadPool::DrawMode;
+	using VertexFormat = QuadPool::VertexFormat;
+	bool passed = true;
+	// INSTANCED pools don't store vertices //
+	const DrawMode DRAW_MODES[] = { DrawMode::VERTEX_LIST, DrawMode::INDEXED };
+	const VertexFormat VERTEX_FORMATS[] = { 
+		VertexFormat::FULL, VertexFormat::PACKED };
+	for (DrawMode drawMode : DRAW_MODES)
+	{
+		vector<Uint32> framePixels[2];
+		VkExtent2D frameExtents[2];
+		for (int f = 0; f < 2; f++)
+		{
+			TestWindow tw;
+			if (!createTestWindow(tw, drawMode, VERTEX_FORMATS[f], false) ||
+				!addTestQuads(*tw.renderWindow, false) ||
+				!tw.renderWindow->readbackFrame(framePixels[f]))
+			{
+				check(passed, false, "the test quads get drawn & read back");
+				return passed;
+			}
+			frameExtents[f] = tw.renderWindow->getSwapChainExtent();
+		}
+		if (frameExtents[0].width != frameExtents[1].width ||
+			frameExtents[0].height != frameExtents[1].height)
+		{
+			check(passed, false, "both windows get the same swap chain size");
+			return passed;
+		}
+		const size_t drawnPixelCount = countDrawnPixels(framePixels[0]);
+		const size_t differentPixelCount = 
+			countDifferentPixels(framePixels[0], framePixels[1], 1);
+		SDL_Log("packed vertex format rendering: draw mode=%i pixels=%i "
+			"drawn=%i different=%i\n", static_cast<int>(drawMode),
+			static_cast<int>(framePixels[0].size()),
+			static_cast<int>(drawnPixelCount),
+			static_cast<int>(differentPixelCount));
+		check(passed, drawnPixelCount > 0, "FULL quads get drawn");
+		check(passed, differentPixelCount == 0,
+			"PACKED quads cover the same pixels as FULL quads, with colors "
+			"that are off by at most 1/255");
+	}
+	return passed;
+}
+bool k10::testGpuCullingRendering()
+{
+	using DrawMode = QuadPool::DrawMode;
+	bool passed = true;
+	const DrawMode DRAW_MODES[] = { 
+		DrawMode::VERTEX_LIST, DrawMode::INDEXED, DrawMode::INSTANCED };
+	for (DrawMode drawMode : DRAW_MODES)
+	{
+		// both frames come out of the same window, so they are drawn from
+		//	the same pool at the same size //
+		TestWindow tw;
+		vector<Uint32> framePixels[2];
+		if (!createTestWindow(tw, drawMode, QuadPool::VertexFormat::FULL, 
+							  true) ||
+			!addTestQuads(*tw.renderWindow, true))
+		{
+			check(passed, false, "the test quads get added");
+			return passed;
+		}
+		QuadPool& quadPool = tw.renderWindow->getQuadPool();
+		for (int f = 0; f < 2; f++)
+		{
+			quadPool.setGpuCulling(f == 1);
+			if (!tw.renderWindow->readbackFrame(framePixels[f]))
+			{
+				check(passed, false, "the test quads get drawn & read back");
+				return passed;
+			}
+		}
+		const size_t drawnPixelCount = countDrawnPixels(framePixels[0]);
+		const size_t differentPixelCount = 
+			countDifferentPixels(framePixels[0], framePixels[1], 0);
+		SDL_Log("GPU culling rendering: draw mode=%i pixels=%i drawn=%i "
+			"different=%i\n", static_cast<int>(drawMode),
+			static_cast<int>(framePixels[0].size()),
+			static_cast<int>(drawnPixelCount),
+			static_cast<int>(differentPixelCount));
+		check(passed, drawnPixelCount > 0, "unculled quads get drawn");
+		check(passed, differentPixelCount == 0,
+			"culled quads get drawn in the same order & the same pixels as "
+			"unculled quads");
+	}
+	return passed;
+}
+struct SelfTest
+{
+	char const* name;
+	bool (*run)();
+};
+// runs every self test in selfTests & logs which ones failed
+static bool runSelfTestList(SelfTest const* selfTests, size_t selfTestCount)
+{
+	bool passed = true;
+	for (size_t t = 0; t < selfTestCount; t++)
+	{
+		const bool selfTestPassed = selfTests[t].run();
+		SDL_Log("Self test %s: %s\n", selfTests[t].name,
+				selfTestPassed ? "passed" : "FAILED");
+		passed = passed && selfTestPassed;
+	}
+	return passed;
+}
+bool k10::runSelfTests()
+{
+	const SelfTest selfTests[] = {
+		{ "RangeAllocator", testRangeAllocator },
+		{ "packed vertex format", testPackedVertexFormat },
+		{ "SlotAllocator benchmark", benchmarkSlotAllocator }
+	};
+	return runSelfTestList(selfTests, 
+		sizeof(selfTests) / sizeof(selfTests[0]));
+}
+bool k10::runGpuSelfTests()
+{
+	const SelfTest selfTests[] = {
+		{ "packed vertex format rendering", testPackedVertexFormatRendering },
+		{ "GPU culling rendering", testGpuCullingRendering }
+	};
+	return runSelfTestList(selfTests, 
+		sizeof(selfTests) / sizeof(selfTests[0]));
+}
\ No newline at end of file
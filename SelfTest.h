@@ -0,0 +1,32 @@
+#pragma once
+namespace k10
+{
+	// Checks of the parts of the renderer that don't need a GPU, which get
+	//	run instead of opening a window when the program is started with 
+	//	--self-test.  Each one logs every check that failed, & returns 
+	//	false if any of them did.
+	bool testRangeAllocator();
+	// Round trips positions & colors through the VertexFormat::PACKED 
+	//	conversions, & checks they stay within the documented quantisation
+	//	error.  This doesn't read anything back from the GPU.
+	bool testPackedVertexFormat();
+	// Times removing a random slot & adding one back, 1M times each with
+	//	the SlotAllocator 10%, 90% & 99.9% full, & logs the time per pair.
+	bool benchmarkSlotAllocator();
+	// runs every self test & logs which ones failed
+	bool runSelfTests();
+	// Checks that draw quads & compare the frames read back from a 
+	//	RenderWindow, which get run instead of the main loop when the 
+	//	program is started with --gpu-self-test.  They need a display, a 
+	//	Vulkan device (a software driver such as lavapipe will do), & the
+	//	shaders in shader-bin.
+	// Draws the same quads into a FULL & a PACKED pool, & checks that the 
+	//	frames only differ by the quantisation of the colors.
+	bool testPackedVertexFormatRendering();
+	// Draws overlapping quads, some of them partly or entirely off screen,
+	//	with GPU culling off & then on, & checks that the frames are 
+	//	identical in every draw mode.
+	bool testGpuCullingRendering();
+	// runs every GPU self test & logs which ones failed
+	bool runGpuSelfTests();
+}
@@ -0,0 +1,230 @@
+#include "SlotAllocator.h"
+const k10::SlotAllocator::SlotIndex k10::SlotAllocator::INVALID_SLOT =
+	numeric_limits<k10::SlotAllocator::SlotIndex>::max();
+// the lowest bitCount bits of a word, or all of them if bitCount >= 64
+static Uint64 lowBitMask(size_t bitCount)
+{
+	return bitCount >= 64 ?
+		numeric_limits<Uint64>::max() : (Uint64(1) << bitCount) - 1;
+}
+void k10::SlotAllocator::reset(size_t sc)
+{
+	SDL_assert(sc < static_cast<size_t>(INVALID_SLOT));
+	slotCount = sc;
+	allocatedCount = 0;
+	freeBitLevels.clear();
+	allocatedBitLevels.clear();
+	// build each level of the bitmap hierarchy with every slot marked as
+	//	free, making sure the bits past the end of each level stay clear so
+	//	they never get picked by allocate //
+	size_t levelBitCount = slotCount;
+	do
+	{
+		const size_t wordCount = (levelBitCount + 63) / 64;
+		vector<Uint64> level(wordCount > 0 ? wordCount : 1, 0);
+		for (size_t w = 0; w < wordCount; w++)
+		{
+			level[w] = lowBitMask(levelBitCount - w*64);
+		}
+		freeBitLevels.push_back(level);
+		levelBitCount = wordCount;
+	} while (levelBitCount > 1);
+	// nothing is allocated yet //
+	for (size_t l = 1; l < freeBitLevels.size(); l++)
+	{
+		allocatedBitLevels.push_back(
+			vector<Uint64>(freeBitLevels[l].size(), 0));
+	}
+}
+void k10::SlotAllocator::resize(size_t sc)
+{
+	SDL_assert(findLastAllocated(static_cast<SlotIndex>(slotCount)) == 
+			   INVALID_SLOT ||
+		findLastAllocated(static_cast<SlotIndex>(slotCount)) < sc);
+	const vector<Uint64> oldFreeBits = 
+		freeBitLevels.empty() ? vector<Uint64>() : freeBitLevels[0];
+	const size_t oldSlotCount = slotCount;
+	const size_t oldAllocatedCount = allocatedCount;
+	reset(sc);
+	// clear the bits of the slots that were allocated before.  Bits past 
+	//	the old end were always clear, so they have to be treated as free //
+	vector<Uint64>& slotLevel = freeBitLevels[0];
+	const size_t keptWordCount = std::min(oldFreeBits.size(), slotLevel.size());
+	for (size_t w = 0; w < keptWordCount; w++)
+	{
+		slotLevel[w] &= oldFreeBits[w] | ~lowBitMask(oldSlotCount - w*64);
+	}
+	// every level above is rebuilt from scratch to match //
+	for (size_t l = 1; l < freeBitLevels.size(); l++)
+	{
+		vector<Uint64> const& lowerLevel = freeBitLevels[l - 1];
+		vector<Uint64>& level = freeBitLevels[l];
+		for (Uint64& word : level)
+		{
+			word = 0;
+		}
+		for (size_t w = 0; w < lowerLevel.size(); w++)
+		{
+			if (lowerLevel[w] != 0)
+			{
+				level[w / 64] |= Uint64(1) << (w % 64);
+			}
+		}
+	}
+	// & so is the allocated slot hierarchy //
+	for (size_t l = 0; l < allocatedBitLevels.size(); l++)
+	{
+		vector<Uint64>& level = allocatedBitLevels[l];
+		const size_t lowerWordCount = l == 0 ? 
+			slotLevel.size() : allocatedBitLevels[l - 1].size();
+		for (size_t w = 0; w < lowerWordCount; w++)
+		{
+			if (getAllocatedBits(l, w) != 0)
+			{
+				level[w / 64] |= Uint64(1) << (w % 64);
+			}
+		}
+	}
+	allocatedCount = oldAllocatedCount;
+}
+k10::SlotAllocator::SlotIndex k10::SlotAllocator::allocate()
+{
+	if (allocatedCount >= slotCount)
+	{
+		return INVALID_SLOT;
+	}
+	// walk down from the top level following the lowest word that still
+	//	has a free bit //
+	size_t index = 0;
+	for (size_t l = freeBitLevels.size(); l > 0; l--)
+	{
+		index = index*64 + lowestSetBit(freeBitLevels[l - 1][index]);
+	}
+	// mark the slot as allocated, and propagate the change up the hierarchy
+	//	for as long as we are filling up words //
+	size_t bitIndex = index;
+	for (vector<Uint64>& level : freeBitLevels)
+	{
+		Uint64& word = level[bitIndex / 64];
+		word &= ~(Uint64(1) << (bitIndex % 64));
+		if (word != 0)
+		{
+			break;
+		}
+		bitIndex /= 64;
+	}
+	// flag the slot's word as having an allocated slot, up to the first 
+	//	level that already knew //
+	size_t wordIndex = index / 64;
+	for (vector<Uint64>& level : allocatedBitLevels)
+	{
+		Uint64& word = level[wordIndex / 64];
+		const bool wordWasEmpty = word == 0;
+		word |= Uint64(1) << (wordIndex % 64);
+		if (!wordWasEmpty)
+		{
+			break;
+		}
+		wordIndex /= 64;
+	}
+	allocatedCount++;
+	return static_cast<SlotIndex>(index);
+}
+void k10::SlotAllocator::release(SlotIndex s)
+{
+	SDL_assert(isAllocated(s));
+	size_t bitIndex = s;
+	for (vector<Uint64>& level : freeBitLevels)
+	{
+		Uint64& word = level[bitIndex / 64];
+		const bool wordWasFull = word == 0;
+		word |= Uint64(1) << (bitIndex % 64);
+		if (!wordWasFull)
+		{
+			break;
+		}
+		bitIndex /= 64;
+	}
+	// unflag the slot's word if that was its last allocated slot, up to the
+	//	first level that still has something allocated below it //
+	if (getAllocatedBits(0, s / 64) == 0)
+	{
+		size_t wordIndex = s / 64;
+		for (vector<Uint64>& level : allocatedBitLevels)
+		{
+			Uint64& word = level[wordIndex / 64];
+			word &= ~(Uint64(1) << (wordIndex % 64));
+			if (word != 0)
+			{
+				break;
+			}
+			wordIndex /= 64;
+		}
+	}
+	allocatedCount--;
+}
+bool k10::SlotAllocator::isAllocated(SlotIndex s) const
+{
+	if (static_cast<size_t>(s) >= slotCount)
+	{
+		return false;
+	}
+	return (freeBitLevels[0][s / 64] & (Uint64(1) << (s % 64))) == 0;
+}
+k10::SlotAllocator::SlotIndex k10::SlotAllocator::findLastAllocated(
+	SlotIndex endSlot) const
+{
+	if (static_cast<size_t>(endSlot) > slotCount)
+	{
+		endSlot = static_cast<SlotIndex>(slotCount);
+	}
+	if (endSlot == 0 || allocatedCount == 0)
+	{
+		return INVALID_SLOT;
+	}
+	// Climb up from the slot level until a word has an allocated bit at or
+	//	before the one we're at, moving to the word before the current one
+	//	on every level up... //
+	size_t l = 0;
+	size_t index = endSlot - 1;
+	while (true)
+	{
+		const Uint64 allocatedBits = getAllocatedBits(l, index / 64) &
+			lowBitMask(index % 64 + 1);
+		if (allocatedBits != 0)
+		{
+			index = (index / 64)*64 + highestSetBit(allocatedBits);
+			break;
+		}
+		if (index < 64)
+		{
+			return INVALID_SLOT;
+		}
+		index = index / 64 - 1;
+		l++;
+	}
+	// ...then walk back down following the highest allocated bits //
+	while (l > 0)
+	{
+		l--;
+		index = index*64 + highestSetBit(getAllocatedBits(l, index));
+	}
+	return static_cast<SlotIndex>(index);
+}
+size_t k10::SlotAllocator::getAllocatedCount() const
+{
+	return allocatedCount;
+}
+size_t k10::SlotAllocator::getSlotCount() const
+{
+	return slotCount;
+}
+Uint64 k10::SlotAllocator::getAllocatedBits(size_t l, size_t w) const
+{
+	if (l > 0)
+	{
+		return allocatedBitLevels[l - 1][w];
+	}
+	// the free bits past the last slot are clear, but aren't allocated //
+	return ~freeBitLevels[0][w] & lowBitMask(slotCount - w*64);
+}
\ No newline at end of file
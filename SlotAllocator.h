@@ -0,0 +1,50 @@
+#pragma once
+namespace k10
+{
+	// Keeps track of which slots in a resizable array are in use.  Slots are
+	//	tracked by a hierarchy of bitmaps where each bit in a level represents
+	//	whether or not the matching 64-bit word in the level below it has any
+	//	free slots left, so both allocation & release only touch one word per
+	//	level (4 levels for a 1e6 slot pool).  A second hierarchy of the same
+	//	shape tracks which words have any allocated slots, so finding the 
+	//	last allocated slot also only touches a couple of words per level.
+	// Allocation always returns the lowest free slot, which keeps the
+	//	populated slots packed towards the front of the array.
+	class SlotAllocator
+	{
+	public:
+		using SlotIndex = uint32_t;
+		static const SlotIndex INVALID_SLOT;
+	public:
+		void reset(size_t slotCount);
+		// Changes the # of slots while keeping every allocated slot 
+		//	allocated.  Every slot at or past slotCount must be free.
+		void resize(size_t slotCount);
+		// Returns INVALID_SLOT if every slot is already allocated.
+		SlotIndex allocate();
+		void release(SlotIndex s);
+		bool isAllocated(SlotIndex s) const;
+		// Returns the highest allocated slot that is less than endSlot, or
+		//	INVALID_SLOT if there aren't any.
+		SlotIndex findLastAllocated(SlotIndex endSlot) const;
+		size_t getAllocatedCount() const;
+		size_t getSlotCount() const;
+	private:
+		// the allocated bits of word w in level l of the allocated slot 
+		//	hierarchy, where level 0 is the slots themselves
+		Uint64 getAllocatedBits(size_t l, size_t w) const;
+	private:
+		// freeBitLevels[0] contains one bit per slot, set when the slot is
+		//	free.  freeBitLevels[l] contains one bit per word in level l-1,
+		//	set when that word has at least one free bit.  The last level is
+		//	always a single word.
+		vector<vector<Uint64>> freeBitLevels;
+		// allocatedBitLevels[l] contains one bit per word in level l of 
+		//	freeBitLevels (or l-1 of allocatedBitLevels), set when that word
+		//	has at least one allocated slot below it.  It has one level less
+		//	than freeBitLevels.
+		vector<vector<Uint64>> allocatedBitLevels;
+		size_t slotCount = 0;
+		size_t allocatedCount = 0;
+	};
+}
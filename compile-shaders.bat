@@ -1,3 +1,5 @@
-mkdir shader-bin
-%VULKAN_SDK%\Bin32\glslc.exe shaders\simple-draw.vert -o shader-bin\simple-draw-vert.spv
-%VULKAN_SDK%\Bin32\glslc.exe shaders\simple-draw.frag -o shader-bin\simple-draw-frag.spv
\ No newline at end of file
+mkdir shader-bin
+%VULKAN_SDK%\Bin32\glslc.exe shaders\simple-draw.vert -o shader-bin\simple-draw-vert.spv
+%VULKAN_SDK%\Bin32\glslc.exe shaders\simple-draw-instanced.vert -o shader-bin\simple-draw-instanced-vert.spv
+%VULKAN_SDK%\Bin32\glslc.exe shaders\simple-draw.frag -o shader-bin\simple-draw-frag.spv
+%VULKAN_SDK%\Bin32\glslc.exe shaders\quad-cull.comp -o shader-bin\quad-cull-comp.spv
\ No newline at end of file
@@ -1,183 +1,533 @@
-// Using code from post about SDL2 + Vulkan:
-//	https://www.gamedev.net/forums/topic/699117-vulkan-with-sdl2-getting-started/
-// And following the tutorial located at:
-//	https://vulkan-tutorial.com
-#include "RenderWindow.h"
-#include "GfxProgram.h"
-k10::RenderWindow* renderWindow = nullptr;
-k10::GfxProgram* gProgVert = nullptr;
-k10::GfxProgram* gProgFrag = nullptr;
-k10::GfxPipelineIndex gGpi;
-void cleanup()
-{
-	if (renderWindow)
-	{
-		renderWindow->waitForOperationsToFinish();
-	}
-	if (gProgVert)
-	{
-		delete gProgVert;
-		gProgVert = nullptr;
-	}
-	if (gProgFrag)
-	{
-		delete gProgFrag;
-		gProgFrag = nullptr;
-	}
-	if (renderWindow)
-	{
-		delete renderWindow;
-		renderWindow = nullptr;
-	}
-	SDL_Quit();
-}
-int main(int argc, char** argv)
-{
-	bool exit = false;
-	SDL_Event event;
-	if (SDL_Init(SDL_INIT_GAMECONTROLLER | SDL_INIT_VIDEO) != 0)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to init SDL! error='%s'\n", SDL_GetError());
-		return EXIT_FAILURE;
-	}
-#ifndef NDEBUG
-	SDL_LogSetPriority(SDL_LOG_CATEGORY_VIDEO, SDL_LOG_PRIORITY_DEBUG);
-	SDL_LogSetPriority(SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_DEBUG);
-#endif
-	renderWindow = k10::RenderWindow::createRenderWindow("SDL-Vulkan-Test", 1280, 720);
-	if (!renderWindow)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR, 
-			"Failed to create RenderWindow!\n");
-		cleanup();
-		return EXIT_FAILURE;
-	}
-	gProgVert = renderWindow->createGfxProgram(k10::GfxProgram::ShaderType::VERTEX);
-	SDL_assert(gProgVert);
-	gProgFrag = renderWindow->createGfxProgram(k10::GfxProgram::ShaderType::FRAGMENT);
-	SDL_assert(gProgFrag);
-	if (!gProgVert->loadFromFile("shader-bin/simple-draw-vert.spv"))
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
-			"Failed to load vertex shader!\n");
-		cleanup();
-		return EXIT_FAILURE;
-	}
-	if (!gProgFrag->loadFromFile("shader-bin/simple-draw-frag.spv"))
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
-			"Failed to load fragment shader!\n");
-		cleanup();
-		return EXIT_FAILURE;
-	}
-	gGpi = renderWindow->createGfxPipeline(gProgVert, gProgFrag);
-	if (gGpi == k10::RenderWindow::MAX_PIPELINES)
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
-			"Failed to create gfx pipeline!\n");
-		cleanup();
-		return EXIT_FAILURE;
-	}
-	const int NUM_QUADS = 1000000;
-	const int QUAD_ROWS = (int)sqrt(NUM_QUADS);
-	const int QUAD_COLS = (int)sqrt(NUM_QUADS);
-	const float QUAD_W = 2.f / QUAD_ROWS;
-	const float QUAD_H = 2.f / QUAD_ROWS;
-	for (int i = 0; i < NUM_QUADS; i++)
-	{
-		const int row = i / QUAD_COLS;
-		const int col = i % QUAD_COLS;
-		const float quadLeft = -1 + col * QUAD_W;
-		const float quadTop  = -1 + row * QUAD_H;
-		const float quadRight  = quadLeft + QUAD_W;
-		const float quatBottom = quadTop  + QUAD_H;
-		const vector<k10::Vertex> vertices = {
-			{{quadLeft , quatBottom}, {1.f, 0.f, 0.f, 1.f}},
-			{{quadLeft , quadTop   }, {1.f, 1.f, 0.f, 1.f}},
-			{{quadRight, quadTop   }, {0.f, 0.f, 1.f, 1.f}},
-			{{quadRight, quadTop   }, {0.f, 0.f, 1.f, 1.f}},
-			{{quadRight, quatBottom}, {0.f, 1.f, 0.f, 1.f}},
-			{{quadLeft , quatBottom}, {1.f, 0.f, 0.f, 1.f}}
-		};
-		const k10::QuadPool::QuadId testQuadId =
-			renderWindow->getQuadPool().addQuad(vertices);
-		SDL_assert(testQuadId != numeric_limits<k10::QuadPool::QuadId>::max());
-	}
-	if (!renderWindow->recordCommandBuffers(gGpi))
-	{
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
-			"Failed to record command buffers!\n");
-		cleanup();
-		return EXIT_FAILURE;
-	}
-	std::chrono::time_point<std::chrono::high_resolution_clock> frameTimePointPrev =
-		std::chrono::high_resolution_clock::now();
-	std::chrono::duration<double> frameAccumulator = 
-		std::chrono::duration<double>(0);
-	while (!exit)
-	{
-		while (SDL_PollEvent(&event))
-		{
-			switch (event.type)
-			{
-			case SDL_EventType::SDL_WINDOWEVENT:
-				renderWindow->onWindowEvent(event.window);
-				break;
-			case SDL_EventType::SDL_KEYDOWN:
-				switch (event.key.keysym.sym)
-				{
-				case SDLK_ESCAPE:
-					exit = true;
-					break;
-				}
-				break;
-			case SDL_EventType::SDL_QUIT:
-				exit = true;
-				break;
-			}
-		}
-		if (exit)
-		{
-			break;
-		}
-		const std::chrono::time_point<std::chrono::high_resolution_clock> now =
-			std::chrono::high_resolution_clock::now();
-		const std::chrono::duration<double> frameDelta =
-			std::chrono::duration_cast<std::chrono::duration<double>>(
-				now - frameTimePointPrev);
-		frameTimePointPrev = now;
-		frameAccumulator += frameDelta;
-		int logicTicks = 0;
-		while (frameAccumulator >= k10::FIXED_SECONDS_PER_FRAME)
-		{
-			///TODO: @fix-your-timestep
-			///	previousState = currentState;
-			// MAIN LOOP LOGIC //
-			{
-			}
-			logicTicks++;
-			frameAccumulator -= k10::FIXED_SECONDS_PER_FRAME;
-		}
-		///TODO: @fix-your-timestep
-		///	const float interFrameRatio = 
-		///		frameAccumulator.count() / 
-		///			k10::FIXED_SECONDS_PER_FRAME.count();
-		///	const state = previousState*(1 - interFrameRatio) + 
-		///				  currentState*interFrameRatio
-		if (!renderWindow->drawFrame())
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "drawFrame failure!\n");
-			cleanup();
-			return EXIT_FAILURE;
-		}
-		if (logicTicks >= 1)
-		{
-			SDL_Log("ms=%lf l=%i\n",
-				std::chrono::duration_cast<std::chrono::duration<double,
-					std::milli>>(frameDelta).count(),
-				logicTicks);
-		}
-	}
-	cleanup();
-	return EXIT_SUCCESS;
+// Using code from post about SDL2 + Vulkan:
+//	https://www.gamedev.net/forums/topic/699117-vulkan-with-sdl2-getting-started/
+// And following the tutorial located at:
+//	https://vulkan-tutorial.com
+#include "RenderWindow.h"
+#include "GfxProgram.h"
+#include "FramePacer.h"
+#include "SelfTest.h"
+k10::RenderWindow* renderWindow = nullptr;
+k10::GfxProgram* gProgVert = nullptr;
+k10::GfxProgram* gProgFrag = nullptr;
+k10::GfxProgram* gProgCull = nullptr;
+k10::GfxPipelineIndex gGpi;
+void cleanup()
+{
+	if (renderWindow)
+	{
+		renderWindow->waitForOperationsToFinish();
+	}
+	if (gProgVert)
+	{
+		delete gProgVert;
+		gProgVert = nullptr;
+	}
+	if (gProgFrag)
+	{
+		delete gProgFrag;
+		gProgFrag = nullptr;
+	}
+	if (gProgCull)
+	{
+		delete gProgCull;
+		gProgCull = nullptr;
+	}
+	if (renderWindow)
+	{
+		delete renderWindow;
+		renderWindow = nullptr;
+	}
+	SDL_Quit();
+}
+// Adds, updates & removes quadCount quads through 1, 2, 4, 8 & 16 
+//	QuadPool::Producers on their own threads, flushing the pool between 
+//	runs, & logs how long each run took.
+bool benchmarkQuadProducers(k10::QuadPool& quadPool, size_t quadCount)
+{
+	const glm::vec4 BENCH_COLORS[] = {
+		{1.f, 1.f, 1.f, 1.f},
+		{1.f, 1.f, 1.f, 1.f},
+		{1.f, 1.f, 1.f, 1.f},
+		{1.f, 1.f, 1.f, 1.f} };
+	const bool instanced = 
+		quadPool.getDrawMode() == k10::QuadPool::DrawMode::INSTANCED;
+	auto produceQuads = [&](size_t threadQuadCount)->void
+	{
+		k10::QuadPool::Producer producer(quadPool);
+		vector<k10::QuadPool::QuadId> quadIds;
+		quadIds.reserve(threadQuadCount);
+		// off screen, so the benchmark doesn't show up between runs //
+		const glm::vec4 rect = { 2.f, 2.f, 2.1f, 2.1f };
+		const bool added = instanced ?
+			producer.addQuadInstances(threadQuadCount,
+				[&](size_t, k10::QuadInstance& instance)->void
+				{
+					instance.rect = rect;
+					instance.depth = 0.f;
+					for (int c = 0; c < 4; c++)
+					{
+						instance.cornerColors[c] = 
+							k10::packUnorm8Color(BENCH_COLORS[c]);
+					}
+				}, &quadIds) :
+			producer.addQuads(threadQuadCount,
+				[&](size_t, k10::Vertex* quadVertices)->void
+				{
+					quadVertices[0] = {{rect.x, rect.w}, BENCH_COLORS[0]};
+					quadVertices[1] = {{rect.x, rect.y}, BENCH_COLORS[1]};
+					quadVertices[2] = {{rect.z, rect.y}, BENCH_COLORS[2]};
+					quadVertices[3] = {{rect.z, rect.w}, BENCH_COLORS[3]};
+				}, &quadIds);
+		SDL_assert(added);
+		k10::QuadInstance instance;
+		instance.rect = rect;
+		instance.depth = 0.f;
+		for (int c = 0; c < 4; c++)
+		{
+			instance.cornerColors[c] = k10::packUnorm8Color(BENCH_COLORS[c]);
+		}
+		for (k10::QuadPool::QuadId qid : quadIds)
+		{
+			if (instanced)
+			{
+				producer.updateQuadInstance(qid, instance);
+			}
+			else
+			{
+				producer.updateQuadColors(qid, BENCH_COLORS);
+			}
+		}
+		for (k10::QuadPool::QuadId qid : quadIds)
+		{
+			producer.removeQuad(qid);
+		}
+	};
+	for (size_t threadCount = 1; threadCount <= 16; threadCount *= 2)
+	{
+		const std::chrono::time_point<std::chrono::high_resolution_clock> 
+			start = std::chrono::high_resolution_clock::now();
+		vector<std::thread> threads;
+		threads.reserve(threadCount);
+		for (size_t t = 0; t < threadCount; t++)
+		{
+			// the first threads pick up the remainder //
+			threads.emplace_back(produceQuads, quadCount / threadCount + 
+				(t < quadCount % threadCount ? 1 : 0));
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		const double produceMs = 
+			std::chrono::duration_cast<std::chrono::duration<double,
+				std::milli>>(std::chrono::high_resolution_clock::now() - 
+							 start).count();
+		// the frame merges every producer's changes into the pool //
+		if (!renderWindow->drawFrame())
+		{
+			return false;
+		}
+		SDL_Log("producers: threads=%i quads=%i ms=%lf quads/s=%lf\n",
+			static_cast<int>(threadCount), static_cast<int>(quadCount), 
+			produceMs, quadCount / (produceMs / 1000));
+	}
+	return true;
+}
+// Draws frameCount frames while recording their commands inline & then
+//	on 1, 2, 4, 8 & 16 record threads, & logs the average time it took to
+//	record a frame with each.  The record thread count gets restored at 
+//	the end.
+bool benchmarkCommandRecording(int frameCount)
+{
+	const uint32_t prevThreadCount = renderWindow->getRecordThreadCount();
+	for (uint32_t threadCount = 0; threadCount <= 16; 
+		 threadCount = threadCount == 0 ? 1 : threadCount * 2)
+	{
+		if (!renderWindow->setRecordThreadCount(threadCount))
+		{
+			return false;
+		}
+		double recordMs = 0;
+		for (int f = 0; f < frameCount; f++)
+		{
+			if (!renderWindow->drawFrame())
+			{
+				return false;
+			}
+			recordMs += renderWindow->getLastRecordMilliseconds();
+		}
+		SDL_Log("recording: threads=%i chunks=%i ms/frame=%lf\n",
+			static_cast<int>(threadCount), 
+			static_cast<int>(
+				renderWindow->getQuadPool().getChunkSlotCount()),
+			recordMs / frameCount);
+	}
+	return renderWindow->setRecordThreadCount(prevThreadCount);
+}
+// Draws frameCount frames with every # of frames in flight from 1 up to
+//	the max, & logs how long the CPU & GPU were busy each frame, & how 
+//	much the two overlapped.  The # of frames in flight gets restored at 
+//	the end.
+bool benchmarkFramesInFlight(int frameCount)
+{
+	const uint32_t prevFramesInFlight = renderWindow->getFramesInFlight();
+	for (uint32_t framesInFlight = 1; 
+		 framesInFlight <= k10::RenderWindow::MAX_FRAMES_IN_FLIGHT; 
+		 framesInFlight++)
+	{
+		if (!renderWindow->setFramesInFlight(framesInFlight))
+		{
+			return false;
+		}
+		// let the CPU get ahead of the GPU before measuring anything //
+		for (uint32_t f = 0; f < framesInFlight; f++)
+		{
+			if (!renderWindow->drawFrame())
+			{
+				return false;
+			}
+		}
+		renderWindow->beginFrameTiming();
+		for (int f = 0; f < frameCount; f++)
+		{
+			if (!renderWindow->drawFrame())
+			{
+				return false;
+			}
+		}
+		const k10::RenderWindow::FrameTimingStats stats = 
+			renderWindow->endFrameTiming();
+		SDL_Log("frames in flight=%i swap chain images=%i: frame ms=%lf "
+				"cpu busy ms=%lf cpu blocked ms=%lf gpu busy ms=%lf "
+				"overlap=%.1lf%%\n",
+			static_cast<int>(stats.framesInFlight),
+			static_cast<int>(stats.swapChainImageCount),
+			stats.frameMs, stats.cpuBusyMs, stats.cpuBlockedMs, 
+			stats.gpuBusyMs, stats.overlap*100);
+	}
+	return renderWindow->setFramesInFlight(prevFramesInFlight);
+}
+int main(int argc, char** argv)
+{
+	bool exit = false;
+	SDL_Event event;
+	// the self tests don't need a window or a GPU //
+	if (argc > 1 && strcmp(argv[1], "--self-test") == 0)
+	{
+		return k10::runSelfTests() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if (SDL_Init(SDL_INIT_GAMECONTROLLER | SDL_INIT_VIDEO) != 0)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to init SDL! error='%s'\n", SDL_GetError());
+		return EXIT_FAILURE;
+	}
+#ifndef NDEBUG
+	SDL_LogSetPriority(SDL_LOG_CATEGORY_VIDEO, SDL_LOG_PRIORITY_DEBUG);
+	SDL_LogSetPriority(SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_DEBUG);
+#endif
+	if (argc > 1 && strcmp(argv[1], "--gpu-self-test") == 0)
+	{
+		const bool passed = k10::runGpuSelfTests();
+		SDL_Quit();
+		return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	const k10::QuadPool::DrawMode QUAD_POOL_DRAW_MODE = 
+		k10::QuadPool::DrawMode::INDEXED;
+	const k10::QuadPool::VertexFormat QUAD_POOL_VERTEX_FORMAT =
+		k10::QuadPool::VertexFormat::FULL;
+	// the most quads streamed in a single frame //
+	const int MAX_STREAMING_QUADS = 10000;
+	// What the main loop gets paced to, so that it doesn't spin at 
+	//	uncapped frame rates with MAILBOX or IMMEDIATE present modes.  0 
+	//	turns pacing off.
+	const std::chrono::duration<double> PACED_FRAME_TIME = 
+		std::chrono::duration<double>(1) / 60;
+	k10::FramePacer framePacer;
+	framePacer.setTargetFrameTime(PACED_FRAME_TIME);
+	renderWindow = k10::RenderWindow::createRenderWindow("SDL-Vulkan-Test", 
+		1280, 720, QUAD_POOL_DRAW_MODE, QUAD_POOL_VERTEX_FORMAT,
+		MAX_STREAMING_QUADS);
+	if (!renderWindow)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, 
+			"Failed to create RenderWindow!\n");
+		cleanup();
+		return EXIT_FAILURE;
+	}
+	gProgVert = renderWindow->createGfxProgram(k10::GfxProgram::ShaderType::VERTEX);
+	SDL_assert(gProgVert);
+	gProgFrag = renderWindow->createGfxProgram(k10::GfxProgram::ShaderType::FRAGMENT);
+	SDL_assert(gProgFrag);
+	// instanced quads have to expand their corners in the vertex shader //
+	if (!gProgVert->loadFromFile(
+			QUAD_POOL_DRAW_MODE == k10::QuadPool::DrawMode::INSTANCED ?
+				"shader-bin/simple-draw-instanced-vert.spv" :
+				"shader-bin/simple-draw-vert.spv"))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+			"Failed to load vertex shader!\n");
+		cleanup();
+		return EXIT_FAILURE;
+	}
+	if (!gProgFrag->loadFromFile("shader-bin/simple-draw-frag.spv"))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+			"Failed to load fragment shader!\n");
+		cleanup();
+		return EXIT_FAILURE;
+	}
+	gGpi = renderWindow->createGfxPipeline(gProgVert, gProgFrag);
+	if (gGpi == k10::RenderWindow::MAX_PIPELINES)
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+			"Failed to create gfx pipeline!\n");
+		cleanup();
+		return EXIT_FAILURE;
+	}
+	gProgCull = renderWindow->createGfxProgram(k10::GfxProgram::ShaderType::COMPUTE);
+	SDL_assert(gProgCull);
+	if (!gProgCull->loadFromFile("shader-bin/quad-cull-comp.spv") ||
+		!renderWindow->getQuadPool().createCullPipeline(gProgCull))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+			"Failed to create quad pool cull pipeline!\n");
+		cleanup();
+		return EXIT_FAILURE;
+	}
+	const int NUM_QUADS = 1000000;
+	const int QUAD_ROWS = (int)sqrt(NUM_QUADS);
+	const int QUAD_COLS = (int)sqrt(NUM_QUADS);
+	const float QUAD_W = 2.f / QUAD_ROWS;
+	const float QUAD_H = 2.f / QUAD_ROWS;
+	const glm::vec4 CORNER_COLORS[] = {
+		{1.f, 0.f, 0.f, 1.f},
+		{1.f, 1.f, 0.f, 1.f},
+		{0.f, 0.f, 1.f, 1.f},
+		{0.f, 1.f, 0.f, 1.f} };
+	auto quadRect = [&](size_t i)->glm::vec4
+	{
+		const int row = static_cast<int>(i) / QUAD_COLS;
+		const int col = static_cast<int>(i) % QUAD_COLS;
+		const float quadLeft = -1 + col * QUAD_W;
+		const float quadTop  = -1 + row * QUAD_H;
+		return { quadLeft, quadTop, quadLeft + QUAD_W, quadTop + QUAD_H };
+	};
+	const bool quadsAdded = 
+		QUAD_POOL_DRAW_MODE == k10::QuadPool::DrawMode::INSTANCED ?
+		renderWindow->getQuadPool().addQuadInstances(NUM_QUADS,
+			[&](size_t i, k10::QuadInstance& instance)->void
+			{
+				instance.rect = quadRect(i);
+				instance.depth = 0.f;
+				for (int c = 0; c < 4; c++)
+				{
+					instance.cornerColors[c] = 
+						k10::packUnorm8Color(CORNER_COLORS[c]);
+				}
+			}) :
+		renderWindow->getQuadPool().addQuads(NUM_QUADS,
+			[&](size_t i, k10::Vertex* quadVertices)->void
+			{
+				const glm::vec4 rect = quadRect(i);
+				quadVertices[0] = {{rect.x, rect.w}, CORNER_COLORS[0]};
+				quadVertices[1] = {{rect.x, rect.y}, CORNER_COLORS[1]};
+				quadVertices[2] = {{rect.z, rect.y}, CORNER_COLORS[2]};
+				quadVertices[3] = {{rect.z, rect.w}, CORNER_COLORS[3]};
+			});
+	SDL_assert(quadsAdded);
+	if (!renderWindow->setDrawPipeline(gGpi))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+			"Failed to set the draw pipeline!\n");
+		cleanup();
+		return EXIT_FAILURE;
+	}
+	std::chrono::time_point<std::chrono::high_resolution_clock> frameTimePointPrev =
+		std::chrono::high_resolution_clock::now();
+	const std::chrono::time_point<std::chrono::high_resolution_clock> 
+		startTimePoint = frameTimePointPrev;
+	std::chrono::duration<double> frameAccumulator = 
+		std::chrono::duration<double>(0);
+	while (!exit)
+	{
+		// the wait goes before input gets sampled, so the input is as fresh
+		//	as it can be by the time the frame gets drawn //
+		framePacer.waitForNextFrame();
+		while (SDL_PollEvent(&event))
+		{
+			switch (event.type)
+			{
+			case SDL_EventType::SDL_WINDOWEVENT:
+				renderWindow->onWindowEvent(event.window);
+				break;
+			case SDL_EventType::SDL_KEYDOWN:
+				switch (event.key.keysym.sym)
+				{
+				case SDLK_ESCAPE:
+					exit = true;
+					break;
+				case SDLK_m:
+					renderWindow->logGfxMemoryStats();
+					break;
+				case SDLK_b:
+					if (!benchmarkQuadProducers(renderWindow->getQuadPool(), 
+												NUM_QUADS / 4))
+					{
+						SDL_LogError(SDL_LOG_CATEGORY_ERROR, 
+							"drawFrame failure!\n");
+						cleanup();
+						return EXIT_FAILURE;
+					}
+					break;
+				case SDLK_r:
+					if (!benchmarkCommandRecording(120))
+					{
+						SDL_LogError(SDL_LOG_CATEGORY_ERROR, 
+							"drawFrame failure!\n");
+						cleanup();
+						return EXIT_FAILURE;
+					}
+					break;
+				case SDLK_l:
+					if (!benchmarkFramesInFlight(240))
+					{
+						SDL_LogError(SDL_LOG_CATEGORY_ERROR, 
+							"drawFrame failure!\n");
+						cleanup();
+						return EXIT_FAILURE;
+					}
+					break;
+				case SDLK_p:
+				{
+					// cycles through every present mode policy //
+					const k10::RenderWindow::PresentModePolicy pmp =
+						static_cast<k10::RenderWindow::PresentModePolicy>(
+							(static_cast<int>(
+								renderWindow->getPresentModePolicy()) + 1) % 
+							(static_cast<int>(k10::RenderWindow::
+								PresentModePolicy::IMMEDIATE) + 1));
+					if (!renderWindow->setPresentModePolicy(pmp))
+					{
+						SDL_LogError(SDL_LOG_CATEGORY_ERROR, 
+							"Failed to set present mode policy!\n");
+						cleanup();
+						return EXIT_FAILURE;
+					}
+					SDL_Log("present mode policy=%i present mode=%i\n",
+						static_cast<int>(pmp), 
+						static_cast<int>(renderWindow->getPresentMode()));
+				} break;
+				case SDLK_f:
+					framePacer.setTargetFrameTime(
+						framePacer.getTargetFrameTime() > 
+							std::chrono::duration<double>(0) ?
+						std::chrono::duration<double>(0) : PACED_FRAME_TIME);
+					SDL_Log("frame pacing %s\n", 
+						framePacer.getTargetFrameTime() > 
+							std::chrono::duration<double>(0) ? "on" : "off");
+					break;
+				case SDLK_c:
+				{
+					k10::QuadPool& quadPool = renderWindow->getQuadPool();
+					quadPool.setGpuCulling(!quadPool.isGpuCullingEnabled());
+					SDL_Log("GPU culling %s\n", 
+						quadPool.isGpuCullingEnabled() ? "on" : "off");
+				} break;
+				}
+				break;
+			case SDL_EventType::SDL_QUIT:
+				exit = true;
+				break;
+			}
+		}
+		if (exit)
+		{
+			break;
+		}
+		const std::chrono::time_point<std::chrono::high_resolution_clock> now =
+			std::chrono::high_resolution_clock::now();
+		const std::chrono::duration<double> frameDelta =
+			std::chrono::duration_cast<std::chrono::duration<double>>(
+				now - frameTimePointPrev);
+		frameTimePointPrev = now;
+		frameAccumulator += frameDelta;
+		int logicTicks = 0;
+		while (frameAccumulator >= k10::FIXED_SECONDS_PER_FRAME)
+		{
+			///TODO: @fix-your-timestep
+			///	previousState = currentState;
+			// MAIN LOOP LOGIC //
+			{
+			}
+			logicTicks++;
+			frameAccumulator -= k10::FIXED_SECONDS_PER_FRAME;
+		}
+		// STREAMING QUADS //
+		// a spiral of quads that changes its size & quad count every frame, 
+		//	which never has to go through the quad pool's uploads //
+		{
+			const float seconds = static_cast<float>(
+				std::chrono::duration_cast<std::chrono::duration<double>>(
+					now - startTimePoint).count());
+			const size_t streamingQuadCount = static_cast<size_t>(
+				MAX_STREAMING_QUADS*(0.5f + 0.5f*sinf(seconds)));
+			const float STREAMING_QUAD_SIZE = 0.01f;
+			auto spiralRect = [&](size_t i)->glm::vec4
+			{
+				const float t = static_cast<float>(i) / MAX_STREAMING_QUADS;
+				const float angle = 40*t + seconds;
+				const glm::vec2 center = 0.9f*t*glm::vec2(cosf(angle), 
+														  sinf(angle));
+				return { center.x - STREAMING_QUAD_SIZE, 
+						 center.y - STREAMING_QUAD_SIZE,
+						 center.x + STREAMING_QUAD_SIZE, 
+						 center.y + STREAMING_QUAD_SIZE };
+			};
+			k10::QuadPool& quadPool = renderWindow->getQuadPool();
+			const bool quadsStreamed = 
+				QUAD_POOL_DRAW_MODE == k10::QuadPool::DrawMode::INSTANCED ?
+				quadPool.addStreamingQuadInstances(streamingQuadCount,
+					[&](size_t i, k10::QuadInstance& instance)->void
+					{
+						instance.rect = spiralRect(i);
+						instance.depth = 0.f;
+						for (int c = 0; c < 4; c++)
+						{
+							instance.cornerColors[c] = 
+								k10::packUnorm8Color(CORNER_COLORS[3 - c]);
+						}
+					}) :
+				quadPool.addStreamingQuads(streamingQuadCount,
+					[&](size_t i, k10::Vertex* quadVertices)->void
+					{
+						const glm::vec4 rect = spiralRect(i);
+						quadVertices[0] = {{rect.x, rect.w}, CORNER_COLORS[3]};
+						quadVertices[1] = {{rect.x, rect.y}, CORNER_COLORS[2]};
+						quadVertices[2] = {{rect.z, rect.y}, CORNER_COLORS[1]};
+						quadVertices[3] = {{rect.z, rect.w}, CORNER_COLORS[0]};
+					});
+			SDL_assert(quadsStreamed);
+		}
+		///TODO: @fix-your-timestep
+		///	const float interFrameRatio = 
+		///		frameAccumulator.count() / 
+		///			k10::FIXED_SECONDS_PER_FRAME.count();
+		///	const state = previousState*(1 - interFrameRatio) + 
+		///				  currentState*interFrameRatio
+		if (!renderWindow->drawFrame())
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "drawFrame failure!\n");
+			cleanup();
+			return EXIT_FAILURE;
+		}
+		if (logicTicks >= 1)
+		{
+			SDL_Log("ms=%lf l=%i\n",
+				std::chrono::duration_cast<std::chrono::duration<double,
+					std::milli>>(frameDelta).count(),
+				logicTicks);
+		}
+	}
+	cleanup();
+	return EXIT_SUCCESS;
 }
\ No newline at end of file
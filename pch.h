@@ -1,34 +1,67 @@
-#pragma once
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_vulkan.h>
-#include <vulkan/vulkan.h>
-#include <cstdlib>
-#include <cstring>
-#include <vector>
-using std::vector;
-#include <string>
-using std::string;
-#include <limits>
-using std::numeric_limits;
-#include <glm/glm.hpp>
-#include <map>
-#include <unordered_map>
-#include <unordered_set>
-#include <chrono>
-namespace k10
-{
-	const int FIXED_FRAMES_PER_SECOND = 240;
-	const std::chrono::duration<double> FIXED_SECONDS_PER_FRAME =
-		std::chrono::duration<double>(1) / FIXED_FRAMES_PER_SECOND;
-}
-template<class T>
-inline T clamp(T value, T min, T max)
-{
-	return value < min ? min :
-		   value > max ? max :
-		   value;
-}
-namespace k10
-{
-	vector<Uint8> readFile(string const& fileName);
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_vulkan.h>
+#include <vulkan/vulkan.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+using std::vector;
+#include <string>
+using std::string;
+#include <limits>
+using std::numeric_limits;
+#include <glm/glm.hpp>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <condition_variable>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+namespace k10
+{
+	const int FIXED_FRAMES_PER_SECOND = 240;
+	const std::chrono::duration<double> FIXED_SECONDS_PER_FRAME =
+		std::chrono::duration<double>(1) / FIXED_FRAMES_PER_SECOND;
+}
+template<class T>
+inline T clamp(T value, T min, T max)
+{
+	return value < min ? min :
+		   value > max ? max :
+		   value;
+}
+namespace k10
+{
+	vector<Uint8> readFile(string const& fileName);
+	// index of the lowest/highest set bit of a word that isn't 0
+	inline Uint8 lowestSetBit(Uint64 word)
+	{
+		SDL_assert(word != 0);
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return static_cast<Uint8>(index);
+#else
+		return static_cast<Uint8>(__builtin_ctzll(word));
+#endif
+	}
+	inline Uint8 highestSetBit(Uint64 word)
+	{
+		SDL_assert(word != 0);
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, word);
+		return static_cast<Uint8>(index);
+#else
+		return static_cast<Uint8>(63 - __builtin_clzll(word));
+#endif
+	}
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+// left, top, right, bottom
+layout(location = 0) in vec4 rect;
+layout(location = 1) in float depth;
+layout(location = 2) in vec4 cornerColor0;
+layout(location = 3) in vec4 cornerColor1;
+layout(location = 4) in vec4 cornerColor2;
+layout(location = 5) in vec4 cornerColor3;
+layout(location = 0) out vec4 fragColor;
+// the quad corner used by each vertex of the quad's 2 triangles
+const int CORNER_INDICES[6] = int[](0, 1, 2, 2, 3, 0);
+void main()
+{
+	// corners: left-bottom, left-top, right-top, right-bottom
+	int corner = CORNER_INDICES[gl_VertexIndex];
+	vec2 position = vec2(corner < 2 ? rect.x : rect.z,
+						 corner == 1 || corner == 2 ? rect.y : rect.w);
+	gl_Position = vec4(position, depth, 1.0);
+	switch (corner)
+	{
+	case 0: fragColor = cornerColor0; break;
+	case 1: fragColor = cornerColor1; break;
+	case 2: fragColor = cornerColor2; break;
+	default: fragColor = cornerColor3; break;
+	}
+}
\ No newline at end of file
@@ -1,8 +1,8 @@
-#version 450
-#extension GL_ARB_separate_shader_objects : enable
-layout(location = 0) in  vec4 fragColor;
-layout(location = 0) out vec4 outColor;
-void main()
-{
-	outColor = fragColor;
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+layout(location = 0) in  vec4 fragColor;
+layout(location = 0) out vec4 outColor;
+void main()
+{
+	outColor = fragColor;
 }
\ No newline at end of file